@@ -38,6 +38,102 @@ static int redisAeAttach_link(redisAsyncContext *ac, void *base) {
     return redisAeAttach((aeEventLoop *)base, ac);
 }
 
+typedef struct redisAeTimer {
+    aeEventLoop *loop;
+    long long id;
+    adapterTimerFn *fn;
+    void *privdata;
+} redisAeTimer;
+
+static int redisAeTimerCallback(aeEventLoop *loop, long long id,
+                                void *clientData) {
+    redisAeTimer *timer = (redisAeTimer *)clientData;
+    ((void)loop);
+    ((void)id);
+
+    timer->fn(timer->privdata);
+    return AE_NOMORE; /* Deletes the event, which frees the timer */
+}
+
+static void redisAeTimerFree(aeEventLoop *loop, void *clientData) {
+    ((void)loop);
+    hi_free(clientData);
+}
+
+static void *redisAeTimerStart_link(void *base, int64_t usec,
+                                    adapterTimerFn *fn, void *privdata) {
+    redisAeTimer *timer;
+
+    timer = (redisAeTimer *)hi_malloc(sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->loop = (aeEventLoop *)base;
+    timer->fn = fn;
+    timer->privdata = privdata;
+
+    /* Rounded up to the millisecond resolution of ae */
+    timer->id = aeCreateTimeEvent(timer->loop, (usec + 999) / 1000,
+                                  redisAeTimerCallback, timer,
+                                  redisAeTimerFree);
+    if (timer->id == AE_ERR) {
+        hi_free(timer);
+        return NULL;
+    }
+    return timer;
+}
+
+static void redisAeTimerStop_link(void *t) {
+    redisAeTimer *timer = (redisAeTimer *)t;
+
+    aeDeleteTimeEvent(timer->loop, timer->id);
+}
+
+typedef struct redisAeWatch {
+    aeEventLoop *loop;
+    int fd;
+    adapterWatchFn *fn;
+    void *privdata;
+} redisAeWatch;
+
+static void redisAeWatchCallback(aeEventLoop *loop, int fd, void *clientData,
+                                 int mask) {
+    redisAeWatch *watch = (redisAeWatch *)clientData;
+    ((void)loop);
+    ((void)fd);
+    ((void)mask);
+
+    watch->fn(watch->privdata);
+}
+
+static void *redisAeWatchStart_link(void *base, int fd, adapterWatchFn *fn,
+                                    void *privdata) {
+    redisAeWatch *watch;
+
+    watch = (redisAeWatch *)hi_malloc(sizeof(*watch));
+    if (watch == NULL) {
+        return NULL;
+    }
+    watch->loop = (aeEventLoop *)base;
+    watch->fd = fd;
+    watch->fn = fn;
+    watch->privdata = privdata;
+
+    if (aeCreateFileEvent(watch->loop, fd, AE_READABLE, redisAeWatchCallback,
+                          watch) == AE_ERR) {
+        hi_free(watch);
+        return NULL;
+    }
+    return watch;
+}
+
+static void redisAeWatchStop_link(void *w) {
+    redisAeWatch *watch = (redisAeWatch *)w;
+
+    aeDeleteFileEvent(watch->loop, watch->fd, AE_READABLE);
+    hi_free(watch);
+}
+
 static int redisClusterAeAttach(aeEventLoop *loop,
                                 redisClusterAsyncContext *acc) {
 
@@ -47,6 +143,10 @@ static int redisClusterAeAttach(aeEventLoop *loop,
 
     acc->adapter = loop;
     acc->attach_fn = redisAeAttach_link;
+    acc->timer_start_fn = redisAeTimerStart_link;
+    acc->timer_stop_fn = redisAeTimerStop_link;
+    acc->watch_start_fn = redisAeWatchStart_link;
+    acc->watch_stop_fn = redisAeWatchStop_link;
 
     return REDIS_OK;
 }
@@ -32,6 +32,7 @@
 #define __HIREDIS_CLUSTER_GLIB_H__
 
 #include "../hircluster.h"
+#include <glib-unix.h>
 #include <hiredis/adapters/glib.h>
 
 typedef struct redisClusterGlibAdapter {
@@ -46,6 +47,87 @@ static int redisGlibAttach_link(redisAsyncContext *ac, void *adapter) {
     return REDIS_ERR;
 }
 
+typedef struct redisGlibTimer {
+    GSource *source;
+    adapterTimerFn *fn;
+    void *privdata;
+} redisGlibTimer;
+
+static gboolean redisGlibTimerCallback(gpointer data) {
+    redisGlibTimer *timer = (redisGlibTimer *)data;
+
+    timer->fn(timer->privdata);
+    return FALSE; /* Destroys the source, which frees the timer */
+}
+
+static void redisGlibTimerFree(gpointer data) { hi_free(data); }
+
+static void *redisGlibTimerStart_link(void *adapter, int64_t usec,
+                                      adapterTimerFn *fn, void *privdata) {
+    GMainContext *context = ((redisClusterGlibAdapter *)adapter)->context;
+    redisGlibTimer *timer;
+
+    timer = (redisGlibTimer *)hi_malloc(sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->fn = fn;
+    timer->privdata = privdata;
+
+    /* Rounded up to the millisecond resolution of GLib */
+    timer->source = g_timeout_source_new((guint)((usec + 999) / 1000));
+    g_source_set_callback(timer->source, redisGlibTimerCallback, timer,
+                          redisGlibTimerFree);
+    g_source_attach(timer->source, context);
+    g_source_unref(timer->source); /* Referenced by the context */
+    return timer;
+}
+
+static void redisGlibTimerStop_link(void *t) {
+    g_source_destroy(((redisGlibTimer *)t)->source);
+}
+
+typedef struct redisGlibWatch {
+    GSource *source;
+    adapterWatchFn *fn;
+    void *privdata;
+} redisGlibWatch;
+
+static gboolean redisGlibWatchCallback(gint fd, GIOCondition condition,
+                                       gpointer data) {
+    redisGlibWatch *watch = (redisGlibWatch *)data;
+    ((void)fd);
+    ((void)condition);
+
+    watch->fn(watch->privdata);
+    return TRUE; /* Keeps the source until destroyed */
+}
+
+static void *redisGlibWatchStart_link(void *adapter, int fd,
+                                      adapterWatchFn *fn, void *privdata) {
+    GMainContext *context = ((redisClusterGlibAdapter *)adapter)->context;
+    redisGlibWatch *watch;
+
+    watch = (redisGlibWatch *)hi_malloc(sizeof(*watch));
+    if (watch == NULL) {
+        return NULL;
+    }
+    watch->fn = fn;
+    watch->privdata = privdata;
+
+    watch->source = g_unix_fd_source_new(fd, G_IO_IN);
+    g_source_set_callback(watch->source,
+                          (GSourceFunc)(void (*)(void))redisGlibWatchCallback,
+                          watch, redisGlibTimerFree);
+    g_source_attach(watch->source, context);
+    g_source_unref(watch->source); /* Referenced by the context */
+    return watch;
+}
+
+static void redisGlibWatchStop_link(void *w) {
+    g_source_destroy(((redisGlibWatch *)w)->source);
+}
+
 static int redisClusterGlibAttach(redisClusterAsyncContext *acc,
                                   redisClusterGlibAdapter *adapter) {
     if (acc == NULL || adapter == NULL) {
@@ -54,6 +136,10 @@ static int redisClusterGlibAttach(redisClusterAsyncContext *acc,
 
     acc->adapter = adapter;
     acc->attach_fn = redisGlibAttach_link;
+    acc->timer_start_fn = redisGlibTimerStart_link;
+    acc->timer_stop_fn = redisGlibTimerStop_link;
+    acc->watch_start_fn = redisGlibWatchStart_link;
+    acc->watch_stop_fn = redisGlibWatchStop_link;
 
     return REDIS_OK;
 }
@@ -38,6 +38,110 @@ static int redisLibevAttach_link(redisAsyncContext *ac, void *loop) {
     return redisLibevAttach((struct ev_loop *)loop, ac);
 }
 
+typedef struct redisLibevTimer {
+    ev_timer ev;
+    struct ev_loop *loop;
+    adapterTimerFn *fn;
+    void *privdata;
+} redisLibevTimer;
+
+static void redisLibevTimerCallback(EV_P_ ev_timer *w, int revents) {
+    redisLibevTimer *timer = (redisLibevTimer *)w->data;
+    adapterTimerFn *fn = timer->fn;
+    void *privdata = timer->privdata;
+#if EV_MULTIPLICITY
+    ((void)EV_A);
+#endif
+    ((void)revents);
+
+    /* A timer without repeat is stopped when it fires */
+    hi_free(timer);
+    fn(privdata);
+}
+
+static void *redisLibevTimerStart_link(void *loop, int64_t usec,
+                                       adapterTimerFn *fn, void *privdata) {
+    redisLibevTimer *timer;
+
+    timer = (redisLibevTimer *)hi_malloc(sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->loop = (struct ev_loop *)loop;
+    timer->fn = fn;
+    timer->privdata = privdata;
+
+    ev_timer_init(&timer->ev, redisLibevTimerCallback, usec / 1000000.0, 0.);
+    timer->ev.data = timer;
+#if EV_MULTIPLICITY
+    ev_timer_start(timer->loop, &timer->ev);
+#else
+    ev_timer_start(&timer->ev);
+#endif
+    return timer;
+}
+
+static void redisLibevTimerStop_link(void *t) {
+    redisLibevTimer *timer = (redisLibevTimer *)t;
+
+#if EV_MULTIPLICITY
+    ev_timer_stop(timer->loop, &timer->ev);
+#else
+    ev_timer_stop(&timer->ev);
+#endif
+    hi_free(timer);
+}
+
+typedef struct redisLibevWatch {
+    ev_io ev;
+    struct ev_loop *loop;
+    adapterWatchFn *fn;
+    void *privdata;
+} redisLibevWatch;
+
+static void redisLibevWatchCallback(EV_P_ ev_io *w, int revents) {
+    redisLibevWatch *watch = (redisLibevWatch *)w->data;
+#if EV_MULTIPLICITY
+    ((void)EV_A);
+#endif
+    ((void)revents);
+
+    watch->fn(watch->privdata);
+}
+
+static void *redisLibevWatchStart_link(void *loop, int fd, adapterWatchFn *fn,
+                                       void *privdata) {
+    redisLibevWatch *watch;
+
+    watch = (redisLibevWatch *)hi_malloc(sizeof(*watch));
+    if (watch == NULL) {
+        return NULL;
+    }
+    watch->loop = (struct ev_loop *)loop;
+    watch->fn = fn;
+    watch->privdata = privdata;
+
+    ev_io_init(&watch->ev, redisLibevWatchCallback, fd, EV_READ);
+    watch->ev.data = watch;
+#if EV_MULTIPLICITY
+    ev_io_start(watch->loop, &watch->ev);
+#else
+    ev_io_start(&watch->ev);
+#endif
+    return watch;
+}
+
+static void redisLibevWatchStop_link(void *w) {
+    redisLibevWatch *watch = (redisLibevWatch *)w;
+
+#if EV_MULTIPLICITY
+    ev_io_stop(watch->loop, &watch->ev);
+#else
+    ev_io_stop(&watch->ev);
+#endif
+    hi_free(watch);
+}
+
 static int redisClusterLibevAttach(redisClusterAsyncContext *acc,
                                    struct ev_loop *loop) {
     if (loop == NULL || acc == NULL) {
@@ -46,6 +150,10 @@ static int redisClusterLibevAttach(redisClusterAsyncContext *acc,
 
     acc->adapter = loop;
     acc->attach_fn = redisLibevAttach_link;
+    acc->timer_start_fn = redisLibevTimerStart_link;
+    acc->timer_stop_fn = redisLibevTimerStop_link;
+    acc->watch_start_fn = redisLibevWatchStart_link;
+    acc->watch_stop_fn = redisLibevWatchStop_link;
 
     return REDIS_OK;
 }
@@ -38,6 +38,106 @@ static int redisLibeventAttach_link(redisAsyncContext *ac, void *base) {
     return redisLibeventAttach(ac, (struct event_base *)base);
 }
 
+typedef struct redisLibeventTimer {
+    struct event *ev;
+    adapterTimerFn *fn;
+    void *privdata;
+} redisLibeventTimer;
+
+static void redisLibeventTimerCallback(evutil_socket_t fd, short event,
+                                       void *arg) {
+    redisLibeventTimer *timer = (redisLibeventTimer *)arg;
+    adapterTimerFn *fn = timer->fn;
+    void *privdata = timer->privdata;
+    (void)fd;
+    (void)event;
+
+    event_free(timer->ev);
+    hi_free(timer);
+    fn(privdata);
+}
+
+static void *redisLibeventTimerStart_link(void *base, int64_t usec,
+                                          adapterTimerFn *fn, void *privdata) {
+    redisLibeventTimer *timer;
+    struct timeval tv;
+
+    timer = (redisLibeventTimer *)hi_malloc(sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->fn = fn;
+    timer->privdata = privdata;
+    timer->ev = event_new((struct event_base *)base, -1, 0,
+                          redisLibeventTimerCallback, timer);
+    if (timer->ev == NULL) {
+        hi_free(timer);
+        return NULL;
+    }
+
+    tv.tv_sec = usec / 1000000;
+    tv.tv_usec = usec % 1000000;
+    if (event_add(timer->ev, &tv) != 0) {
+        event_free(timer->ev);
+        hi_free(timer);
+        return NULL;
+    }
+    return timer;
+}
+
+static void redisLibeventTimerStop_link(void *t) {
+    redisLibeventTimer *timer = (redisLibeventTimer *)t;
+
+    event_free(timer->ev);
+    hi_free(timer);
+}
+
+typedef struct redisLibeventWatch {
+    struct event *ev;
+    adapterWatchFn *fn;
+    void *privdata;
+} redisLibeventWatch;
+
+static void redisLibeventWatchCallback(evutil_socket_t fd, short event,
+                                       void *arg) {
+    redisLibeventWatch *watch = (redisLibeventWatch *)arg;
+    (void)fd;
+    (void)event;
+
+    watch->fn(watch->privdata);
+}
+
+static void *redisLibeventWatchStart_link(void *base, int fd,
+                                          adapterWatchFn *fn, void *privdata) {
+    redisLibeventWatch *watch;
+
+    watch = (redisLibeventWatch *)hi_malloc(sizeof(*watch));
+    if (watch == NULL) {
+        return NULL;
+    }
+    watch->fn = fn;
+    watch->privdata = privdata;
+    watch->ev = event_new((struct event_base *)base, fd, EV_READ | EV_PERSIST,
+                          redisLibeventWatchCallback, watch);
+    if (watch->ev == NULL) {
+        hi_free(watch);
+        return NULL;
+    }
+    if (event_add(watch->ev, NULL) != 0) {
+        event_free(watch->ev);
+        hi_free(watch);
+        return NULL;
+    }
+    return watch;
+}
+
+static void redisLibeventWatchStop_link(void *w) {
+    redisLibeventWatch *watch = (redisLibeventWatch *)w;
+
+    event_free(watch->ev);
+    hi_free(watch);
+}
+
 static int redisClusterLibeventAttach(redisClusterAsyncContext *acc,
                                       struct event_base *base) {
 
@@ -47,6 +147,10 @@ static int redisClusterLibeventAttach(redisClusterAsyncContext *acc,
 
     acc->adapter = base;
     acc->attach_fn = redisLibeventAttach_link;
+    acc->timer_start_fn = redisLibeventTimerStart_link;
+    acc->timer_stop_fn = redisLibeventTimerStop_link;
+    acc->watch_start_fn = redisLibeventWatchStart_link;
+    acc->watch_stop_fn = redisLibeventWatchStop_link;
 
     return REDIS_OK;
 }
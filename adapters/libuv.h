@@ -38,6 +38,103 @@ static int redisLibuvAttach_link(redisAsyncContext *ac, void *loop) {
     return redisLibuvAttach(ac, (uv_loop_t *)loop);
 }
 
+typedef struct redisLibuvTimer {
+    uv_timer_t handle;
+    adapterTimerFn *fn;
+    void *privdata;
+} redisLibuvTimer;
+
+static void redisLibuvTimerClose(uv_handle_t *handle) {
+    hi_free(handle->data);
+}
+
+static void redisLibuvTimerCallback(uv_timer_t *handle) {
+    redisLibuvTimer *timer = (redisLibuvTimer *)handle->data;
+    adapterTimerFn *fn = timer->fn;
+    void *privdata = timer->privdata;
+
+    uv_close((uv_handle_t *)handle, redisLibuvTimerClose);
+    fn(privdata);
+}
+
+static void *redisLibuvTimerStart_link(void *loop, int64_t usec,
+                                       adapterTimerFn *fn, void *privdata) {
+    redisLibuvTimer *timer;
+
+    timer = (redisLibuvTimer *)hi_malloc(sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    if (uv_timer_init((uv_loop_t *)loop, &timer->handle) != 0) {
+        hi_free(timer);
+        return NULL;
+    }
+    timer->handle.data = timer;
+    timer->fn = fn;
+    timer->privdata = privdata;
+
+    /* Rounded up to the millisecond resolution of libuv */
+    if (uv_timer_start(&timer->handle, redisLibuvTimerCallback,
+                       (uint64_t)((usec + 999) / 1000), 0) != 0) {
+        uv_close((uv_handle_t *)&timer->handle, redisLibuvTimerClose);
+        return NULL;
+    }
+    return timer;
+}
+
+static void redisLibuvTimerStop_link(void *t) {
+    redisLibuvTimer *timer = (redisLibuvTimer *)t;
+
+    uv_timer_stop(&timer->handle);
+    uv_close((uv_handle_t *)&timer->handle, redisLibuvTimerClose);
+}
+
+typedef struct redisLibuvWatch {
+    uv_poll_t handle;
+    adapterWatchFn *fn;
+    void *privdata;
+} redisLibuvWatch;
+
+static void redisLibuvWatchCallback(uv_poll_t *handle, int status,
+                                    int events) {
+    redisLibuvWatch *watch = (redisLibuvWatch *)handle->data;
+    ((void)status);
+    ((void)events);
+
+    watch->fn(watch->privdata);
+}
+
+static void *redisLibuvWatchStart_link(void *loop, int fd, adapterWatchFn *fn,
+                                       void *privdata) {
+    redisLibuvWatch *watch;
+
+    watch = (redisLibuvWatch *)hi_malloc(sizeof(*watch));
+    if (watch == NULL) {
+        return NULL;
+    }
+    if (uv_poll_init((uv_loop_t *)loop, &watch->handle, fd) != 0) {
+        hi_free(watch);
+        return NULL;
+    }
+    watch->handle.data = watch;
+    watch->fn = fn;
+    watch->privdata = privdata;
+
+    if (uv_poll_start(&watch->handle, UV_READABLE,
+                      redisLibuvWatchCallback) != 0) {
+        uv_close((uv_handle_t *)&watch->handle, redisLibuvTimerClose);
+        return NULL;
+    }
+    return watch;
+}
+
+static void redisLibuvWatchStop_link(void *w) {
+    redisLibuvWatch *watch = (redisLibuvWatch *)w;
+
+    uv_poll_stop(&watch->handle);
+    uv_close((uv_handle_t *)&watch->handle, redisLibuvTimerClose);
+}
+
 static int redisClusterLibuvAttach(redisClusterAsyncContext *acc,
                                    uv_loop_t *loop) {
 
@@ -47,6 +144,10 @@ static int redisClusterLibuvAttach(redisClusterAsyncContext *acc,
 
     acc->adapter = loop;
     acc->attach_fn = redisLibuvAttach_link;
+    acc->timer_start_fn = redisLibuvTimerStart_link;
+    acc->timer_stop_fn = redisLibuvTimerStop_link;
+    acc->watch_start_fn = redisLibuvWatchStart_link;
+    acc->watch_stop_fn = redisLibuvWatchStop_link;
 
     return REDIS_OK;
 }
@@ -51,10 +51,10 @@ hilist *listCreate(void) {
     return list;
 }
 
-/* Free the whole list.
+/* Remove all the elements from the list without destroying the list itself.
  *
  * This function can't fail. */
-void listRelease(hilist *list) {
+void listEmpty(hilist *list) {
     unsigned long len;
     listNode *current, *next;
 
@@ -67,6 +67,15 @@ void listRelease(hilist *list) {
         hi_free(current);
         current = next;
     }
+    list->head = list->tail = NULL;
+    list->len = 0;
+}
+
+/* Free the whole list.
+ *
+ * This function can't fail. */
+void listRelease(hilist *list) {
+    listEmpty(list);
     hi_free(list);
 }
 
@@ -72,6 +72,7 @@ typedef struct hilist {
 /* Prototypes */
 hilist *listCreate(void);
 void listRelease(hilist *list);
+void listEmpty(hilist *list);
 hilist *listAddNodeHead(hilist *list, void *value);
 hilist *listAddNodeTail(hilist *list, void *value);
 hilist *listInsertNode(hilist *list, listNode *old_node, void *value,
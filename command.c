@@ -47,8 +47,6 @@
 #define LF (uint8_t)10
 #define CR (uint8_t)13
 
-static uint64_t cmd_id = 0; /* command id counter */
-
 typedef enum {
     KEYPOS_NONE,
     KEYPOS_UNKNOWN,
@@ -63,17 +61,19 @@ typedef struct {
     cmd_keypos firstkeymethod; /* First key none, unknown, pos or keynum */
     int8_t firstkeypos;        /* Position of first key or the  arg */
     int8_t arity;              /* Arity, neg number means min num args */
+    uint8_t flags;             /* CMD_FLAG_* */
 } cmddef;
 
 /* Populate the table with code in cmddef.h generated from Redis JSON files. */
 static cmddef redis_commands[] = {
-#define COMMAND(_type, _name, _subname, _arity, _keymethod, _keypos)           \
+#define COMMAND(_type, _name, _subname, _arity, _keymethod, _keypos, _flags)   \
     {.type = CMD_REQ_REDIS_##_type,                                            \
      .name = _name,                                                            \
      .subname = _subname,                                                      \
      .firstkeymethod = KEYPOS_##_keymethod,                                    \
      .firstkeypos = _keypos,                                                   \
-     .arity = _arity},
+     .arity = _arity,                                                          \
+     .flags = _flags},
 #include "cmddef.h"
 #undef COMMAND
 };
@@ -200,11 +200,12 @@ char *redis_parse_bulk(char *p, char *end, char **str, uint32_t *len) {
 }
 
 static inline int push_keypos(struct cmd *r, char *arg, uint32_t arglen) {
-    struct keypos *kpos = hiarray_push(r->keys);
+    struct keypos *kpos = command_push_key(r);
     if (kpos == NULL)
         return 0;
     kpos->start = arg;
     kpos->end = arg + arglen;
+    kpos->key_idx = hiarray_n(r->keys) - 1;
     return 1;
 }
 
@@ -274,6 +275,8 @@ void redis_parse_cmd(struct cmd *r) {
     if ((info = redis_lookup_cmd(arg0, arg0_len, arg1, arg1_len)) == NULL)
         goto error; /* Command not found. */
     r->type = info->type;
+    r->readonly = (info->flags & CMD_FLAG_READONLY) != 0;
+    r->blocking = (info->flags & CMD_FLAG_BLOCKING) != 0;
 
     /* Arity check (negative arity means minimum num args) */
     if ((info->arity >= 0 && (int)rnarg != info->arity) ||
@@ -413,45 +416,45 @@ oom:
     r->result = CMD_PARSE_ENOMEM;
 }
 
-struct cmd *command_get(void) {
-    struct cmd *command;
-    command = hi_malloc(sizeof(struct cmd));
-    if (command == NULL) {
-        return NULL;
-    }
-
-    command->id = ++cmd_id;
+static void command_init(struct cmd *command) {
     command->result = CMD_PARSE_OK;
     command->errstr = NULL;
     command->type = CMD_UNKNOWN;
     command->cmd = NULL;
     command->clen = 0;
-    command->keys = NULL;
     command->narg = 0;
     command->quit = 0;
     command->noforward = 0;
+    command->in_arena = 0;
+    command->readonly = 0;
+    command->blocking = 0;
     command->slot_num = -1;
-    command->frag_seq = NULL;
     command->reply = NULL;
     command->sub_commands = NULL;
     command->node_addr = NULL;
-
-    command->keys = hiarray_create(1, sizeof(struct keypos));
-    if (command->keys == NULL) {
-        hi_free(command);
-        return NULL;
-    }
-
-    return command;
+    command->next_free = NULL;
+    command->pipeline_index = -1;
+    command->pipeline_next = NULL;
+    command->pipeline_node = NULL;
+    command->pipeline_part = NULL;
+    command->pipeline_pending = 0;
+    command->parent = NULL;
+    command->redirects = 0;
+    command->replied = 0;
+    command->asking = 0;
+
+    /* Keys are stored inline until they don't fit */
+    hiarray_set(&command->keys_array, command->keys_inline,
+                sizeof(struct keypos), CMD_INLINE_KEYS);
+    command->keys = &command->keys_array;
 }
 
-void command_destroy(struct cmd *command) {
-    if (command == NULL) {
-        return;
-    }
-
+/* Free all memory owned by the command, but not the command itself. */
+static void command_free_members(struct cmd *command) {
     if (command->cmd != NULL) {
-        hi_free(command->cmd);
+        if (!command->in_arena) {
+            hi_free(command->cmd);
+        }
         command->cmd = NULL;
     }
 
@@ -460,27 +463,88 @@ void command_destroy(struct cmd *command) {
         command->errstr = NULL;
     }
 
-    if (command->keys != NULL) {
+    if (command->keys->elem != command->keys_inline) {
         command->keys->nelem = 0;
-        hiarray_destroy(command->keys);
-        command->keys = NULL;
-    }
-
-    if (command->frag_seq != NULL) {
-        hi_free(command->frag_seq);
-        command->frag_seq = NULL;
+        hiarray_deinit(command->keys);
     }
 
     freeReplyObject(command->reply);
+    command->reply = NULL;
 
     if (command->sub_commands != NULL) {
         listRelease(command->sub_commands);
+        command->sub_commands = NULL;
     }
 
     if (command->node_addr != NULL) {
         sdsfree(command->node_addr);
         command->node_addr = NULL;
     }
+}
 
-    hi_free(command);
+struct cmd *command_get(void) {
+    struct cmd *command;
+    command = hi_malloc(sizeof(struct cmd));
+    if (command == NULL) {
+        return NULL;
+    }
+
+    hiarena_init(&command->arena);
+    command_init(command);
+    return command;
+}
+
+/* Get a command allocated from an arena, e.g. a sub-command of a multi-key
+ * command. Its formatted command is expected to be allocated from the same
+ * arena. The memory is released with the arena, but command_destroy() is
+ * still needed to free any other resources held by the command. */
+struct cmd *command_get_from_arena(struct hiarena *arena) {
+    struct cmd *command;
+    command = hiarena_alloc(arena, sizeof(struct cmd));
+    if (command == NULL) {
+        return NULL;
+    }
+
+    hiarena_init(&command->arena);
+    command_init(command);
+    command->in_arena = 1;
+    return command;
+}
+
+/* Add a key position to the command. The inline key storage is moved to the
+ * heap when it is full. Returns NULL when out of memory. */
+struct keypos *command_push_key(struct cmd *command) {
+    struct hiarray *keys = command->keys;
+
+    if (keys->elem == command->keys_inline && keys->nelem == keys->nalloc) {
+        struct keypos *elem = hi_malloc(sizeof(*elem) * keys->nalloc * 2);
+        if (elem == NULL) {
+            return NULL;
+        }
+        memcpy(elem, keys->elem, sizeof(*elem) * keys->nelem);
+        keys->elem = elem;
+        keys->nalloc *= 2;
+    }
+
+    return hiarray_push(keys);
+}
+
+/* Release all resources held by a command and make it ready for reuse,
+ * as if it was returned by command_get(). */
+void command_reset(struct cmd *command) {
+    command_free_members(command);
+    hiarena_reset(&command->arena);
+    command_init(command);
+}
+
+void command_destroy(struct cmd *command) {
+    if (command == NULL) {
+        return;
+    }
+
+    command_free_members(command);
+    hiarena_release(&command->arena);
+    if (!command->in_arena) {
+        hi_free(command);
+    }
 }
@@ -35,6 +35,8 @@
 #include <stdint.h>
 
 #include "adlist.h"
+#include "hiarena.h"
+#include "hiarray.h"
 #include <hiredis/hiredis.h>
 
 typedef enum cmd_parse_result {
@@ -45,10 +47,14 @@ typedef enum cmd_parse_result {
     CMD_PARSE_AGAIN,  /* incomplete -> parse again */
 } cmd_parse_result_t;
 
+/* Command flags, in cmddef.h */
+#define CMD_FLAG_READONLY (1 << 0) /* Command doesn't modify data */
+#define CMD_FLAG_BLOCKING (1 << 1) /* Command may block the connection */
+
 typedef enum cmd_type {
     CMD_UNKNOWN,
 /* Request commands */
-#define COMMAND(_type, _name, _subname, _arity, _keymethod, _keypos)           \
+#define COMMAND(_type, _name, _subname, _arity, _keymethod, _keypos, _flags)   \
     CMD_REQ_REDIS_##_type,
 #include "cmddef.h"
 #undef COMMAND
@@ -61,17 +67,19 @@ typedef enum cmd_type {
     CMD_SENTINEL
 } cmd_type_t;
 
+/* Number of keys stored in the command itself before allocating */
+#define CMD_INLINE_KEYS 4
+
 struct keypos {
     char *start;         /* key start pos */
     char *end;           /* key end pos */
     uint32_t remain_len; /* remain length after keypos->end for more key-value
                             pairs in command, like mset */
+    uint32_t key_idx;    /* index of the key in the original command */
 };
 
 struct cmd {
 
-    uint64_t id; /* command id */
-
     cmd_parse_result_t result; /* command parsing result */
     char *errstr;              /* error info when the command parse failed */
 
@@ -86,6 +94,9 @@ struct cmd {
 
     unsigned quit : 1;      /* quit request? */
     unsigned noforward : 1; /* not need forward (example: ping) */
+    unsigned in_arena : 1;  /* command and cmd allocated from an arena */
+    unsigned readonly : 1;  /* read-only command, may be sent to a replica */
+    unsigned blocking : 1;  /* may block the connection waiting for data */
 
     /* Command destination */
     int slot_num;    /* Command should be sent to slot.
@@ -95,17 +106,34 @@ struct cmd {
                       * nodes (cross slot) */
     char *node_addr; /* Command sent to this node address */
 
-    struct cmd *
-        *frag_seq; /* sequence of fragment command, map from keys to fragments*/
-
     redisReply *reply;
 
     hilist *sub_commands; /* just for pipeline and multi-key commands */
+    struct hiarena arena; /* temporaries of the request, e.g. sub-commands */
+
+    struct hiarray keys_array; /* storage of keys, starts with keys_inline */
+    struct keypos keys_inline[CMD_INLINE_KEYS];
+
+    struct cmd *next_free; /* next unused command in a pool */
+
+    /* Pipelining */
+    long long pipeline_index;  /* position in the pipeline */
+    struct cmd *pipeline_next; /* next command waiting on the same node */
+    struct redisClusterNode *pipeline_node; /* node the reply is read from */
+    listNode *pipeline_part;   /* first sub-command possibly without a reply */
+    uint32_t pipeline_pending; /* sub-commands waiting for a reply */
+    struct cmd *parent;   /* multi-key command of a sub-command */
+    int redirects;        /* MOVED and ASK redirects followed */
+    unsigned replied : 1; /* reply returned out of order */
+    unsigned asking : 1;  /* reply is preceded by the reply to ASKING */
 };
 
 void redis_parse_cmd(struct cmd *r);
 
 struct cmd *command_get(void);
+struct cmd *command_get_from_arena(struct hiarena *arena);
+struct keypos *command_push_key(struct cmd *command);
+void command_reset(struct cmd *command);
 void command_destroy(struct cmd *command);
 
 #endif
@@ -163,6 +163,36 @@ int dictAdd(dict *ht, void *key, void *val) {
     return DICT_OK;
 }
 
+/* Remove an element from the hash table, freeing its key and value */
+int dictDelete(dict *ht, const void *key) {
+    unsigned int h;
+    dictEntry *he, *prevHe;
+
+    if (ht->size == 0)
+        return DICT_ERR;
+    h = dictHashKey(ht, key) & ht->sizemask;
+    he = ht->table[h];
+
+    prevHe = NULL;
+    while (he) {
+        if (dictCompareHashKeys(ht, key, he->key)) {
+            /* Unlink the element from the list */
+            if (prevHe)
+                prevHe->next = he->next;
+            else
+                ht->table[h] = he->next;
+            dictFreeEntryKey(ht, he);
+            dictFreeEntryVal(ht, he);
+            hi_free(he);
+            ht->used--;
+            return DICT_OK;
+        }
+        prevHe = he;
+        he = he->next;
+    }
+    return DICT_ERR; /* not found */
+}
+
 /* Destroy an entire hash table */
 static int _dictClear(dict *ht) {
     unsigned long i;
@@ -117,6 +117,7 @@ unsigned int dictGenHashFunction(const unsigned char *buf, int len);
 dict *dictCreate(dictType *type, void *privDataPtr);
 int dictExpand(dict *ht, unsigned long size);
 int dictAdd(dict *ht, void *key, void *val);
+int dictDelete(dict *ht, const void *key);
 void dictRelease(dict *ht);
 dictEntry *dictFind(dict *ht, const void *key);
 void dictInitIterator(dictIterator *iter, dict *ht);
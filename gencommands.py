@@ -118,6 +118,22 @@ def firstkey(props):
     else:
         return ("UNKNOWN", 0)
 
+# Returns the flags of a command as a C expression, for example
+# "CMD_FLAG_READONLY", or "0" if the command has none of the flags we use.
+def command_flags(props):
+    # Redis source JSON files use "command_flags" and generate-commands-json.py
+    # returns "flags" in lowercase.
+    flags = props.get("command_flags", props.get("flags", []))
+    flags = [flag.upper() for flag in flags]
+    result = []
+    if "READONLY" in flags:
+        result.append("CMD_FLAG_READONLY")
+    if "BLOCKING" in flags:
+        result.append("CMD_FLAG_BLOCKING")
+    if len(result) == 0:
+        return "0"
+    return " | ".join(result)
+
 def extract_command_info(name, props):
     (firstkeymethod, firstkeypos) = firstkey(props)
     container = props.get("container", "")
@@ -138,20 +154,21 @@ def extract_command_info(name, props):
                 firstkeypos += 1
 
     arity = props["arity"] if "arity" in props else -1
-    return (name, subcommand, arity, firstkeymethod, firstkeypos);
+    flags = command_flags(props)
+    return (name, subcommand, arity, firstkeymethod, firstkeypos, flags);
 
 # Parses a file with lines like
-# COMMAND(identifier, cmd, subcmd, arity, firstkeymethod, firstkeypos)
+# COMMAND(identifier, cmd, subcmd, arity, firstkeymethod, firstkeypos, flags)
 def collect_command_from_cmddef_h(f, commands):
    for line in f:
-       m = re.match(r'^COMMAND\(\S+, *"(\S+)", NULL, *(-?\d+), *(\w+), *(\d+)\)', line)
+       m = re.match(r'^COMMAND\(\S+, *"(\S+)", NULL, *(-?\d+), *(\w+), *(\d+), *([^)]+)\)', line)
        if m:
-           commands[m.group(1)] = (m.group(1), None, int(m.group(2)), m.group(3), int(m.group(4)))
+           commands[m.group(1)] = (m.group(1), None, int(m.group(2)), m.group(3), int(m.group(4)), m.group(5))
            continue
-       m = re.match(r'^COMMAND\(\S+, *"(\S+)", *"(\S+)", *(-?\d+), *(\w+), *(\d)\)', line)
+       m = re.match(r'^COMMAND\(\S+, *"(\S+)", *"(\S+)", *(-?\d+), *(\w+), *(\d), *([^)]+)\)', line)
        if m:
            key = m.group(1) + "_" + m.group(2)
-           commands[key] = (m.group(1), m.group(2), int(m.group(3)), m.group(4), int(m.group(5)))
+           commands[key] = (m.group(1), m.group(2), int(m.group(3)), m.group(4), int(m.group(5)), m.group(6))
            continue
        if re.match(r'^(?:/\*.*\*/)?\s*$', line):
            # Comment or blank line
@@ -173,7 +190,7 @@ def collect_commands_from_files(filenames):
                 d = json.load(f)
                 for name, props in d.items():
                     cmd = extract_command_info(name, props)
-                    (name, subcmd, _, _, _) = cmd
+                    (name, subcmd, _, _, _, _) = cmd
 
                     # For commands with subcommands, we want only the
                     # command-subcommand pairs, not the container command alone
@@ -197,15 +214,15 @@ def generate_c_code(commands):
     print("")
     print("/* clang-format off */")
     for key in sorted(commands):
-        (name, subcmd, arity, firstkeymethod, firstkeypos) = commands[key]
+        (name, subcmd, arity, firstkeymethod, firstkeypos, flags) = commands[key]
         # Make valid C identifier (macro name)
         key = re.sub(r'\W', '_', key)
         if subcmd is None:
-            print("COMMAND(%s, \"%s\", NULL, %d, %s, %d)" %
-                  (key, name, arity, firstkeymethod, firstkeypos))
+            print("COMMAND(%s, \"%s\", NULL, %d, %s, %d, %s)" %
+                  (key, name, arity, firstkeymethod, firstkeypos, flags))
         else:
-            print("COMMAND(%s, \"%s\", \"%s\", %d, %s, %d)" %
-                  (key, name, subcmd, arity, firstkeymethod, firstkeypos))
+            print("COMMAND(%s, \"%s\", \"%s\", %d, %s, %d, %s)" %
+                  (key, name, subcmd, arity, firstkeymethod, firstkeypos, flags))
 
 # MAIN
 
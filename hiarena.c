@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026, hiredis-cluster contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Redis nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <hiredis/alloc.h>
+#include <stdint.h>
+
+#include "hiarena.h"
+
+#define HIARENA_BLOCK_SIZE 4096
+#define HIARENA_ALIGNMENT 16
+#define HIARENA_ALIGN(size)                                                    \
+    (((size) + HIARENA_ALIGNMENT - 1) & ~((size_t)HIARENA_ALIGNMENT - 1))
+
+struct hiarena_block {
+    struct hiarena_block *next;
+    size_t size; /* Usable size, following the aligned block header */
+};
+
+#define HIARENA_HEADER_SIZE HIARENA_ALIGN(sizeof(struct hiarena_block))
+
+static void hiarena_use_block(struct hiarena *arena,
+                              struct hiarena_block *block) {
+    arena->pos = (char *)block + HIARENA_HEADER_SIZE;
+    arena->end = arena->pos + block->size;
+}
+
+/* Allocate memory from the arena. The memory is aligned for any type and is
+ * valid until the arena is reset or released. Returns NULL when out of
+ * memory. */
+void *hiarena_alloc(struct hiarena *arena, size_t size) {
+    struct hiarena_block *block;
+    void *p;
+
+    if (size > SIZE_MAX - HIARENA_HEADER_SIZE - HIARENA_ALIGNMENT)
+        return NULL;
+    size = HIARENA_ALIGN(size);
+
+    if (size > (size_t)(arena->end - arena->pos)) {
+        /* Large allocations get a block of their own */
+        size_t block_size =
+            size > HIARENA_BLOCK_SIZE ? size : HIARENA_BLOCK_SIZE;
+
+        block = hi_malloc(HIARENA_HEADER_SIZE + block_size);
+        if (block == NULL)
+            return NULL;
+        block->size = block_size;
+        block->next = arena->blocks;
+        arena->blocks = block;
+        hiarena_use_block(arena, block);
+    }
+
+    p = arena->pos;
+    arena->pos += size;
+    return p;
+}
+
+/* Release all allocations made from the arena, but keep the first block for
+ * reuse unless it was a large allocation. */
+void hiarena_reset(struct hiarena *arena) {
+    struct hiarena_block *block, *next, *keep = NULL;
+
+    for (block = arena->blocks; block != NULL; block = next) {
+        next = block->next;
+        if (next == NULL && block->size == HIARENA_BLOCK_SIZE) {
+            keep = block;
+        } else {
+            hi_free(block);
+        }
+    }
+
+    hiarena_init(arena);
+    if (keep != NULL) {
+        arena->blocks = keep;
+        hiarena_use_block(arena, keep);
+    }
+}
+
+/* Release all allocations made from the arena and free its memory. */
+void hiarena_release(struct hiarena *arena) {
+    struct hiarena_block *block, *next;
+
+    for (block = arena->blocks; block != NULL; block = next) {
+        next = block->next;
+        hi_free(block);
+    }
+    hiarena_init(arena);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026, hiredis-cluster contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Redis nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __HIARENA_H_
+#define __HIARENA_H_
+
+#include <stddef.h>
+
+struct hiarena_block;
+
+/* A bump allocator for short-lived allocations that are released together,
+ * like the temporaries of a single request. Memory is allocated in blocks
+ * using the hiredis allocators. */
+struct hiarena {
+    struct hiarena_block *blocks; /* Most recently allocated block first */
+    char *pos;                    /* Next free byte in the current block */
+    char *end;                    /* End of the current block */
+};
+
+static inline void hiarena_init(struct hiarena *arena) {
+    arena->blocks = NULL;
+    arena->pos = NULL;
+    arena->end = NULL;
+}
+
+void *hiarena_alloc(struct hiarena *arena, size_t size);
+void hiarena_reset(struct hiarena *arena);
+void hiarena_release(struct hiarena *arena);
+
+#endif
@@ -31,6 +31,7 @@
 #ifndef __HIARRAY_H_
 #define __HIARRAY_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef int (*hiarray_compare_t)(const void *, const void *);
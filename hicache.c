@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2026, hiredis-cluster contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Redis nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <hiredis/alloc.h>
+#include <string.h>
+
+#include "dict.h"
+#include "hicache.h"
+
+/* The entries for a key, with the key stored after the struct */
+struct hicache_key {
+    hicache_buf name;
+    hicache_entry *entries;
+};
+
+static unsigned int dictBufHash(const void *key) {
+    const hicache_buf *buf = key;
+    return dictGenHashFunction((const unsigned char *)buf->str, buf->len);
+}
+
+static int dictBufKeyCompare(void *privdata, const void *key1,
+                             const void *key2) {
+    const hicache_buf *buf1 = key1, *buf2 = key2;
+    DICT_NOTUSED(privdata);
+
+    return buf1->len == buf2->len &&
+           memcmp(buf1->str, buf2->str, buf1->len) == 0;
+}
+
+/* The keys are stored in the values, which are owned by the cache */
+static dictType bufDictType = {
+    dictBufHash,       /* hash function */
+    NULL,              /* key dup */
+    NULL,              /* val dup */
+    dictBufKeyCompare, /* key compare */
+    NULL,              /* key destructor */
+    NULL               /* val destructor */
+};
+
+/* Copy a reply, adding its size to `size`. */
+static redisReply *reply_copy(const redisReply *r, size_t *size) {
+    redisReply *copy;
+    size_t i;
+
+    copy = hi_calloc(1, sizeof(*copy));
+    if (copy == NULL) {
+        return NULL;
+    }
+    *size += sizeof(*copy);
+
+    copy->type = r->type;
+    copy->integer = r->integer;
+    copy->dval = r->dval;
+    copy->len = r->len;
+    memcpy(copy->vtype, r->vtype, sizeof(copy->vtype));
+
+    if (r->str != NULL) {
+        copy->str = hi_malloc(r->len + 1);
+        if (copy->str == NULL) {
+            goto oom;
+        }
+        memcpy(copy->str, r->str, r->len);
+        copy->str[r->len] = '\0';
+        *size += r->len + 1;
+    }
+
+    if (r->element != NULL) {
+        copy->element = hi_calloc(r->elements, sizeof(redisReply *));
+        if (copy->element == NULL) {
+            goto oom;
+        }
+        copy->elements = r->elements;
+        *size += r->elements * sizeof(redisReply *);
+        for (i = 0; i < r->elements; i++) {
+            copy->element[i] = reply_copy(r->element[i], size);
+            if (copy->element[i] == NULL) {
+                goto oom;
+            }
+        }
+    }
+    return copy;
+
+oom:
+    freeReplyObject(copy);
+    return NULL;
+}
+
+hicache *hicache_create(size_t max_memory) {
+    hicache *cache;
+
+    cache = hi_calloc(1, sizeof(*cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->entries = dictCreate(&bufDictType, NULL);
+    cache->keys = dictCreate(&bufDictType, NULL);
+    if (cache->entries == NULL || cache->keys == NULL) {
+        hicache_free(cache);
+        return NULL;
+    }
+    cache->max_memory = max_memory;
+    return cache;
+}
+
+void hicache_free(hicache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    if (cache->entries != NULL && cache->keys != NULL) {
+        hicache_flush(cache);
+    }
+    if (cache->entries != NULL) {
+        dictRelease(cache->entries);
+    }
+    if (cache->keys != NULL) {
+        dictRelease(cache->keys);
+    }
+    hi_free(cache);
+}
+
+void hicache_release(hicache_entry *entry) {
+    if (--entry->refs > 0) {
+        return;
+    }
+    freeReplyObject(entry->reply);
+    hi_free(entry);
+}
+
+/* Remove an entry from the cache. It is freed when no longer referenced. */
+static void entry_remove(hicache *cache, hicache_entry *entry) {
+    struct hicache_key *key = entry->key;
+
+    dictDelete(cache->entries, &entry->cmd);
+
+    if (entry->lru_prev != NULL) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        cache->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        cache->lru_tail = entry->lru_prev;
+    }
+
+    if (entry->key_prev != NULL) {
+        entry->key_prev->key_next = entry->key_next;
+    } else {
+        key->entries = entry->key_next;
+    }
+    if (entry->key_next != NULL) {
+        entry->key_next->key_prev = entry->key_prev;
+    }
+    if (key->entries == NULL) {
+        dictDelete(cache->keys, &key->name);
+        cache->memory -= sizeof(*key) + key->name.len;
+        hi_free(key);
+    }
+
+    cache->memory -= entry->size;
+    hicache_release(entry);
+}
+
+static void entry_touch(hicache *cache, hicache_entry *entry) {
+    if (entry == cache->lru_head) {
+        return;
+    }
+    entry->lru_prev->lru_next = entry->lru_next;
+    if (entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        cache->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    cache->lru_head->lru_prev = entry;
+    cache->lru_head = entry;
+}
+
+hicache_entry *hicache_get(hicache *cache, const char *cmd, size_t cmdlen) {
+    hicache_buf buf = {cmd, cmdlen};
+    hicache_entry *entry;
+    dictEntry *de;
+
+    de = dictFind(cache->entries, &buf);
+    if (de == NULL) {
+        cache->misses++;
+        return NULL;
+    }
+    cache->hits++;
+    entry = dictGetEntryVal(de);
+    entry_touch(cache, entry);
+    entry->refs++;
+    return entry;
+}
+
+/* Get the entries of a key, adding the key if needed. */
+static struct hicache_key *key_get(hicache *cache, const char *name,
+                                   size_t len) {
+    hicache_buf buf = {name, len};
+    struct hicache_key *key;
+    dictEntry *de;
+
+    de = dictFind(cache->keys, &buf);
+    if (de != NULL) {
+        return dictGetEntryVal(de);
+    }
+
+    key = hi_malloc(sizeof(*key) + len);
+    if (key == NULL) {
+        return NULL;
+    }
+    memcpy(key + 1, name, len);
+    key->name.str = (const char *)(key + 1);
+    key->name.len = len;
+    key->entries = NULL;
+    if (dictAdd(cache->keys, &key->name, key) != DICT_OK) {
+        hi_free(key);
+        return NULL;
+    }
+    cache->memory += sizeof(*key) + len;
+    return key;
+}
+
+int hicache_add(hicache *cache, const char *cmd, size_t cmdlen,
+                const char *key, size_t keylen, int slot, void *source,
+                const redisReply *reply) {
+    hicache_buf buf = {cmd, cmdlen};
+    hicache_entry *entry;
+    dictEntry *de;
+    size_t size = sizeof(*entry) + cmdlen;
+
+    /* Replace a reply received for the same command, e.g. when the same
+     * command was sent twice before the first reply. */
+    de = dictFind(cache->entries, &buf);
+    if (de != NULL) {
+        entry_remove(cache, dictGetEntryVal(de));
+    }
+
+    entry = hi_malloc(size);
+    if (entry == NULL) {
+        return -1;
+    }
+    entry->reply = reply_copy(reply, &size);
+    if (entry->reply == NULL) {
+        hi_free(entry);
+        return -1;
+    }
+    if (size + sizeof(struct hicache_key) + keylen > cache->max_memory) {
+        /* Doesn't fit in the cache. */
+        freeReplyObject(entry->reply);
+        hi_free(entry);
+        return 0;
+    }
+
+    /* Make room for the entry. */
+    while (cache->lru_tail != NULL &&
+           cache->memory + size + sizeof(struct hicache_key) + keylen >
+               cache->max_memory) {
+        entry_remove(cache, cache->lru_tail);
+        cache->evictions++;
+    }
+
+    memcpy(entry + 1, cmd, cmdlen);
+    entry->cmd.str = (const char *)(entry + 1);
+    entry->cmd.len = cmdlen;
+    entry->slot = slot;
+    entry->source = source;
+    entry->size = size;
+    entry->refs = 1;
+
+    entry->key = key_get(cache, key, keylen);
+    if (entry->key == NULL ||
+        dictAdd(cache->entries, &entry->cmd, entry) != DICT_OK) {
+        if (entry->key != NULL && entry->key->entries == NULL) {
+            dictDelete(cache->keys, &entry->key->name);
+            cache->memory -= sizeof(struct hicache_key) + keylen;
+            hi_free(entry->key);
+        }
+        freeReplyObject(entry->reply);
+        hi_free(entry);
+        return -1;
+    }
+
+    entry->key_prev = NULL;
+    entry->key_next = entry->key->entries;
+    if (entry->key_next != NULL) {
+        entry->key_next->key_prev = entry;
+    }
+    entry->key->entries = entry;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != NULL) {
+        cache->lru_head->lru_prev = entry;
+    } else {
+        cache->lru_tail = entry;
+    }
+    cache->lru_head = entry;
+
+    cache->memory += size;
+    return 0;
+}
+
+void hicache_invalidate_key(hicache *cache, const char *key, size_t keylen) {
+    hicache_buf buf = {key, keylen};
+    struct hicache_key *k;
+    hicache_entry *entry;
+    dictEntry *de;
+    int last;
+
+    de = dictFind(cache->keys, &buf);
+    if (de == NULL) {
+        return;
+    }
+    k = dictGetEntryVal(de);
+    /* The key is freed together with its last entry. */
+    do {
+        entry = k->entries;
+        last = entry->key_next == NULL;
+        entry_remove(cache, entry);
+        cache->invalidations++;
+    } while (!last);
+}
+
+void hicache_invalidate_if(hicache *cache,
+                           int (*stale)(hicache_entry *entry, void *privdata),
+                           void *privdata) {
+    hicache_entry *entry, *next;
+
+    for (entry = cache->lru_head; entry != NULL; entry = next) {
+        next = entry->lru_next;
+        if (stale(entry, privdata)) {
+            entry_remove(cache, entry);
+            cache->invalidations++;
+        }
+    }
+}
+
+void hicache_flush(hicache *cache) {
+    while (cache->lru_head != NULL) {
+        entry_remove(cache, cache->lru_head);
+        cache->invalidations++;
+    }
+}
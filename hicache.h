@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026, hiredis-cluster contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Redis nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __HICACHE_H_
+#define __HICACHE_H_
+
+#include <hiredis/hiredis.h>
+#include <stddef.h>
+
+struct dict;
+struct hicache_key;
+
+typedef struct hicache_buf {
+    const char *str;
+    size_t len;
+} hicache_buf;
+
+/* A cached reply to a read command, found by the formatted command. Entries
+ * are referenced while their reply is being delivered, and freed when both
+ * released and removed from the cache. */
+typedef struct hicache_entry {
+    struct hicache_key *key; /* The key read by the command */
+    int slot;                /* Slot of the key */
+    void *source;            /* Connection the reply was received on */
+    redisReply *reply;
+    size_t size; /* Accounted memory */
+    int refs;    /* References held by the user of the cache, plus one while
+                    the entry is in the cache */
+    struct hicache_entry *lru_prev, *lru_next; /* Most recently used first */
+    struct hicache_entry *key_prev, *key_next; /* Other entries for the key */
+    hicache_buf cmd; /* The formatted command, stored after the entry */
+} hicache_entry;
+
+/* A memory bounded cache of replies, evicting the least recently used
+ * entries. */
+typedef struct hicache {
+    struct dict *entries; /* Formatted command to entry */
+    struct dict *keys;    /* Key to its entries */
+    hicache_entry *lru_head, *lru_tail;
+    size_t max_memory;
+    size_t memory;
+    unsigned long long hits, misses, invalidations, evictions;
+} hicache;
+
+hicache *hicache_create(size_t max_memory);
+void hicache_free(hicache *cache);
+
+/* Find the reply to a command, and reference it until hicache_release(). */
+hicache_entry *hicache_get(hicache *cache, const char *cmd, size_t cmdlen);
+void hicache_release(hicache_entry *entry);
+
+/* Add a copy of the reply to a command reading a key. Returns 0 on success and
+ * -1 when out of memory. */
+int hicache_add(hicache *cache, const char *cmd, size_t cmdlen,
+                const char *key, size_t keylen, int slot, void *source,
+                const redisReply *reply);
+
+void hicache_invalidate_key(hicache *cache, const char *key, size_t keylen);
+/* Remove all entries for which `stale` returns non-zero. */
+void hicache_invalidate_if(hicache *cache,
+                           int (*stale)(hicache_entry *entry, void *privdata),
+                           void *privdata);
+void hicache_flush(hicache *cache);
+
+#endif
@@ -35,14 +35,21 @@
 #include <ctype.h>
 #include <errno.h>
 #include <hiredis/alloc.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 #include "adlist.h"
 #include "command.h"
 #include "dict.h"
 #include "hiarray.h"
+#include "hicache.h"
 #include "hircluster.h"
 #include "hiutil.h"
 #include "win32.h"
@@ -66,9 +73,25 @@
 
 #define PORT_CPORT_SEPARATOR '@'
 
+/* Submitting commands from other threads needs a pipe to wake up the event
+ * loop and the atomic builtins of GCC and Clang, which define __ATOMIC_SEQ_CST.
+ * The C11 atomics would require atomic types in the public structs. */
+#if !defined(_WIN32) && defined(__ATOMIC_SEQ_CST)
+#define HAVE_SUBMIT 1
+/* Atomic operations on data shared with other threads, like the submit queue.
+ * The sequential consistency orders the wakeup flag with the queue links. */
+#define ATOMIC_LOAD(p) __atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+#define ATOMIC_EXCHANGE(p, v) __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST)
+#endif
+
 #define CLUSTER_ADDRESS_SEPARATOR ","
 
 #define CLUSTER_DEFAULT_MAX_RETRY_COUNT 5
+#define CLUSTER_DEFAULT_RECONNECT_BACKOFF_MIN 0        /* usec, disabled */
+#define CLUSTER_DEFAULT_RECONNECT_BACKOFF_MAX 0        /* usec */
+#define CLUSTER_DEFAULT_RETRY_BACKOFF_MIN 0            /* usec, disabled */
+#define CLUSTER_DEFAULT_RETRY_BACKOFF_MAX 0            /* usec */
 #define NO_RETRY -1
 
 #define CRLF "\x0d\x0a"
@@ -77,14 +100,80 @@
 #define SLOTMAP_UPDATE_THROTTLE_USEC 1000000
 #define SLOTMAP_UPDATE_ONGOING INT64_MAX
 
+/* Time to drain a pipeline on reset when no command timeout is set */
+#define PIPELINE_DRAIN_TIMEOUT_USEC 1000000
+
+/* Max number of unused objects kept in a context for reuse */
+#define CLUSTER_POOL_MAX_SIZE 128
+
+/* Response time tracking used by the least-latency read policy */
+#define NODE_LATENCY_EWMA_WEIGHT 8 /* Weight of the average vs a new sample */
+#define NODE_LATENCY_DECAY 1024 /* Decay of an unselected node's average */
+#define NODE_LATENCY_PEAK_STEP 2 /* Increase of the average per response */
+#define NODE_LATENCY_PENALTY 1000000 /* Latency given to unreachable nodes */
+#define NODE_INFLIGHT_WEIGHT 8 /* Waiting commands per extra response time */
+
 typedef struct cluster_async_data {
     redisClusterAsyncContext *acc;
     struct cmd *command;
     redisClusterCallbackFn *callback;
     int retry_count;
     void *privdata;
+    int64_t start; /* Send time when response times are tracked, or 0 */
+    int pending;   /* Counted as waiting for a reply on its connection */
+    int inflight;  /* Counted as waiting for a reply on its node */
+    struct cluster_async_data *next_free; /* Next unused entry in the pool */
+    int64_t first_retry; /* Time of the first delayed retry, or 0 */
+    void *timer;         /* Timer of a delayed retry */
+    struct cluster_async_data *prev_delayed, *next_delayed;
+    hicache_entry *cache_entry; /* Cached reply waiting to be delivered */
+    int cache_miss;             /* Cache the reply, reading the key at: */
+    uint32_t cache_key_pos, cache_key_len;
+    int64_t deadline; /* Time when the command expires, or 0 */
+    int expired;      /* Failed by its deadline, but the reply is awaited */
+    struct cluster_async_data *prev_deadline, *next_deadline;
 } cluster_async_data;
 
+/* An async connection in the connection pool of a node */
+typedef struct cluster_async_conn {
+    redisClusterNode *node;
+    redisAsyncContext *ac;
+    int pending; /* Number of commands waiting for a reply */
+} cluster_async_conn;
+
+/* Additional async connections to a node. The first `size - 1` connections
+ * are used together with node->acon for commands and the following
+ * `nblocking` connections are used for blocking commands. */
+struct cluster_async_pool {
+    int size;
+    int nblocking;
+    int acon_pending;  /* Number of commands waiting for a reply on acon */
+    unsigned int next; /* Where to start looking for the next connection */
+    cluster_async_conn conns[];
+};
+
+/* Deadlines of async commands are kept in a timer wheel with a slot per tick,
+ * driven by a single timer in the event loop which fires at the end of the
+ * first tick having commands. */
+#define DEADLINE_WHEEL_SLOTS 256
+#define DEADLINE_WHEEL_TICK_USEC 1000
+#define DEADLINE_WHEEL_SLOT(usec)                                              \
+    (((usec) / DEADLINE_WHEEL_TICK_USEC) % DEADLINE_WHEEL_SLOTS)
+
+struct cluster_async_wheel {
+    int64_t tick;       /* First tick not yet expired */
+    void *timer;        /* Timer in the event loop, or NULL */
+    int64_t timer_tick; /* Tick ending when the timer fires */
+    unsigned int count; /* Number of commands in the wheel */
+    struct cluster_async_data *slots[DEADLINE_WHEEL_SLOTS];
+};
+
+/* A formatted command sent on new connections */
+struct cluster_handshake_cmd {
+    char *cmd;
+    int len;
+};
+
 typedef enum CLUSTER_ERR_TYPE {
     CLUSTER_NOT_ERR = 0,
     CLUSTER_ERR_MOVED,
@@ -100,6 +189,14 @@ static void cluster_open_slot_destroy(copen_slot *oslot);
 static int updateNodesAndSlotmap(redisClusterContext *cc, dict *nodes);
 static int updateSlotMapAsync(redisClusterAsyncContext *acc,
                               redisAsyncContext *ac);
+#ifdef HAVE_SUBMIT
+static int cluster_shard_index(redisClusterContext *cc);
+static void cluster_shards_update(redisClusterContext *cc);
+static int cluster_shards_follow(redisClusterContext *cc);
+static void cluster_shards_request_update(redisClusterAsyncShards *shards);
+static void cluster_shards_handle(redisClusterAsyncContext *acc);
+static int cluster_shards_stop_requested(redisClusterAsyncContext *acc);
+#endif
 
 void listClusterNodeDestructor(void *val) { freeRedisClusterNode(val); }
 
@@ -162,6 +259,36 @@ void listCommandFree(void *command) {
     command_destroy(cmd);
 }
 
+/* Get a command, reusing an unused command from the pool when available. */
+static struct cmd *cluster_command_get(redisClusterContext *cc) {
+    struct cmd *command = cc->command_pool;
+
+    if (command == NULL) {
+        return command_get();
+    }
+    cc->command_pool = command->next_free;
+    cc->command_pool_n--;
+    command->next_free = NULL;
+    return command;
+}
+
+/* Release a command, keeping it in the pool for reuse if there is room. */
+static void cluster_command_release(redisClusterContext *cc,
+                                    struct cmd *command) {
+    if (command == NULL) {
+        return;
+    }
+
+    if (cc->command_pool_n >= CLUSTER_POOL_MAX_SIZE) {
+        command_destroy(command);
+        return;
+    }
+    command_reset(command);
+    command->next_free = cc->command_pool;
+    cc->command_pool = command;
+    cc->command_pool_n++;
+}
+
 /* -----------------------------------------------------------------------------
  * Key space handling
  * -------------------------------------------------------------------------- */
@@ -255,12 +382,68 @@ static redisClusterNode *createRedisClusterNode(void) {
     return hi_calloc(1, sizeof(redisClusterNode));
 }
 
+static void cluster_cache_connection_lost(redisAsyncContext *ac);
+
+static void cluster_async_pool_free(struct cluster_async_pool *pool) {
+    int i;
+
+    if (pool == NULL) {
+        return;
+    }
+    for (i = 0; i < pool->size - 1 + pool->nblocking; i++) {
+        if (pool->conns[i].ac != NULL) {
+            /* Detach the connection from the pool, like for node->acon */
+            pool->conns[i].ac->data = NULL;
+            cluster_cache_connection_lost(pool->conns[i].ac);
+            redisAsyncFree(pool->conns[i].ac);
+        }
+    }
+    hi_free(pool);
+}
+
+static void cluster_async_pool_disconnect(struct cluster_async_pool *pool) {
+    int i;
+
+    if (pool == NULL) {
+        return;
+    }
+    for (i = 0; i < pool->size - 1 + pool->nblocking; i++) {
+        if (pool->conns[i].ac != NULL) {
+            redisAsyncDisconnect(pool->conns[i].ac);
+        }
+    }
+}
+
+static void cluster_async_pool_set_timeout(struct cluster_async_pool *pool,
+                                           struct timeval tv) {
+    int i;
+
+    if (pool == NULL) {
+        return;
+    }
+    for (i = 0; i < pool->size - 1 + pool->nblocking; i++) {
+        if (pool->conns[i].ac != NULL) {
+            redisAsyncSetTimeout(pool->conns[i].ac, tv);
+        }
+    }
+}
+
 /* Cleanup the cluster node structure */
 static void freeRedisClusterNode(redisClusterNode *node) {
+    struct cmd *command, *next;
+
     if (node == NULL) {
         return;
     }
 
+    /* Pipelined commands waiting for replies from the node, when a slotmap
+     * update has removed it, get no replies */
+    for (command = node->pipeline_head; command != NULL; command = next) {
+        next = command->pipeline_next;
+        command->pipeline_next = NULL;
+        command->pipeline_node = NULL;
+    }
+
     sdsfree(node->name);
     sdsfree(node->addr);
     sdsfree(node->host);
@@ -271,8 +454,10 @@ static void freeRedisClusterNode(redisClusterNode *node) {
          * that redisAsyncFree() wont attempt to update the pointer via its
          * dataCleanup and unlinkAsyncContextAndNode() */
         node->acon->data = NULL;
+        cluster_cache_connection_lost(node->acon);
         redisAsyncFree(node->acon);
     }
+    cluster_async_pool_free(node->async_pool);
     if (node->slots != NULL) {
         listRelease(node->slots);
     }
@@ -393,44 +578,68 @@ static void cluster_open_slot_destroy(copen_slot *oslot) {
     hi_free(oslot);
 }
 
-/**
- * Handle password authentication in the synchronous API
- */
-static int authenticate(redisClusterContext *cc, redisContext *c) {
+/* Send the handshake commands to a new connection in the synchronous API:
+ * AUTH, HELLO, CLIENT SETNAME, READONLY when `readonly` is set, and the added
+ * commands. They are pipelined in a single write and the first error reply, if
+ * any, is returned after all replies are read. */
+static int cluster_handshake(redisClusterContext *cc, redisContext *c,
+                             int readonly) {
+    redisReply *reply;
+    int count = 0, ret = REDIS_OK, i;
+
     if (cc == NULL || c == NULL) {
         return REDIS_ERR;
     }
 
-    // Skip if no password configured
-    if (cc->password == NULL) {
-        return REDIS_OK;
+    if (cc->password != NULL) {
+        if (cc->username != NULL) {
+            ret = redisAppendCommand(c, "AUTH %s %s", cc->username,
+                                     cc->password);
+        } else {
+            ret = redisAppendCommand(c, "AUTH %s", cc->password);
+        }
+        count++;
     }
-
-    redisReply *reply;
-    if (cc->username != NULL) {
-        reply = redisCommand(c, "AUTH %s %s", cc->username, cc->password);
-    } else {
-        reply = redisCommand(c, "AUTH %s", cc->password);
+    if (ret == REDIS_OK && cc->protocol == 3) {
+        ret = redisAppendCommand(c, "HELLO 3");
+        count++;
     }
-
-    if (reply == NULL) {
-        __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                               "Command AUTH reply error (NULL)");
-        goto error;
+    if (ret == REDIS_OK && cc->client_name != NULL) {
+        ret = redisAppendCommand(c, "CLIENT SETNAME %s", cc->client_name);
+        count++;
     }
-
-    if (reply->type == REDIS_REPLY_ERROR) {
-        __redisClusterSetError(cc, REDIS_ERR_OTHER, reply->str);
-        goto error;
+    if (ret == REDIS_OK && readonly) {
+        ret = redisAppendCommand(c, "READONLY");
+        count++;
+    }
+    for (i = 0; ret == REDIS_OK && i < cc->handshake_ncmds; i++) {
+        ret = redisAppendFormattedCommand(c, cc->handshake_cmds[i].cmd,
+                                          cc->handshake_cmds[i].len);
+        count++;
+    }
+    if (ret != REDIS_OK) {
+        __redisClusterSetError(cc, c->err, c->errstr);
+        return REDIS_ERR;
     }
 
-    freeReplyObject(reply);
-    return REDIS_OK;
-
-error:
-    freeReplyObject(reply);
+    for (i = 0; i < count; i++) {
+        if (redisGetReply(c, (void **)&reply) != REDIS_OK) {
+            if (c->err) {
+                __redisClusterSetError(cc, c->err, c->errstr);
+            } else {
+                __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                                       "Handshake reply error (NULL)");
+            }
+            return REDIS_ERR;
+        }
+        if (ret == REDIS_OK && reply->type == REDIS_REPLY_ERROR) {
+            __redisClusterSetError(cc, REDIS_ERR_OTHER, reply->str);
+            ret = REDIS_ERR;
+        }
+        freeReplyObject(reply);
+    }
 
-    return REDIS_ERR;
+    return ret;
 }
 
 /**
@@ -572,11 +781,93 @@ error:
     return NULL;
 }
 
+static void cluster_node_swap_ctx(redisClusterNode *node_f,
+                                  redisClusterNode *node_t) {
+    redisContext *c;
+    redisAsyncContext *ac;
+    struct cluster_async_pool *pool;
+    struct cmd *command;
+    int i;
+
+    if (node_f->con != NULL) {
+        c = node_f->con;
+        node_f->con = node_t->con;
+        node_t->con = c;
+    }
+
+    /* Pipelined commands wait for replies on the connection */
+    if (node_f->pipeline_head != NULL) {
+        command = node_f->pipeline_head;
+        node_f->pipeline_head = node_t->pipeline_head;
+        node_t->pipeline_head = command;
+        command = node_f->pipeline_tail;
+        node_f->pipeline_tail = node_t->pipeline_tail;
+        node_t->pipeline_tail = command;
+
+        for (command = node_t->pipeline_head; command != NULL;
+             command = command->pipeline_next)
+            command->pipeline_node = node_t;
+        for (command = node_f->pipeline_head; command != NULL;
+             command = command->pipeline_next)
+            command->pipeline_node = node_f;
+    }
+
+    if (node_f->acon != NULL) {
+        ac = node_f->acon;
+        node_f->acon = node_t->acon;
+        node_t->acon = ac;
+
+        node_t->acon->data = node_t;
+        if (node_f->acon)
+            node_f->acon->data = node_f;
+    }
+
+    if (node_f->async_pool != NULL) {
+        pool = node_f->async_pool;
+        node_f->async_pool = node_t->async_pool;
+        node_t->async_pool = pool;
+
+        for (i = 0; i < pool->size - 1 + pool->nblocking; i++) {
+            pool->conns[i].node = node_t;
+        }
+        pool = node_f->async_pool;
+        for (i = 0; pool && i < pool->size - 1 + pool->nblocking; i++) {
+            pool->conns[i].node = node_f;
+        }
+    }
+
+    node_t->latency = node_f->latency;
+    node_t->inflight = node_f->inflight;
+    node_t->blocked = node_f->blocked;
+    node_t->failure_count = node_f->failure_count;
+    node_t->reconnect_after = node_f->reconnect_after;
+    node_t->last_used = node_f->last_used;
+}
+
+/* Move the contexts of replicas that are still replicas of the same master. */
+static void cluster_slaves_swap_ctx(hilist *slaves_f, hilist *slaves_t) {
+    redisClusterNode *slave_f, *slave_t;
+    listNode *ln_f, *ln_t;
+    listIter li_f, li_t;
+
+    listRewind(slaves_t, &li_t);
+    while ((ln_t = listNext(&li_t)) != NULL) {
+        slave_t = listNodeValue(ln_t);
+
+        listRewind(slaves_f, &li_f);
+        while ((ln_f = listNext(&li_f)) != NULL) {
+            slave_f = listNodeValue(ln_f);
+            if (strcmp(slave_f->addr, slave_t->addr) == 0) {
+                cluster_node_swap_ctx(slave_f, slave_t);
+                break;
+            }
+        }
+    }
+}
+
 static void cluster_nodes_swap_ctx(dict *nodes_f, dict *nodes_t) {
     dictEntry *de_f, *de_t;
     redisClusterNode *node_f, *node_t;
-    redisContext *c;
-    redisAsyncContext *ac;
 
     if (nodes_f == NULL || nodes_t == NULL) {
         return;
@@ -597,20 +888,10 @@ static void cluster_nodes_swap_ctx(dict *nodes_f, dict *nodes_t) {
         }
 
         node_f = dictGetEntryVal(de_f);
-        if (node_f->con != NULL) {
-            c = node_f->con;
-            node_f->con = node_t->con;
-            node_t->con = c;
-        }
-
-        if (node_f->acon != NULL) {
-            ac = node_f->acon;
-            node_f->acon = node_t->acon;
-            node_t->acon = ac;
+        cluster_node_swap_ctx(node_f, node_t);
 
-            node_t->acon->data = node_t;
-            if (node_f->acon)
-                node_f->acon->data = node_f;
+        if (node_f->slaves != NULL && node_t->slaves != NULL) {
+            cluster_slaves_swap_ctx(node_f->slaves, node_t->slaves);
         }
     }
 }
@@ -1261,7 +1542,8 @@ static int handleClusterNodesReply(redisClusterContext *cc, redisContext *c) {
                                    "(NULL).");
         }
         return REDIS_ERR;
-    } else if (reply->type != REDIS_REPLY_STRING) {
+    } else if (reply->type != REDIS_REPLY_STRING &&
+               reply->type != REDIS_REPLY_VERB) {
         if (reply->type == REDIS_REPLY_ERROR) {
             __redisClusterSetError(cc, REDIS_ERR_OTHER, reply->str);
         } else {
@@ -1330,7 +1612,7 @@ static int cluster_update_route_by_addr(redisClusterContext *cc, const char *ip,
         goto error;
     }
 
-    if (authenticate(cc, c) != REDIS_OK) {
+    if (cluster_handshake(cc, c, 0) != REDIS_OK) {
         goto error;
     }
 
@@ -1350,6 +1632,7 @@ error:
     return REDIS_ERR;
 }
 
+
 /* Update known cluster nodes with a new collection of redisClusterNodes.
  * Will also update the slot-to-node lookup table for the new nodes. */
 static int updateNodesAndSlotmap(redisClusterContext *cc, dict *nodes) {
@@ -1422,13 +1705,14 @@ static int updateNodesAndSlotmap(redisClusterContext *cc, dict *nodes) {
     if (oldnodes != NULL) {
         dictRelease(oldnodes);
     }
+#ifdef HAVE_SUBMIT
+    if (cc->shards != NULL) {
+        cluster_shards_update(cc);
+    }
+#endif
     if (cc->event_callback != NULL) {
         cc->event_callback(cc, HIRCLUSTER_EVENT_SLOTMAP_UPDATED,
                            cc->event_privdata);
-        if (cc->route_version == 1) {
-            /* Special event the first time the slotmap was updated. */
-            cc->event_callback(cc, HIRCLUSTER_EVENT_READY, cc->event_privdata);
-        }
     }
     cc->need_update_route = 0;
     return REDIS_OK;
@@ -1442,8 +1726,115 @@ error:
     return REDIS_ERR;
 }
 
+/* Check if connection attempts to a node are postponed. After a failed attempt
+ * no new attempts are made until the backoff time has passed, and then a
+ * single attempt is made which either resets or extends the backoff. */
+static int node_connect_postponed(redisClusterContext *cc,
+                                  redisClusterNode *node) {
+    return node->failure_count > 0 && cc->reconnect_backoff_min > 0 &&
+           hi_usec_now() < node->reconnect_after;
+}
+
+static int node_connect_allowed(redisClusterContext *cc,
+                                redisClusterNode *node) {
+    if (node_connect_postponed(cc, node)) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                               "node unavailable, reconnect postponed");
+        return 0;
+    }
+    return 1;
+}
+
+/* Get the delay of an exponential backoff, starting at `min` for the first
+ * attempt and doubled for each following attempt up to `max`. The delay is
+ * randomly reduced by up to a half to avoid that clients retry in lockstep. */
+static int64_t backoff_delay(int64_t min, int64_t max, int attempt) {
+    int64_t backoff = min;
+    int i;
+
+    for (i = 1; i < attempt && backoff < max; i++) {
+        backoff *= 2;
+    }
+    if (backoff > max) {
+        backoff = max;
+    }
+    return backoff - random() % (backoff / 2 + 1);
+}
+
+/* Update the reconnect backoff of a node after a connection attempt. */
+static void node_connect_done(redisClusterContext *cc, redisClusterNode *node,
+                              int failed) {
+    if (!failed) {
+        node->failure_count = 0;
+        node->reconnect_after = 0;
+        return;
+    }
+
+    node->failure_count++;
+    node->reconnect_after =
+        hi_usec_now() + backoff_delay(cc->reconnect_backoff_min,
+                                      cc->reconnect_backoff_max,
+                                      node->failure_count);
+}
+
+/* Get the time to retry a command at after a TRYAGAIN or CLUSTERDOWN reply,
+ * given the number of retries and the time of its first retry, which is set
+ * when zero. Returns -1 when the retry deadline would be passed. */
+static int64_t cluster_retry_time(redisClusterContext *cc, int retry_count,
+                                  int64_t *first_retry) {
+    int64_t now = hi_usec_now();
+    int64_t retry_at;
+
+    if (*first_retry == 0) {
+        *first_retry = now;
+    }
+    retry_at = now + backoff_delay(cc->retry_backoff_min,
+                                   cc->retry_backoff_max, retry_count);
+    if (cc->retry_backoff_deadline > 0 &&
+        retry_at - *first_retry > cc->retry_backoff_deadline) {
+        return -1;
+    }
+    return retry_at;
+}
+
+/* Special event sent once, after the first slotmap update and warm-up. */
+static void cluster_event_ready(redisClusterContext *cc) {
+    if (cc->ready) {
+        return;
+    }
+    cc->ready = 1;
+    if (cc->event_callback != NULL) {
+        cc->event_callback(cc, HIRCLUSTER_EVENT_READY, cc->event_privdata);
+    }
+}
+
+/* Connect to all masters, and to their replicas when enabled. Nodes that fail
+ * to connect are handled like when a command is sent to them. */
+static void cluster_warm_up(redisClusterContext *cc) {
+    redisClusterNode *node;
+    dictEntry *de;
+    listNode *ln;
+    listIter li;
+    dictIterator di;
+
+    dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        ctx_get_by_node(cc, node);
+
+        if (!(cc->flags & HIRCLUSTER_FLAG_WARM_UP_REPLICAS) ||
+            node->slaves == NULL) {
+            continue;
+        }
+        listRewind(node->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            ctx_get_by_node(cc, listNodeValue(ln));
+        }
+    }
+}
+
 int redisClusterUpdateSlotmap(redisClusterContext *cc) {
-    int ret;
+    int ret, pass;
     int flag_err_not_set = 1;
     redisClusterNode *node;
     dictEntry *de;
@@ -1456,26 +1847,42 @@ int redisClusterUpdateSlotmap(redisClusterContext *cc) {
         __redisClusterSetError(cc, REDIS_ERR_OTHER, "no server address");
         return REDIS_ERR;
     }
+#ifdef HAVE_SUBMIT
+    /* The first shard of a sharded client owns the slotmap */
+    if (cc->shards != NULL && cluster_shard_index(cc) > 0) {
+        return cluster_shards_follow(cc);
+    }
+#endif
 
-    dictIterator di;
-    dictInitIterator(&di, cc->nodes);
+    /* Nodes that recently failed to connect are only tried last. */
+    for (pass = 0; pass < 2; pass++) {
+        dictIterator di;
+        dictInitIterator(&di, cc->nodes);
 
-    while ((de = dictNext(&di)) != NULL) {
-        node = dictGetEntryVal(de);
-        if (node == NULL || node->host == NULL) {
-            continue;
-        }
+        while ((de = dictNext(&di)) != NULL) {
+            node = dictGetEntryVal(de);
+            if (node == NULL || node->host == NULL ||
+                node_connect_postponed(cc, node) != pass) {
+                continue;
+            }
 
-        ret = cluster_update_route_by_addr(cc, node->host, node->port);
-        if (ret == REDIS_OK) {
-            if (cc->err) {
-                cc->err = 0;
-                memset(cc->errstr, '\0', strlen(cc->errstr));
+            ret = cluster_update_route_by_addr(cc, node->host, node->port);
+            if (ret == REDIS_OK) {
+                /* The asynchronous API warms up its own connections. */
+                if ((cc->flags & HIRCLUSTER_FLAG_WARM_UP) &&
+                    !(cc->flags & HIRCLUSTER_FLAG_ASYNC)) {
+                    cluster_warm_up(cc);
+                }
+                cluster_event_ready(cc);
+                if (cc->err) {
+                    cc->err = 0;
+                    memset(cc->errstr, '\0', strlen(cc->errstr));
+                }
+                return REDIS_OK;
             }
-            return REDIS_OK;
-        }
 
-        flag_err_not_set = 0;
+            flag_err_not_set = 0;
+        }
     }
 
     if (flag_err_not_set) {
@@ -1493,6 +1900,11 @@ redisClusterContext *redisClusterContextInit(void) {
         return NULL;
 
     cc->max_retry_count = CLUSTER_DEFAULT_MAX_RETRY_COUNT;
+    cc->pool_size = 1;
+    cc->reconnect_backoff_min = CLUSTER_DEFAULT_RECONNECT_BACKOFF_MIN;
+    cc->reconnect_backoff_max = CLUSTER_DEFAULT_RECONNECT_BACKOFF_MAX;
+    cc->retry_backoff_min = CLUSTER_DEFAULT_RETRY_BACKOFF_MIN;
+    cc->retry_backoff_max = CLUSTER_DEFAULT_RETRY_BACKOFF_MAX;
     return cc;
 }
 
@@ -1535,6 +1947,12 @@ void redisClusterFree(redisClusterContext *cc) {
         listRelease(cc->requests);
     }
 
+    while (cc->command_pool != NULL) {
+        struct cmd *command = cc->command_pool;
+        cc->command_pool = command->next_free;
+        command_destroy(command);
+    }
+
     if (cc->username != NULL) {
         hi_free(cc->username);
         cc->username = NULL;
@@ -1545,6 +1963,10 @@ void redisClusterFree(redisClusterContext *cc) {
         cc->password = NULL;
     }
 
+    hi_free(cc->client_name);
+    redisClusterSetOptionHandshakeCommand(cc, NULL);
+    hi_free(cc->pollset);
+
     hi_free(cc);
 }
 
@@ -1828,78 +2250,281 @@ int redisClusterSetOptionPassword(redisClusterContext *cc,
     return REDIS_OK;
 }
 
-int redisClusterSetOptionParseSlaves(redisClusterContext *cc) {
+int redisClusterSetOptionProtocol(redisClusterContext *cc, int protocol) {
 
-    if (cc == NULL) {
+    if (cc == NULL || (protocol != 2 && protocol != 3)) {
         return REDIS_ERR;
     }
 
-    cc->flags |= HIRCLUSTER_FLAG_ADD_SLAVE;
+    cc->protocol = protocol;
 
     return REDIS_OK;
 }
 
-int redisClusterSetOptionParseOpenSlots(redisClusterContext *cc) {
-
+int redisClusterSetOptionClientName(redisClusterContext *cc,
+                                    const char *name) {
     if (cc == NULL) {
         return REDIS_ERR;
     }
 
-    cc->flags |= HIRCLUSTER_FLAG_ADD_OPENSLOT;
-
-    return REDIS_OK;
-}
+    hi_free(cc->client_name);
+    cc->client_name = NULL;
 
-int redisClusterSetOptionRouteUseSlots(redisClusterContext *cc) {
+    // Disabling option
+    if (name == NULL || name[0] == '\0') {
+        return REDIS_OK;
+    }
 
-    if (cc == NULL) {
+    cc->client_name = hi_strdup(name);
+    if (cc->client_name == NULL) {
         return REDIS_ERR;
     }
 
-    cc->flags |= HIRCLUSTER_FLAG_ROUTE_USE_SLOTS;
-
     return REDIS_OK;
 }
 
-int redisClusterSetOptionConnectTimeout(redisClusterContext *cc,
-                                        const struct timeval tv) {
+int redisClusterSetOptionHandshakeCommand(redisClusterContext *cc,
+                                          const char *format, ...) {
+    struct cluster_handshake_cmd *cmds;
+    char *cmd;
+    va_list ap;
+    int len, i;
 
     if (cc == NULL) {
         return REDIS_ERR;
     }
 
-    if (cc->connect_timeout == NULL) {
-        cc->connect_timeout = hi_malloc(sizeof(struct timeval));
-        if (cc->connect_timeout == NULL) {
-            __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
-            return REDIS_ERR;
+    if (format == NULL) {
+        for (i = 0; i < cc->handshake_ncmds; i++) {
+            hi_free(cc->handshake_cmds[i].cmd);
         }
+        hi_free(cc->handshake_cmds);
+        cc->handshake_cmds = NULL;
+        cc->handshake_ncmds = 0;
+        return REDIS_OK;
     }
 
-    memcpy(cc->connect_timeout, &tv, sizeof(struct timeval));
+    va_start(ap, format);
+    len = redisvFormatCommand(&cmd, format, ap);
+    va_end(ap);
+    if (len < 0) {
+        return REDIS_ERR;
+    }
+
+    cmds = hi_realloc(cc->handshake_cmds,
+                      (cc->handshake_ncmds + 1) * sizeof(*cmds));
+    if (cmds == NULL) {
+        hi_free(cmd);
+        return REDIS_ERR;
+    }
+    cmds[cc->handshake_ncmds].cmd = cmd;
+    cmds[cc->handshake_ncmds].len = len;
+    cc->handshake_cmds = cmds;
+    cc->handshake_ncmds++;
 
     return REDIS_OK;
 }
 
-int redisClusterSetOptionTimeout(redisClusterContext *cc,
-                                 const struct timeval tv) {
+int redisClusterSetOptionClientCache(redisClusterContext *cc,
+                                     size_t max_memory) {
     if (cc == NULL) {
         return REDIS_ERR;
     }
 
-    if (cc->command_timeout == NULL ||
-        cc->command_timeout->tv_sec != tv.tv_sec ||
-        cc->command_timeout->tv_usec != tv.tv_usec) {
+    cc->cache_max_memory = max_memory;
+    return REDIS_OK;
+}
 
-        if (cc->command_timeout == NULL) {
-            cc->command_timeout = hi_malloc(sizeof(struct timeval));
-            if (cc->command_timeout == NULL) {
-                __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
-                return REDIS_ERR;
-            }
-        }
+int redisClusterSetOptionParseSlaves(redisClusterContext *cc) {
 
-        memcpy(cc->command_timeout, &tv, sizeof(struct timeval));
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->flags |= HIRCLUSTER_FLAG_ADD_SLAVE;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionParseOpenSlots(redisClusterContext *cc) {
+
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->flags |= HIRCLUSTER_FLAG_ADD_OPENSLOT;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionRouteUseSlots(redisClusterContext *cc) {
+
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->flags |= HIRCLUSTER_FLAG_ROUTE_USE_SLOTS;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionReadPolicy(redisClusterContext *cc, int policy) {
+
+    if (cc == NULL || policy < HIRCLUSTER_READ_MASTER ||
+        policy > HIRCLUSTER_READ_LEAST_LATENCY) {
+        return REDIS_ERR;
+    }
+
+    cc->read_policy = policy;
+    if (policy != HIRCLUSTER_READ_MASTER) {
+        cc->flags |= HIRCLUSTER_FLAG_ADD_SLAVE;
+    }
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionConnectionPool(redisClusterContext *cc, int size,
+                                        int dispatch) {
+
+    if (cc == NULL || size < 1 || dispatch < HIRCLUSTER_POOL_LEAST_PENDING ||
+        dispatch > HIRCLUSTER_POOL_ROUND_ROBIN) {
+        return REDIS_ERR;
+    }
+
+    cc->pool_size = size;
+    cc->pool_dispatch = dispatch;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionBlockingConnections(redisClusterContext *cc) {
+
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->flags |= HIRCLUSTER_FLAG_BLOCKING_CONNECTIONS;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionWarmUp(redisClusterContext *cc, int replicas) {
+
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->flags |= HIRCLUSTER_FLAG_WARM_UP;
+    if (replicas) {
+        cc->flags |= HIRCLUSTER_FLAG_WARM_UP_REPLICAS;
+        cc->flags |= HIRCLUSTER_FLAG_ADD_SLAVE;
+    }
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionReconnectBackoff(redisClusterContext *cc,
+                                          const struct timeval min,
+                                          const struct timeval max) {
+    int64_t min_usec, max_usec;
+
+    min_usec = (int64_t)min.tv_sec * 1000000 + min.tv_usec;
+    max_usec = (int64_t)max.tv_sec * 1000000 + max.tv_usec;
+    if (cc == NULL || min_usec < 0 || max_usec < min_usec) {
+        return REDIS_ERR;
+    }
+
+    cc->reconnect_backoff_min = min_usec;
+    cc->reconnect_backoff_max = max_usec;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionIdleTimeout(redisClusterContext *cc,
+                                     const struct timeval tv) {
+    int64_t usec;
+
+    usec = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    if (cc == NULL || usec < 0) {
+        return REDIS_ERR;
+    }
+
+    cc->idle_timeout = usec;
+    cc->next_reap = 0;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionMaxConnections(redisClusterContext *cc, int max) {
+    if (cc == NULL || max < 0) {
+        return REDIS_ERR;
+    }
+
+    cc->max_connections = max;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionRetryBackoff(redisClusterContext *cc,
+                                      const struct timeval min,
+                                      const struct timeval max,
+                                      const struct timeval deadline) {
+    int64_t min_usec, max_usec, deadline_usec;
+
+    min_usec = (int64_t)min.tv_sec * 1000000 + min.tv_usec;
+    max_usec = (int64_t)max.tv_sec * 1000000 + max.tv_usec;
+    deadline_usec = (int64_t)deadline.tv_sec * 1000000 + deadline.tv_usec;
+    if (cc == NULL || min_usec < 0 || max_usec < min_usec ||
+        deadline_usec < 0) {
+        return REDIS_ERR;
+    }
+
+    cc->retry_backoff_min = min_usec;
+    cc->retry_backoff_max = max_usec;
+    cc->retry_backoff_deadline = deadline_usec;
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionConnectTimeout(redisClusterContext *cc,
+                                        const struct timeval tv) {
+
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    if (cc->connect_timeout == NULL) {
+        cc->connect_timeout = hi_malloc(sizeof(struct timeval));
+        if (cc->connect_timeout == NULL) {
+            __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+            return REDIS_ERR;
+        }
+    }
+
+    memcpy(cc->connect_timeout, &tv, sizeof(struct timeval));
+
+    return REDIS_OK;
+}
+
+int redisClusterSetOptionTimeout(redisClusterContext *cc,
+                                 const struct timeval tv) {
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    if (cc->command_timeout == NULL ||
+        cc->command_timeout->tv_sec != tv.tv_sec ||
+        cc->command_timeout->tv_usec != tv.tv_usec) {
+
+        if (cc->command_timeout == NULL) {
+            cc->command_timeout = hi_malloc(sizeof(struct timeval));
+            if (cc->command_timeout == NULL) {
+                __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+                return REDIS_ERR;
+            }
+        }
+
+        memcpy(cc->command_timeout, &tv, sizeof(struct timeval));
 
         /* Set timeout on already connected nodes */
         if (cc->nodes && dictSize(cc->nodes) > 0) {
@@ -1914,6 +2539,7 @@ int redisClusterSetOptionTimeout(redisClusterContext *cc,
                 if (node->acon) {
                     redisAsyncSetTimeout(node->acon, tv);
                 }
+                cluster_async_pool_set_timeout(node->async_pool, tv);
                 if (node->con && node->con->err == 0) {
                     redisSetTimeout(node->con, tv);
                 }
@@ -1930,6 +2556,7 @@ int redisClusterSetOptionTimeout(redisClusterContext *cc,
                         if (slave->acon) {
                             redisAsyncSetTimeout(slave->acon, tv);
                         }
+                        cluster_async_pool_set_timeout(slave->async_pool, tv);
                         if (slave->con && slave->con->err == 0) {
                             redisSetTimeout(slave->con, tv);
                         }
@@ -1944,7 +2571,7 @@ int redisClusterSetOptionTimeout(redisClusterContext *cc,
 
 int redisClusterSetOptionMaxRetry(redisClusterContext *cc,
                                   int max_retry_count) {
-    if (cc == NULL || max_retry_count <= 0) {
+    if (cc == NULL || max_retry_count < 0) {
         return REDIS_ERR;
     }
 
@@ -1965,16 +2592,170 @@ int redisClusterConnect2(redisClusterContext *cc) {
     return _redisClusterConnect2(cc);
 }
 
+/* Check if an async connection is open and not being closed. */
+static int actx_open(redisAsyncContext *ac) {
+    return ac != NULL && !(ac->c.flags & REDIS_DISCONNECTING);
+}
+
+/* Check if an async connection has replies to wait for, including pushed
+ * messages of subscriptions. */
+static int actx_busy(redisAsyncContext *ac) {
+    return ac != NULL &&
+           (ac->replies.head != NULL ||
+            (ac->c.flags & (REDIS_SUBSCRIBED | REDIS_MONITORING)));
+}
+
+/* Count the open connections to a node. */
+static int node_connection_count(redisClusterNode *node) {
+    struct cluster_async_pool *pool = node->async_pool;
+    int count = 0, i;
+
+    count += node->con != NULL;
+    count += actx_open(node->acon);
+    for (i = 0; pool != NULL && i < pool->size - 1 + pool->nblocking; i++) {
+        count += actx_open(pool->conns[i].ac);
+    }
+    return count;
+}
+
+/* Check if the connections to a node can be closed without losing replies.
+ * Synchronous connections are in use while pipelining. */
+static int node_connection_idle(redisClusterContext *cc,
+                                redisClusterNode *node) {
+    struct cluster_async_pool *pool = node->async_pool;
+    int i;
+
+    if (node->con != NULL &&
+        ((cc->requests != NULL && listLength(cc->requests) > 0) ||
+         node->pipeline_head != NULL || sdslen(node->con->obuf) > 0)) {
+        return 0;
+    }
+    if (actx_busy(node->acon)) {
+        return 0;
+    }
+    for (i = 0; pool != NULL && i < pool->size - 1 + pool->nblocking; i++) {
+        if (actx_busy(pool->conns[i].ac)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Close the connections to a node. They are opened again when needed. */
+static void node_connection_close(redisClusterNode *node) {
+    struct cluster_async_pool *pool = node->async_pool;
+    int i;
+
+    if (node->con != NULL) {
+        redisFree(node->con);
+        node->con = NULL;
+    }
+    if (actx_open(node->acon)) {
+        redisAsyncDisconnect(node->acon);
+    }
+    for (i = 0; pool != NULL && i < pool->size - 1 + pool->nblocking; i++) {
+        if (actx_open(pool->conns[i].ac)) {
+            redisAsyncDisconnect(pool->conns[i].ac);
+        }
+    }
+}
+
+/* Close the connections to a node when unused for the idle timeout if
+ * `reap_idle` is set, or else keep track of the least recently used node which
+ * connections can be closed. Returns the number of connections left open to
+ * the node. */
+static int node_reap(redisClusterContext *cc, redisClusterNode *node,
+                     redisClusterNode *except, int64_t now, int reap_idle,
+                     redisClusterNode **lru) {
+    int count = node_connection_count(node);
+
+    if (count == 0 || node == except || !node_connection_idle(cc, node)) {
+        return count;
+    }
+    if (node->last_used == 0) {
+        /* Connected without sending commands, e.g. by a slotmap update */
+        node->last_used = now;
+    }
+    if (reap_idle && now - node->last_used > cc->idle_timeout) {
+        node_connection_close(node);
+        return 0;
+    }
+    if (*lru == NULL || node->last_used < (*lru)->last_used) {
+        *lru = node;
+    }
+    return count;
+}
+
+/* Mark a node as used and close the connections to other nodes that are idle,
+ * see redisClusterSetOptionIdleTimeout(). When a new connection to the node
+ * is about to be opened, the connections to the least recently used nodes are
+ * closed to stay within redisClusterSetOptionMaxConnections(). */
+static void cluster_reap_connections(redisClusterContext *cc,
+                                     redisClusterNode *node, int connecting) {
+    redisClusterNode *lru, *master;
+    dictEntry *de;
+    dictIterator di;
+    listNode *ln;
+    listIter li;
+    int64_t now;
+    int count, reap_idle = 0;
+
+    now = hi_usec_now();
+    node->last_used = now;
+    if (cc->idle_timeout > 0 && now >= cc->next_reap) {
+        reap_idle = 1;
+        cc->next_reap = now + cc->idle_timeout / 2;
+    } else if (!connecting || cc->max_connections == 0) {
+        return;
+    }
+
+    for (;;) {
+        lru = NULL;
+        count = 0;
+        dictInitIterator(&di, cc->nodes);
+        while ((de = dictNext(&di)) != NULL) {
+            master = dictGetEntryVal(de);
+            count += node_reap(cc, master, node, now, reap_idle, &lru);
+            if (master->slaves == NULL) {
+                continue;
+            }
+            listRewind(master->slaves, &li);
+            while ((ln = listNext(&li)) != NULL) {
+                count += node_reap(cc, listNodeValue(ln), node, now,
+                                   reap_idle, &lru);
+            }
+        }
+        reap_idle = 0;
+
+        if (!connecting || cc->max_connections == 0 ||
+            count < cc->max_connections || lru == NULL) {
+            return;
+        }
+        node_connection_close(lru);
+    }
+}
+
 redisContext *ctx_get_by_node(redisClusterContext *cc, redisClusterNode *node) {
     redisContext *c = NULL;
     if (node == NULL) {
         return NULL;
     }
 
+    if (cc->idle_timeout > 0 || cc->max_connections > 0) {
+        cluster_reap_connections(cc, node, node->con == NULL);
+    }
+
     c = node->con;
     if (c != NULL) {
         if (c->err) {
+            if (!node_connect_allowed(cc, node)) {
+                return NULL;
+            }
+
             redisReconnect(c);
+            if (c->err != REDIS_ERR_OOM) {
+                node_connect_done(cc, node, c->err != 0);
+            }
 
             if (cc->on_connect) {
                 cc->on_connect(c, c->err ? REDIS_ERR : REDIS_OK);
@@ -1984,7 +2765,8 @@ redisContext *ctx_get_by_node(redisClusterContext *cc, redisClusterNode *node) {
                 __redisClusterSetError(cc, c->err, c->errstr);
             }
 
-            authenticate(cc, c); // err and errstr handled in function
+            // err and errstr handled in function
+            cluster_handshake(cc, c, node->role == REDIS_ROLE_SLAVE);
         }
 
         return c;
@@ -1994,6 +2776,10 @@ redisContext *ctx_get_by_node(redisClusterContext *cc, redisClusterNode *node) {
         return NULL;
     }
 
+    if (!node_connect_allowed(cc, node)) {
+        return NULL;
+    }
+
     redisOptions options = {0};
     REDIS_OPTIONS_SET_TCP(&options, node->host, node->port);
     options.connect_timeout = cc->connect_timeout;
@@ -2004,6 +2790,9 @@ redisContext *ctx_get_by_node(redisClusterContext *cc, redisClusterNode *node) {
         __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
         return NULL;
     }
+    if (c->err != REDIS_ERR_OOM) {
+        node_connect_done(cc, node, c->err != 0);
+    }
 
     if (cc->on_connect) {
         cc->on_connect(c, c->err ? REDIS_ERR : REDIS_OK);
@@ -2021,7 +2810,7 @@ redisContext *ctx_get_by_node(redisClusterContext *cc, redisClusterNode *node) {
         return NULL;
     }
 
-    if (authenticate(cc, c) != REDIS_OK) {
+    if (cluster_handshake(cc, c, node->role == REDIS_ROLE_SLAVE) != REDIS_OK) {
         redisFree(c);
         return NULL;
     }
@@ -2056,6 +2845,139 @@ static redisClusterNode *node_get_by_table(redisClusterContext *cc,
     return cc->table[slot_num];
 }
 
+/* Add a response time to the moving average of a node. The average follows
+ * an increase immediately, like a peak EWMA, so that a slow node is avoided
+ * until its average has decayed. It at most doubles per response, so that a
+ * single hiccup doesn't make a fast node look slower than a slow one. */
+static void node_update_latency(redisClusterNode *node, int64_t usec) {
+    if (usec <= 0) {
+        usec = 1; /* Zero means no measurement yet */
+    }
+    if (node->latency > 0 && usec > node->latency * NODE_LATENCY_PEAK_STEP) {
+        node->latency *= NODE_LATENCY_PEAK_STEP;
+    } else if (usec > node->latency) {
+        node->latency = usec;
+    } else {
+        node->latency += (usec - node->latency) / NODE_LATENCY_EWMA_WEIGHT;
+    }
+}
+
+/* Get the master or one of its replicas, where index n is the master. */
+static redisClusterNode *node_get_copy(redisClusterNode *master,
+                                       unsigned int n) {
+    listNode *ln;
+
+    if (n >= listLength(master->slaves)) {
+        return master;
+    }
+    ln = listIndex(master->slaves, n);
+    return ln != NULL ? listNodeValue(ln) : master;
+}
+
+/* Get the expected response time of a node. Commands waiting for a reply add
+ * to the average response time, but only a fraction of it each since a node
+ * handles pipelined commands back to back. A node without measurements is
+ * tried with one command at a time. */
+static int64_t node_read_cost(redisClusterNode *node) {
+    if (node->latency == 0) {
+        return node->inflight > 0 ? INT64_MAX : 0;
+    }
+    return node->latency +
+           node->latency * node->inflight / NODE_INFLIGHT_WEIGHT;
+}
+
+/* Select the node with the lowest expected response time using the power of
+ * two choices: two random nodes among the master and its replicas are
+ * compared. The average of the node not selected decays so that a node that
+ * used to be slow is eventually tried again. It decays by at least 1 usec,
+ * since a fraction of a sub-millisecond average may round down to nothing. */
+static redisClusterNode *node_select_least_latency(redisClusterContext *cc,
+                                                   redisClusterNode *master) {
+    redisClusterNode *a, *b, *tmp;
+    int64_t cost_a, cost_b;
+    unsigned int n, r;
+
+    n = (unsigned int)listLength(master->slaves) + 1;
+    cc->read_counter = cc->read_counter * 1103515245 + 12345;
+    r = cc->read_counter >> 8;
+
+    a = node_get_copy(master, r % n);
+    b = node_get_copy(master, (r % n + 1 + (r / n) % (n - 1)) % n);
+
+    cost_a = node_read_cost(a);
+    cost_b = node_read_cost(b);
+    if (cost_b < cost_a || (cost_b == cost_a && b->inflight < a->inflight)) {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+    if (b->latency > 1) {
+        b->latency -= b->latency / NODE_LATENCY_DECAY + 1;
+    }
+    return a;
+}
+
+/* Select the node to send a read-only command to, given the master serving its
+ * slot, according to the read policy. Returns the master itself when the
+ * command should not be sent to a replica. */
+static redisClusterNode *node_select_for_read(redisClusterContext *cc,
+                                              redisClusterNode *master) {
+    unsigned int n, i;
+    listNode *ln;
+
+    if (cc->read_policy == HIRCLUSTER_READ_MASTER || master->slaves == NULL ||
+        listLength(master->slaves) == 0) {
+        return master;
+    }
+
+    if (cc->read_policy == HIRCLUSTER_READ_LEAST_LATENCY) {
+        return node_select_least_latency(cc, master);
+    }
+
+    n = (unsigned int)listLength(master->slaves);
+    i = cc->read_counter++;
+    if (cc->read_policy == HIRCLUSTER_READ_ROUND_ROBIN) {
+        i %= n + 1;
+        if (i == n) {
+            return master;
+        }
+    } else {
+        i %= n;
+    }
+
+    ln = listIndex(master->slaves, i);
+    return ln != NULL ? listNodeValue(ln) : master;
+}
+
+/* Get a connection to a replica for a read-only command. The given master is
+ * replaced by the selected replica. Returns NULL when the command should be
+ * sent to the master instead, which includes when the replica can't be
+ * reached. */
+static redisContext *ctx_get_for_read(redisClusterContext *cc,
+                                      redisClusterNode **nodeptr) {
+    redisClusterNode *node;
+    redisContext *c;
+
+    node = node_select_for_read(cc, *nodeptr);
+    if (node == *nodeptr) {
+        return NULL;
+    }
+
+    c = ctx_get_by_node(cc, node);
+    if (c == NULL || c->err) {
+        /* Fallback to the master */
+        cc->err = 0;
+        cc->errstr[0] = '\0';
+        if (node->latency < NODE_LATENCY_PENALTY) {
+            node->latency = NODE_LATENCY_PENALTY;
+        }
+        return NULL;
+    }
+
+    *nodeptr = node;
+    return c;
+}
+
 /* Helper function for the redisClusterAppendCommand* family of functions.
  *
  * Write a formatted command to the output buffer. When this family
@@ -2094,55 +3016,279 @@ static int __redisClusterAppendCommand(redisClusterContext *cc,
     return REDIS_OK;
 }
 
-/* Helper functions for the redisClusterGetReply* family of functions.
- */
-static int __redisClusterGetReplyFromNode(redisClusterContext *cc,
-                                          redisClusterNode *node,
-                                          void **reply) {
-    redisContext *c;
+/* Pipelined commands are queued on the node they are sent to, in the order
+ * their replies will arrive. */
+static void cluster_pipeline_push(redisClusterNode *node, struct cmd *command) {
+    command->pipeline_next = NULL;
+    command->pipeline_node = node;
+    if (node->pipeline_tail != NULL)
+        node->pipeline_tail->pipeline_next = command;
+    else
+        node->pipeline_head = command;
+    node->pipeline_tail = command;
+}
 
-    if (cc == NULL || node == NULL || reply == NULL)
-        return REDIS_ERR;
+static struct cmd *cluster_pipeline_pop(redisClusterNode *node) {
+    struct cmd *command = node->pipeline_head;
 
-    c = node->con;
-    if (c == NULL) {
-        return REDIS_ERR;
-    } else if (c->err) {
-        if (cc->need_update_route == 0) {
-            cc->retry_count++;
-            if (cc->retry_count > cc->max_retry_count) {
-                cc->need_update_route = 1;
-                cc->retry_count = 0;
-            }
-        }
-        __redisClusterSetError(cc, c->err, c->errstr);
-        return REDIS_ERR;
+    if (command != NULL) {
+        node->pipeline_head = command->pipeline_next;
+        if (node->pipeline_head == NULL)
+            node->pipeline_tail = NULL;
+        command->pipeline_next = NULL;
+        command->pipeline_node = NULL;
     }
+    return command;
+}
 
-    if (redisGetReply(c, reply) != REDIS_OK) {
-        __redisClusterSetError(cc, c->err, c->errstr);
-        return REDIS_ERR;
+/* Closes the connection to a node when its replies can't be matched to the
+ * pipelined commands anymore. The commands waiting on it get no replies. */
+static void cluster_pipeline_drop(redisClusterNode *node) {
+    struct cmd *command;
+
+    while ((command = cluster_pipeline_pop(node)) != NULL)
+        command->asking = 0;
+    if (node->con != NULL) {
+        redisFree(node->con);
+        node->con = NULL;
     }
+}
 
-    if (cluster_reply_error_type(*reply) == CLUSTER_ERR_MOVED)
-        cc->need_update_route = 1;
+/* Closes the connections to the nodes which got the first parts of a command
+ * that could not be appended completely. Replies to these parts would be
+ * taken for the replies of the following commands. */
+static void cluster_pipeline_unsend(redisClusterContext *cc,
+                                    struct cmd *command, int appended) {
+    struct cmd *sub_command;
+    redisClusterNode *node;
+    listNode *list_node;
+    listIter li;
 
-    return REDIS_OK;
+    if (appended == 0)
+        return;
+    listRewind(command->sub_commands, &li);
+    while (appended-- > 0 && (list_node = listNext(&li)) != NULL) {
+        sub_command = list_node->value;
+        node = node_get_by_table(cc, (uint32_t)sub_command->slot_num);
+        if (node != NULL)
+            cluster_pipeline_drop(node);
+    }
+}
+
+/* Queues an appended command, or its sub-commands, on the nodes and assigns
+ * its position in the pipeline. */
+static void cluster_pipeline_add(redisClusterContext *cc, struct cmd *command) {
+    struct cmd *sub_command;
+    redisClusterNode *node;
+    listNode *list_node;
+    listIter li;
+
+    command->pipeline_index = cc->pipeline_appended++;
+
+    if (command->sub_commands == NULL) {
+        node = node_get_by_table(cc, (uint32_t)command->slot_num);
+        if (node != NULL)
+            cluster_pipeline_push(node, command);
+        return;
+    }
+
+    command->pipeline_part = listFirst(command->sub_commands);
+    command->pipeline_pending = (uint32_t)listLength(command->sub_commands);
+    listRewind(command->sub_commands, &li);
+    while ((list_node = listNext(&li)) != NULL) {
+        sub_command = list_node->value;
+        sub_command->parent = command;
+        node = node_get_by_table(cc, (uint32_t)sub_command->slot_num);
+        if (node != NULL)
+            cluster_pipeline_push(node, sub_command);
+    }
 }
 
-static int __redisClusterGetReply(redisClusterContext *cc, int slot_num,
-                                  void **reply) {
+static void cluster_pipeline_clear(redisClusterContext *cc) {
     redisClusterNode *node;
+    dictEntry *de;
+    dictIterator di;
+
+    dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        node->pipeline_head = NULL;
+        node->pipeline_tail = NULL;
+    }
+    cc->pipeline_appended = 0;
+    cc->pipeline_unclaimed = 0;
+}
 
-    if (cc == NULL || slot_num < 0 || reply == NULL)
+/* Switches a connection between blocking and nonblocking mode. */
+static int cluster_set_blocking(redisContext *c, int blocking) {
+#ifdef _WIN32
+    u_long mode = blocking ? 0 : 1;
+    if (ioctlsocket(c->fd, FIONBIO, &mode) != 0)
+        return REDIS_ERR;
+#else
+    int flags = fcntl(c->fd, F_GETFL);
+    if (flags == -1)
         return REDIS_ERR;
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    if (fcntl(c->fd, F_SETFL, flags) == -1)
+        return REDIS_ERR;
+#endif
+    if (blocking)
+        c->flags |= REDIS_BLOCK;
+    else
+        c->flags &= ~REDIS_BLOCK;
+    return REDIS_OK;
+}
 
-    node = node_get_by_table(cc, (uint32_t)slot_num);
-    if (node == NULL) {
+/* Returns arrays with room for a node and a pollfd per known node, kept in
+ * the context for reuse. */
+static redisClusterNode **cluster_pollset(redisClusterContext *cc,
+                                          struct pollfd **fds) {
+    size_t size = dictSize(cc->nodes);
+    void *pollset;
+
+    if (cc->pollset_size < size) {
+        pollset = hi_realloc(cc->pollset, size * (sizeof(redisClusterNode *) +
+                                                  sizeof(struct pollfd)));
+        if (pollset == NULL) {
+            __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+            return NULL;
+        }
+        cc->pollset = pollset;
+        cc->pollset_size = size;
+    }
+    *fds = (struct pollfd *)((redisClusterNode **)cc->pollset +
+                             cc->pollset_size);
+    return cc->pollset;
+}
+
+/* Writes the output buffers of all nodes. The connections are written in
+ * nonblocking mode from a single poll() loop, so a node which is slow to
+ * accept data doesn't hold back the others. Replies are read meanwhile, to
+ * keep a node from blocking while sending replies to a large pipeline. */
+static int cluster_pipeline_flush(redisClusterContext *cc) {
+    redisClusterNode *node, **nodes = NULL;
+    struct pollfd *fds;
+    redisContext *c;
+    dictEntry *de;
+    dictIterator di;
+    int n = 0, i, j, rc, wdone, timeout = -1, ret = REDIS_ERR;
+
+    dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        c = node->con;
+        if (c == NULL || c->err || sdslen(c->obuf) == 0)
+            continue;
+
+        if (nodes == NULL && (nodes = cluster_pollset(cc, &fds)) == NULL) {
+            return REDIS_ERR;
+        }
+        if (cluster_set_blocking(c, 0) != REDIS_OK) {
+            __redisClusterSetError(cc, REDIS_ERR_IO, NULL);
+            goto done;
+        }
+        nodes[n++] = node;
+    }
+    if (n == 0)
+        return REDIS_OK; /* Nothing to write */
+
+    if (cc->command_timeout != NULL) {
+        timeout = (int)(cc->command_timeout->tv_sec * 1000 +
+                        cc->command_timeout->tv_usec / 1000);
+    }
+
+    /* Nodes are dropped from the set when all their output is written */
+    for (i = 0; i < n; i++) {
+        fds[i].fd = nodes[i]->con->fd;
+        fds[i].events = POLLOUT | POLLIN;
+    }
+    for (int pending = n; pending > 0;) {
+        do {
+            rc = poll(fds, pending, timeout);
+        } while (rc < 0 && errno == EINTR);
+
+        if (rc < 0) {
+            __redisClusterSetError(cc, REDIS_ERR_IO, NULL);
+            goto done;
+        } else if (rc == 0) {
+            __redisClusterSetError(cc, REDIS_ERR_TIMEOUT,
+                                   "Timeout writing commands");
+            goto done;
+        }
+
+        for (i = 0, j = 0; i < pending; i++) {
+            c = nodes[i]->con;
+            wdone = 0;
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                redisBufferRead(c) != REDIS_OK) {
+                __redisClusterSetError(cc, c->err, c->errstr);
+                goto done;
+            }
+            if ((fds[i].revents & (POLLOUT | POLLERR)) &&
+                redisBufferWrite(c, &wdone) != REDIS_OK) {
+                __redisClusterSetError(cc, c->err, c->errstr);
+                goto done;
+            }
+            if (!wdone) {
+                /* Keep the node in the set */
+                redisClusterNode *tmp = nodes[j];
+                nodes[j] = nodes[i];
+                nodes[i] = tmp;
+                fds[j] = fds[i];
+                j++;
+            }
+        }
+        pending = j;
+    }
+    ret = REDIS_OK;
+
+done:
+    for (i = 0; i < n; i++) {
+        if (cluster_set_blocking(nodes[i]->con, 1) != REDIS_OK &&
+            ret == REDIS_OK) {
+            __redisClusterSetError(cc, REDIS_ERR_IO, NULL);
+            ret = REDIS_ERR;
+        }
+    }
+    return ret;
+}
+
+/* Helper functions for the redisClusterGetReply* family of functions.
+ */
+static int __redisClusterGetReplyFromNode(redisClusterContext *cc,
+                                          redisClusterNode *node,
+                                          void **reply) {
+    redisContext *c;
+
+    if (cc == NULL || node == NULL || reply == NULL)
+        return REDIS_ERR;
+
+    c = node->con;
+    if (c == NULL) {
+        return REDIS_ERR;
+    } else if (c->err) {
+        if (cc->need_update_route == 0) {
+            cc->retry_count++;
+            if (cc->retry_count > cc->max_retry_count) {
+                cc->need_update_route = 1;
+                cc->retry_count = 0;
+            }
+        }
+        __redisClusterSetError(cc, c->err, c->errstr);
         return REDIS_ERR;
     }
 
-    return __redisClusterGetReplyFromNode(cc, node, reply);
+    /* Send the pipeline to all nodes before waiting for this one */
+    if (sdslen(c->obuf) > 0 && cluster_pipeline_flush(cc) != REDIS_OK)
+        return REDIS_ERR;
+
+    if (redisGetReply(c, reply) != REDIS_OK) {
+        __redisClusterSetError(cc, c->err, c->errstr);
+        return REDIS_ERR;
+    }
+
+    return REDIS_OK;
 }
 
 /* Parses a MOVED or ASK error reply and returns the destination node. The slot
@@ -2241,6 +3387,8 @@ static void *redis_cluster_command_execute(redisClusterContext *cc,
     redisContext *c = NULL;
     int error_type;
     redisContext *c_updating_route = NULL;
+    int64_t start = 0;
+    int64_t first_retry = 0, retry_at;
 
 retry:
 
@@ -2257,7 +3405,13 @@ retry:
         }
     }
 
-    c = ctx_get_by_node(cc, node);
+    c = NULL;
+    if (command->readonly) {
+        c = ctx_get_for_read(cc, &node);
+    }
+    if (c == NULL) {
+        c = ctx_get_by_node(cc, node);
+    }
     if (c == NULL || c->err) {
         /* Failed to connect. Maybe there was a failover and this node is gone.
          * Update slotmap to find out. */
@@ -2281,6 +3435,10 @@ retry:
 moved_retry:
 ask_retry:
 
+    if (cc->read_policy == HIRCLUSTER_READ_LEAST_LATENCY) {
+        start = hi_usec_now();
+    }
+
     if (redisAppendFormattedCommand(c, command->cmd, command->clen) !=
         REDIS_OK) {
         __redisClusterSetError(cc, c->err, c->errstr);
@@ -2304,6 +3462,10 @@ ask_retry:
         goto error;
     }
 
+    if (start != 0) {
+        node_update_latency(node, hi_usec_now() - start);
+    }
+
     error_type = cluster_reply_error_type(reply);
     if (error_type > CLUSTER_NOT_ERR && error_type < CLUSTER_ERR_SENTINEL) {
         cc->retry_count++;
@@ -2389,6 +3551,19 @@ ask_retry:
         case CLUSTER_ERR_CLUSTERDOWN:
             freeReplyObject(reply);
             reply = NULL;
+
+            if (cc->retry_backoff_min > 0) {
+                /* Wait for the migration or failover to complete. */
+                retry_at =
+                    cluster_retry_time(cc, cc->retry_count, &first_retry);
+                if (retry_at < 0) {
+                    __redisClusterSetError(cc,
+                                           REDIS_ERR_CLUSTER_TOO_MANY_RETRIES,
+                                           "cluster retry deadline exceeded");
+                    goto error;
+                }
+                hi_usec_wait_until(retry_at);
+            }
             goto retry;
 
             break;
@@ -2425,343 +3600,373 @@ done:
     return reply;
 }
 
-static int command_pre_fragment(redisClusterContext *cc, struct cmd *command,
-                                hilist *commands) {
-
-    struct keypos *kp, *sub_kp;
-    uint32_t key_count;
-    uint32_t i, j;
+/* Build the formatted command of a fragment of a multi-key command from the
+ * keys that have been added to it. The formatted command is allocated from
+ * the arena of the original command. */
+static int command_format_fragment(struct cmd *command,
+                                   struct cmd *sub_command) {
+    struct keypos *kp;
+    uint32_t j;
     uint32_t idx;
     uint32_t key_len;
-    int slot_num = -1;
-    struct cmd *sub_command;
-    struct cmd **sub_commands = NULL;
     char num_str[12];
     uint8_t num_str_len;
 
-    if (command == NULL || commands == NULL) {
-        goto done;
-    }
-
-    key_count = hiarray_n(command->keys);
-
-    sub_commands = hi_calloc(REDIS_CLUSTER_SLOTS, sizeof(*sub_commands));
-    if (sub_commands == NULL) {
-        goto oom;
-    }
+    idx = 0;
+    if (command->type == CMD_REQ_REDIS_MGET) {
+        //"*%d\r\n$4\r\nmget\r\n"
 
-    command->frag_seq = hi_calloc(key_count, sizeof(*command->frag_seq));
-    if (command->frag_seq == NULL) {
-        goto oom;
-    }
+        sub_command->clen += 5 * sub_command->narg;
 
-    // Fill sub_command with key, slot and command length (clen, only keylength)
-    for (i = 0; i < key_count; i++) {
-        kp = hiarray_get(command->keys, i);
+        sub_command->narg++;
 
-        slot_num = keyHashSlot(kp->start, kp->end - kp->start);
+        hi_itoa(num_str, sub_command->narg);
+        num_str_len = (uint8_t)(strlen(num_str));
 
-        if (slot_num < 0 || slot_num >= REDIS_CLUSTER_SLOTS) {
-            __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                                   "keyHashSlot return error");
-            goto done;
-        }
+        sub_command->clen += 13 + num_str_len;
 
-        if (sub_commands[slot_num] == NULL) {
-            sub_commands[slot_num] = command_get();
-            if (sub_commands[slot_num] == NULL) {
-                goto oom;
-            }
+        sub_command->cmd = hiarena_alloc(&command->arena, sub_command->clen);
+        if (sub_command->cmd == NULL) {
+            return REDIS_ERR;
         }
 
-        command->frag_seq[i] = sub_command = sub_commands[slot_num];
+        sub_command->cmd[idx++] = '*';
+        memcpy(sub_command->cmd + idx, num_str, num_str_len);
+        idx += num_str_len;
+        memcpy(sub_command->cmd + idx, "\r\n$4\r\nmget\r\n", 12);
+        idx += 12;
 
-        sub_command->narg++;
+        for (j = 0; j < hiarray_n(sub_command->keys); j++) {
+            kp = hiarray_get(sub_command->keys, j);
+            key_len = (uint32_t)(kp->end - kp->start);
+            hi_itoa(num_str, key_len);
+            num_str_len = strlen(num_str);
 
-        sub_kp = hiarray_push(sub_command->keys);
-        if (sub_kp == NULL) {
-            goto oom;
+            sub_command->cmd[idx++] = '$';
+            memcpy(sub_command->cmd + idx, num_str, num_str_len);
+            idx += num_str_len;
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
+            memcpy(sub_command->cmd + idx, kp->start, key_len);
+            idx += key_len;
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
         }
+    } else if (command->type == CMD_REQ_REDIS_DEL) {
+        //"*%d\r\n$3\r\ndel\r\n"
 
-        sub_kp->start = kp->start;
-        sub_kp->end = kp->end;
-
-        // Number of characters in key
-        key_len = (uint32_t)(kp->end - kp->start);
+        sub_command->clen += 5 * sub_command->narg;
 
-        sub_command->clen += key_len + uint_len(key_len);
+        sub_command->narg++;
 
-        sub_command->slot_num = slot_num;
+        hi_itoa(num_str, sub_command->narg);
+        num_str_len = (uint8_t)strlen(num_str);
 
-        if (command->type == CMD_REQ_REDIS_MSET) {
-            uint32_t len = 0;
-            char *p;
+        sub_command->clen += 12 + num_str_len;
 
-            for (p = sub_kp->end + 1; !isdigit(*p); p++) {
-            }
+        sub_command->cmd = hiarena_alloc(&command->arena, sub_command->clen);
+        if (sub_command->cmd == NULL) {
+            return REDIS_ERR;
+        }
 
-            p = sub_kp->end + 1;
-            while (!isdigit(*p)) {
-                p++;
-            }
+        sub_command->cmd[idx++] = '*';
+        memcpy(sub_command->cmd + idx, num_str, num_str_len);
+        idx += num_str_len;
+        memcpy(sub_command->cmd + idx, "\r\n$3\r\ndel\r\n", 11);
+        idx += 11;
 
-            for (; isdigit(*p); p++) {
-                len = len * 10 + (uint32_t)(*p - '0');
-            }
+        for (j = 0; j < hiarray_n(sub_command->keys); j++) {
+            kp = hiarray_get(sub_command->keys, j);
+            key_len = (uint32_t)(kp->end - kp->start);
+            hi_itoa(num_str, key_len);
+            num_str_len = strlen(num_str);
 
-            len += CRLF_LEN * 2;
-            len += (p - sub_kp->end);
-            sub_kp->remain_len = len;
-            sub_command->clen += len;
+            sub_command->cmd[idx++] = '$';
+            memcpy(sub_command->cmd + idx, num_str, num_str_len);
+            idx += num_str_len;
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
+            memcpy(sub_command->cmd + idx, kp->start, key_len);
+            idx += key_len;
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
         }
-    }
+    } else if (command->type == CMD_REQ_REDIS_EXISTS) {
+        //"*%d\r\n$6\r\nexists\r\n"
 
-    /* prepend command header */
-    for (i = 0; i < REDIS_CLUSTER_SLOTS; i++) {
-        sub_command = sub_commands[i];
-        if (sub_command == NULL) {
-            continue;
-        }
+        sub_command->clen += 5 * sub_command->narg;
 
-        idx = 0;
-        if (command->type == CMD_REQ_REDIS_MGET) {
-            //"*%d\r\n$4\r\nmget\r\n"
+        sub_command->narg++;
 
-            sub_command->clen += 5 * sub_command->narg;
+        hi_itoa(num_str, sub_command->narg);
+        num_str_len = (uint8_t)strlen(num_str);
 
-            sub_command->narg++;
+        sub_command->clen += 15 + num_str_len;
 
-            hi_itoa(num_str, sub_command->narg);
-            num_str_len = (uint8_t)(strlen(num_str));
+        sub_command->cmd = hiarena_alloc(&command->arena, sub_command->clen);
+        if (sub_command->cmd == NULL) {
+            return REDIS_ERR;
+        }
 
-            sub_command->clen += 13 + num_str_len;
+        sub_command->cmd[idx++] = '*';
+        memcpy(sub_command->cmd + idx, num_str, num_str_len);
+        idx += num_str_len;
+        memcpy(sub_command->cmd + idx, "\r\n$6\r\nexists\r\n", 14);
+        idx += 14;
 
-            sub_command->cmd =
-                hi_calloc(sub_command->clen, sizeof(*sub_command->cmd));
-            if (sub_command->cmd == NULL) {
-                goto oom;
-            }
+        for (j = 0; j < hiarray_n(sub_command->keys); j++) {
+            kp = hiarray_get(sub_command->keys, j);
+            key_len = (uint32_t)(kp->end - kp->start);
+            hi_itoa(num_str, key_len);
+            num_str_len = strlen(num_str);
 
-            sub_command->cmd[idx++] = '*';
+            sub_command->cmd[idx++] = '$';
             memcpy(sub_command->cmd + idx, num_str, num_str_len);
             idx += num_str_len;
-            memcpy(sub_command->cmd + idx, "\r\n$4\r\nmget\r\n", 12);
-            idx += 12;
-
-            for (j = 0; j < hiarray_n(sub_command->keys); j++) {
-                kp = hiarray_get(sub_command->keys, j);
-                key_len = (uint32_t)(kp->end - kp->start);
-                hi_itoa(num_str, key_len);
-                num_str_len = strlen(num_str);
-
-                sub_command->cmd[idx++] = '$';
-                memcpy(sub_command->cmd + idx, num_str, num_str_len);
-                idx += num_str_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-                memcpy(sub_command->cmd + idx, kp->start, key_len);
-                idx += key_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-            }
-        } else if (command->type == CMD_REQ_REDIS_DEL) {
-            //"*%d\r\n$3\r\ndel\r\n"
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
+            memcpy(sub_command->cmd + idx, kp->start, key_len);
+            idx += key_len;
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
+        }
+    } else if (command->type == CMD_REQ_REDIS_MSET) {
+        //"*%d\r\n$4\r\nmset\r\n"
 
-            sub_command->clen += 5 * sub_command->narg;
+        sub_command->clen += 3 * sub_command->narg;
 
-            sub_command->narg++;
+        sub_command->narg *= 2;
 
-            hi_itoa(num_str, sub_command->narg);
-            num_str_len = (uint8_t)strlen(num_str);
+        sub_command->narg++;
 
-            sub_command->clen += 12 + num_str_len;
+        hi_itoa(num_str, sub_command->narg);
+        num_str_len = (uint8_t)strlen(num_str);
 
-            sub_command->cmd =
-                hi_calloc(sub_command->clen, sizeof(*sub_command->cmd));
-            if (sub_command->cmd == NULL) {
-                goto oom;
-            }
+        sub_command->clen += 13 + num_str_len;
+
+        sub_command->cmd = hiarena_alloc(&command->arena, sub_command->clen);
+        if (sub_command->cmd == NULL) {
+            return REDIS_ERR;
+        }
+
+        sub_command->cmd[idx++] = '*';
+        memcpy(sub_command->cmd + idx, num_str, num_str_len);
+        idx += num_str_len;
+        memcpy(sub_command->cmd + idx, "\r\n$4\r\nmset\r\n", 12);
+        idx += 12;
 
-            sub_command->cmd[idx++] = '*';
+        for (j = 0; j < hiarray_n(sub_command->keys); j++) {
+            kp = hiarray_get(sub_command->keys, j);
+            key_len = (uint32_t)(kp->end - kp->start);
+            hi_itoa(num_str, key_len);
+            num_str_len = strlen(num_str);
+
+            sub_command->cmd[idx++] = '$';
             memcpy(sub_command->cmd + idx, num_str, num_str_len);
             idx += num_str_len;
-            memcpy(sub_command->cmd + idx, "\r\n$3\r\ndel\r\n", 11);
-            idx += 11;
-
-            for (j = 0; j < hiarray_n(sub_command->keys); j++) {
-                kp = hiarray_get(sub_command->keys, j);
-                key_len = (uint32_t)(kp->end - kp->start);
-                hi_itoa(num_str, key_len);
-                num_str_len = strlen(num_str);
-
-                sub_command->cmd[idx++] = '$';
-                memcpy(sub_command->cmd + idx, num_str, num_str_len);
-                idx += num_str_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-                memcpy(sub_command->cmd + idx, kp->start, key_len);
-                idx += key_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-            }
-        } else if (command->type == CMD_REQ_REDIS_EXISTS) {
-            //"*%d\r\n$6\r\nexists\r\n"
-
-            sub_command->clen += 5 * sub_command->narg;
+            memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
+            idx += CRLF_LEN;
+            memcpy(sub_command->cmd + idx, kp->start,
+                   key_len + kp->remain_len);
+            idx += key_len + kp->remain_len;
+        }
+    } else {
+        NOT_REACHED();
+    }
 
-            sub_command->narg++;
+    sub_command->type = command->type;
+    return REDIS_OK;
+}
 
-            hi_itoa(num_str, sub_command->narg);
-            num_str_len = (uint8_t)strlen(num_str);
+/* A key in a multi-key command and its slot, used when splitting the command */
+struct slot_key {
+    uint32_t slot;
+    uint32_t idx; /* index of the key in the command */
+};
 
-            sub_command->clen += 15 + num_str_len;
+static int slot_key_cmp(const void *p1, const void *p2) {
+    const struct slot_key *k1 = p1, *k2 = p2;
 
-            sub_command->cmd =
-                hi_calloc(sub_command->clen, sizeof(*sub_command->cmd));
-            if (sub_command->cmd == NULL) {
-                goto oom;
-            }
+    if (k1->slot != k2->slot) {
+        return k1->slot < k2->slot ? -1 : 1;
+    }
+    return k1->idx < k2->idx ? -1 : k1->idx > k2->idx;
+}
 
-            sub_command->cmd[idx++] = '*';
-            memcpy(sub_command->cmd + idx, num_str, num_str_len);
-            idx += num_str_len;
-            memcpy(sub_command->cmd + idx, "\r\n$6\r\nexists\r\n", 14);
-            idx += 14;
-
-            for (j = 0; j < hiarray_n(sub_command->keys); j++) {
-                kp = hiarray_get(sub_command->keys, j);
-                key_len = (uint32_t)(kp->end - kp->start);
-                hi_itoa(num_str, key_len);
-                num_str_len = strlen(num_str);
-
-                sub_command->cmd[idx++] = '$';
-                memcpy(sub_command->cmd + idx, num_str, num_str_len);
-                idx += num_str_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-                memcpy(sub_command->cmd + idx, kp->start, key_len);
-                idx += key_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-            }
-        } else if (command->type == CMD_REQ_REDIS_MSET) {
-            //"*%d\r\n$4\r\nmset\r\n"
+/* Split a multi-key command into sub-commands per slot when needed. The
+ * sub-commands and other temporaries are allocated from the arena of the
+ * command and the sub-commands are added to command->sub_commands. */
+static int command_pre_fragment(redisClusterContext *cc, struct cmd *command) {
 
-            sub_command->clen += 3 * sub_command->narg;
+    struct keypos *kp, *sub_kp;
+    uint32_t key_count;
+    uint32_t i, j;
+    uint32_t key_len;
+    int slot_num = -1;
+    int single_slot = 1;
+    struct cmd *sub_command = NULL;
+    struct slot_key *slot_keys = NULL;
 
-            sub_command->narg *= 2;
+    if (command == NULL) {
+        goto done;
+    }
 
-            sub_command->narg++;
+    key_count = hiarray_n(command->keys);
 
-            hi_itoa(num_str, sub_command->narg);
-            num_str_len = (uint8_t)strlen(num_str);
+    slot_keys = hiarena_alloc(&command->arena, key_count * sizeof(*slot_keys));
+    if (slot_keys == NULL) {
+        goto oom;
+    }
 
-            sub_command->clen += 13 + num_str_len;
+    for (i = 0; i < key_count; i++) {
+        kp = hiarray_get(command->keys, i);
 
-            sub_command->cmd =
-                hi_calloc(sub_command->clen, sizeof(*sub_command->cmd));
-            if (sub_command->cmd == NULL) {
-                goto oom;
-            }
+        slot_num = keyHashSlot(kp->start, kp->end - kp->start);
 
-            sub_command->cmd[idx++] = '*';
-            memcpy(sub_command->cmd + idx, num_str, num_str_len);
-            idx += num_str_len;
-            memcpy(sub_command->cmd + idx, "\r\n$4\r\nmset\r\n", 12);
-            idx += 12;
-
-            for (j = 0; j < hiarray_n(sub_command->keys); j++) {
-                kp = hiarray_get(sub_command->keys, j);
-                key_len = (uint32_t)(kp->end - kp->start);
-                hi_itoa(num_str, key_len);
-                num_str_len = strlen(num_str);
-
-                sub_command->cmd[idx++] = '$';
-                memcpy(sub_command->cmd + idx, num_str, num_str_len);
-                idx += num_str_len;
-                memcpy(sub_command->cmd + idx, CRLF, CRLF_LEN);
-                idx += CRLF_LEN;
-                memcpy(sub_command->cmd + idx, kp->start,
-                       key_len + kp->remain_len);
-                idx += key_len + kp->remain_len;
-            }
-        } else {
-            NOT_REACHED();
+        if (slot_num < 0 || slot_num >= REDIS_CLUSTER_SLOTS) {
+            __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                                   "keyHashSlot return error");
+            slot_num = -1;
+            goto done;
         }
 
-        sub_command->type = command->type;
-
-        if (listAddNodeTail(commands, sub_command) == NULL) {
-            goto oom;
+        slot_keys[i].slot = (uint32_t)slot_num;
+        slot_keys[i].idx = i;
+        if (slot_keys[i].slot != slot_keys[0].slot) {
+            single_slot = 0;
         }
-        sub_commands[i] = NULL;
     }
 
-done:
-    hi_free(sub_commands);
+    if (single_slot) {
+        /* All keys belong to one slot, the command is sent as is */
+        command->slot_num = slot_num;
+        goto done;
+    }
+
+    /* Order the keys by slot, keeping the order of keys within a slot, and
+     * create a sub-command for each run of keys in the same slot. */
+    qsort(slot_keys, key_count, sizeof(*slot_keys), slot_key_cmp);
+
+    command->sub_commands = listCreate();
+    if (command->sub_commands == NULL) {
+        goto oom;
+    }
+    command->sub_commands->free = listCommandFree;
 
-    if (slot_num >= 0 && commands != NULL && listLength(commands) == 1) {
-        listNode *list_node = listFirst(commands);
-        listDelNode(commands, list_node);
-        if (command->frag_seq) {
-            hi_free(command->frag_seq);
-            command->frag_seq = NULL;
+    for (i = 0; i < key_count; i = j) {
+        sub_command = command_get_from_arena(&command->arena);
+        if (sub_command == NULL) {
+            goto oom;
         }
 
-        command->slot_num = slot_num;
+        sub_command->slot_num = (int)slot_keys[i].slot;
+        sub_command->readonly = command->readonly;
+
+        // Fill sub_command with keys and command length (clen, only keylength)
+        for (j = i; j < key_count && slot_keys[j].slot == slot_keys[i].slot;
+             j++) {
+            kp = hiarray_get(command->keys, slot_keys[j].idx);
+
+            sub_command->narg++;
+
+            sub_kp = command_push_key(sub_command);
+            if (sub_kp == NULL) {
+                goto oom;
+            }
+
+            sub_kp->start = kp->start;
+            sub_kp->end = kp->end;
+            sub_kp->key_idx = kp->key_idx;
+
+            // Number of characters in key
+            key_len = (uint32_t)(kp->end - kp->start);
+
+            sub_command->clen += key_len + uint_len(key_len);
+
+            if (command->type == CMD_REQ_REDIS_MSET) {
+                uint32_t len = 0;
+                char *p;
+
+                p = sub_kp->end + 1;
+                while (!isdigit(*p)) {
+                    p++;
+                }
+
+                for (; isdigit(*p); p++) {
+                    len = len * 10 + (uint32_t)(*p - '0');
+                }
+
+                len += CRLF_LEN * 2;
+                len += (p - sub_kp->end);
+                sub_kp->remain_len = len;
+                sub_command->clen += len;
+            }
+        }
+
+        /* prepend command header */
+        if (command_format_fragment(command, sub_command) != REDIS_OK) {
+            goto oom;
+        }
+
+        if (listAddNodeTail(command->sub_commands, sub_command) == NULL) {
+            goto oom;
+        }
+        sub_command = NULL;
     }
+
+done:
     return slot_num;
 
 oom:
     __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
-    if (sub_commands != NULL) {
-        for (i = 0; i < REDIS_CLUSTER_SLOTS; i++) {
-            command_destroy(sub_commands[i]);
-        }
-    }
-    hi_free(sub_commands);
+    command_destroy(sub_command);
     return -1; // failing slot_num
 }
 
-static void *command_post_fragment(redisClusterContext *cc, struct cmd *command,
-                                   hilist *commands) {
+static void *command_post_fragment(redisClusterContext *cc,
+                                   struct cmd *command) {
     struct cmd *sub_command;
     listNode *list_node;
     redisReply *reply = NULL, *sub_reply;
+    struct keypos *kp;
     long long count = 0;
+    size_t j;
 
     listIter li;
-    listRewind(commands, &li);
+    listRewind(command->sub_commands, &li);
 
     while ((list_node = listNext(&li)) != NULL) {
         sub_command = list_node->value;
-        reply = sub_command->reply;
-        if (reply == NULL) {
+        sub_reply = sub_command->reply;
+        if (sub_reply == NULL) {
             return NULL;
-        } else if (reply->type == REDIS_REPLY_ERROR) {
-            return reply;
+        } else if (sub_reply->type == REDIS_REPLY_ERROR) {
+            /* Hand over the error reply to the caller */
+            sub_command->reply = NULL;
+            return sub_reply;
         }
 
         if (command->type == CMD_REQ_REDIS_MGET) {
-            if (reply->type != REDIS_REPLY_ARRAY) {
+            if (sub_reply->type != REDIS_REPLY_ARRAY ||
+                sub_reply->elements != hiarray_n(sub_command->keys)) {
                 __redisClusterSetError(cc, REDIS_ERR_OTHER, "reply type error");
                 return NULL;
             }
         } else if (command->type == CMD_REQ_REDIS_DEL) {
-            if (reply->type != REDIS_REPLY_INTEGER) {
+            if (sub_reply->type != REDIS_REPLY_INTEGER) {
                 __redisClusterSetError(cc, REDIS_ERR_OTHER, "reply type error");
                 return NULL;
             }
-            count += reply->integer;
+            count += sub_reply->integer;
         } else if (command->type == CMD_REQ_REDIS_EXISTS) {
-            if (reply->type != REDIS_REPLY_INTEGER) {
+            if (sub_reply->type != REDIS_REPLY_INTEGER) {
                 __redisClusterSetError(cc, REDIS_ERR_OTHER, "reply type error");
                 return NULL;
             }
-            count += reply->integer;
+            count += sub_reply->integer;
         } else if (command->type == CMD_REQ_REDIS_MSET) {
-            if (reply->type != REDIS_REPLY_STATUS || reply->len != 2 ||
-                strcmp(reply->str, REDIS_STATUS_OK) != 0) {
+            if (sub_reply->type != REDIS_REPLY_STATUS || sub_reply->len != 2 ||
+                strcmp(sub_reply->str, REDIS_STATUS_OK) != 0) {
                 __redisClusterSetError(cc, REDIS_ERR_OTHER, "reply type error");
                 return NULL;
             }
@@ -2770,67 +3975,45 @@ static void *command_post_fragment(redisClusterContext *cc, struct cmd *command,
         }
     }
 
+    if (command->type != CMD_REQ_REDIS_MGET) {
+        /* The first sub-reply already has the type and content we need,
+         * reuse it as the merged reply. */
+        sub_command = listFirst(command->sub_commands)->value;
+        reply = sub_command->reply;
+        sub_command->reply = NULL;
+
+        if (command->type == CMD_REQ_REDIS_DEL ||
+            command->type == CMD_REQ_REDIS_EXISTS) {
+            reply->integer = count;
+        }
+        return reply;
+    }
+
+    /* Allocate the resulting array once and move the elements of each
+     * sub-reply into the position of its key. No element is copied. */
     reply = hi_calloc(1, sizeof(*reply));
     if (reply == NULL) {
         goto oom;
     }
 
-    if (command->type == CMD_REQ_REDIS_MGET) {
-        int i;
-        uint32_t key_count;
-
-        reply->type = REDIS_REPLY_ARRAY;
-
-        key_count = hiarray_n(command->keys);
-
-        reply->elements = key_count;
-        reply->element = hi_calloc(key_count, sizeof(*reply->element));
-        if (reply->element == NULL) {
-            goto oom;
-        }
-
-        for (i = key_count - 1; i >= 0; i--) {       /* for each key */
-            sub_reply = command->frag_seq[i]->reply; /* get it's reply */
-            if (sub_reply == NULL) {
-                freeReplyObject(reply);
-                __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                                       "sub reply is null");
-                return NULL;
-            }
+    reply->type = REDIS_REPLY_ARRAY;
+    reply->elements = hiarray_n(command->keys);
+    reply->element = hi_calloc(reply->elements, sizeof(*reply->element));
+    if (reply->element == NULL) {
+        goto oom;
+    }
 
-            if (sub_reply->type == REDIS_REPLY_STRING) {
-                reply->element[i] = sub_reply;
-            } else if (sub_reply->type == REDIS_REPLY_ARRAY) {
-                if (sub_reply->elements == 0) {
-                    freeReplyObject(reply);
-                    __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                                           "sub reply elements error");
-                    return NULL;
-                }
+    listRewind(command->sub_commands, &li);
+    while ((list_node = listNext(&li)) != NULL) {
+        sub_command = list_node->value;
+        sub_reply = sub_command->reply;
 
-                reply->element[i] = sub_reply->element[sub_reply->elements - 1];
-                sub_reply->elements--;
-            }
-        }
-    } else if (command->type == CMD_REQ_REDIS_DEL) {
-        reply->type = REDIS_REPLY_INTEGER;
-        reply->integer = count;
-    } else if (command->type == CMD_REQ_REDIS_EXISTS) {
-        reply->type = REDIS_REPLY_INTEGER;
-        reply->integer = count;
-    } else if (command->type == CMD_REQ_REDIS_MSET) {
-        reply->type = REDIS_REPLY_STATUS;
-        uint32_t str_len = strlen(REDIS_STATUS_OK);
-        reply->str = hi_malloc((str_len + 1) * sizeof(char));
-        if (reply->str == NULL) {
-            goto oom;
+        for (j = 0; j < sub_reply->elements; j++) {
+            kp = hiarray_get(sub_command->keys, (uint32_t)j);
+            reply->element[kp->key_idx] = sub_reply->element[j];
         }
-
-        reply->len = str_len;
-        memcpy(reply->str, REDIS_STATUS_OK, str_len);
-        reply->str[str_len] = '\0';
-    } else {
-        NOT_REACHED();
+        /* The elements are now owned by the merged reply */
+        sub_reply->elements = 0;
     }
 
     return reply;
@@ -2841,6 +4024,44 @@ oom:
     return NULL;
 }
 
+/* Pass a reply to a streaming callback, see redisClusterCommandStream().
+ * A MGET reply is split per key while other replies are given as a whole.
+ * The reply is consumed in all cases. */
+static int command_stream_reply(redisClusterContext *cc, struct cmd *command,
+                                redisReply *reply, redisClusterKeyReplyFn *fn,
+                                void *privdata) {
+    struct keypos *kp;
+    redisReply *element;
+    size_t j;
+
+    if (reply->type == REDIS_REPLY_ERROR) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER, reply->str);
+        freeReplyObject(reply);
+        return REDIS_ERR;
+    }
+
+    if (command->type != CMD_REQ_REDIS_MGET) {
+        fn(cc, 0, reply, privdata);
+        return REDIS_OK;
+    }
+
+    if (reply->type != REDIS_REPLY_ARRAY ||
+        reply->elements != hiarray_n(command->keys)) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER, "reply type error");
+        freeReplyObject(reply);
+        return REDIS_ERR;
+    }
+
+    for (j = 0; j < reply->elements; j++) {
+        kp = hiarray_get(command->keys, (uint32_t)j);
+        element = reply->element[j];
+        reply->element[j] = NULL;
+        fn(cc, kp->key_idx, element, privdata);
+    }
+    freeReplyObject(reply);
+    return REDIS_OK;
+}
+
 /*
  * Split the command into subcommands by slot
  *
@@ -2849,14 +4070,14 @@ oom:
  * error; Otherwise if  the commands > 1 , slot_num is the last subcommand slot
  * number.
  */
-static int command_format_by_slot(redisClusterContext *cc, struct cmd *command,
-                                  hilist *commands) {
+static int command_format_by_slot(redisClusterContext *cc,
+                                  struct cmd *command) {
     struct keypos *kp;
     int key_count;
     int slot_num = -1;
 
-    if (cc == NULL || commands == NULL || command == NULL ||
-        command->cmd == NULL || command->clen <= 0) {
+    if (cc == NULL || command == NULL || command->cmd == NULL ||
+        command->clen <= 0) {
         goto done;
     }
 
@@ -2884,7 +4105,7 @@ static int command_format_by_slot(redisClusterContext *cc, struct cmd *command,
         goto done;
     }
 
-    slot_num = command_pre_fragment(cc, command, commands);
+    slot_num = command_pre_fragment(cc, command);
 
 done:
 
@@ -2922,12 +4143,15 @@ int redisClusterSetEventCallback(redisClusterContext *cc,
     return REDIS_ERR;
 }
 
-void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
-                                   int len) {
+/* Execute a formatted command and return its reply. When a streaming callback
+ * is given the reply is passed to it instead and NULL is returned. */
+static redisReply *cluster_formatted_command(redisClusterContext *cc, char *cmd,
+                                             int len,
+                                             redisClusterKeyReplyFn *fn,
+                                             void *privdata) {
     redisReply *reply = NULL;
     int slot_num;
     struct cmd *command = NULL, *sub_command;
-    hilist *commands = NULL;
     listNode *list_node;
 
     if (cc == NULL) {
@@ -2939,7 +4163,7 @@ void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
         memset(cc->errstr, '\0', strlen(cc->errstr));
     }
 
-    command = command_get();
+    command = cluster_command_get(cc);
     if (command == NULL) {
         goto oom;
     }
@@ -2947,14 +4171,7 @@ void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
     command->cmd = cmd;
     command->clen = len;
 
-    commands = listCreate();
-    if (commands == NULL) {
-        goto oom;
-    }
-
-    commands->free = listCommandFree;
-
-    slot_num = command_format_by_slot(cc, command, commands);
+    slot_num = command_format_by_slot(cc, command);
 
     if (slot_num < 0) {
         goto error;
@@ -2964,15 +4181,15 @@ void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
     }
 
     // all keys belong to one slot
-    if (listLength(commands) == 0) {
+    if (command->sub_commands == NULL) {
         reply = redis_cluster_command_execute(cc, command);
         goto done;
     }
 
-    ASSERT(listLength(commands) != 1);
+    ASSERT(listLength(command->sub_commands) > 1);
 
     listIter li;
-    listRewind(commands, &li);
+    listRewind(command->sub_commands, &li);
 
     while ((list_node = listNext(&li)) != NULL) {
         sub_command = list_node->value;
@@ -2980,6 +4197,13 @@ void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
         reply = redis_cluster_command_execute(cc, sub_command);
         if (reply == NULL) {
             goto error;
+        } else if (fn != NULL && command->type == CMD_REQ_REDIS_MGET) {
+            /* Stream the keys of this node without waiting for the others */
+            if (command_stream_reply(cc, sub_command, reply, fn, privdata) !=
+                REDIS_OK) {
+                goto error;
+            }
+            continue;
         } else if (reply->type == REDIS_REPLY_ERROR) {
             goto done;
         }
@@ -2987,16 +4211,21 @@ void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
         sub_command->reply = reply;
     }
 
-    reply = command_post_fragment(cc, command, commands);
+    if (fn != NULL && command->type == CMD_REQ_REDIS_MGET) {
+        reply = NULL;
+        goto done;
+    }
+
+    reply = command_post_fragment(cc, command);
 
 done:
+    if (fn != NULL && reply != NULL) {
+        command_stream_reply(cc, command, reply, fn, privdata);
+        reply = NULL;
+    }
 
     command->cmd = NULL;
-    command_destroy(command);
-
-    if (commands != NULL) {
-        listRelease(commands);
-    }
+    cluster_command_release(cc, command);
 
     cc->retry_count = 0;
     return reply;
@@ -3008,15 +4237,34 @@ oom:
 error:
     if (command != NULL) {
         command->cmd = NULL;
-        command_destroy(command);
-    }
-    if (commands != NULL) {
-        listRelease(commands);
+        cluster_command_release(cc, command);
     }
     cc->retry_count = 0;
     return NULL;
 }
 
+void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd,
+                                   int len) {
+    return cluster_formatted_command(cc, cmd, len, NULL, NULL);
+}
+
+int redisClusterFormattedCommandStream(redisClusterContext *cc,
+                                       redisClusterKeyReplyFn *fn,
+                                       void *privdata, char *cmd, int len) {
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    if (fn == NULL) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER, "No callback given");
+        return REDIS_ERR;
+    }
+
+    cluster_formatted_command(cc, cmd, len, fn, privdata);
+
+    return cc->err ? REDIS_ERR : REDIS_OK;
+}
+
 void *redisClustervCommand(redisClusterContext *cc, const char *format,
                            va_list ap) {
     redisReply *reply;
@@ -3055,6 +4303,47 @@ void *redisClusterCommand(redisClusterContext *cc, const char *format, ...) {
     return reply;
 }
 
+int redisClustervCommandStream(redisClusterContext *cc,
+                               redisClusterKeyReplyFn *fn, void *privdata,
+                               const char *format, va_list ap) {
+    char *cmd;
+    int len;
+    int ret;
+
+    if (cc == NULL) {
+        return REDIS_ERR;
+    }
+
+    len = redisvFormatCommand(&cmd, format, ap);
+
+    if (len == -1) {
+        __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+        return REDIS_ERR;
+    } else if (len == -2) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER, "Invalid format string");
+        return REDIS_ERR;
+    }
+
+    ret = redisClusterFormattedCommandStream(cc, fn, privdata, cmd, len);
+
+    hi_free(cmd);
+
+    return ret;
+}
+
+int redisClusterCommandStream(redisClusterContext *cc,
+                              redisClusterKeyReplyFn *fn, void *privdata,
+                              const char *format, ...) {
+    va_list ap;
+    int ret;
+
+    va_start(ap, format);
+    ret = redisClustervCommandStream(cc, fn, privdata, format, ap);
+    va_end(ap);
+
+    return ret;
+}
+
 void *redisClustervCommandToNode(redisClusterContext *cc,
                                  redisClusterNode *node, const char *format,
                                  va_list ap) {
@@ -3142,9 +4431,8 @@ void *redisClusterCommandArgv(redisClusterContext *cc, int argc,
 
 int redisClusterAppendFormattedCommand(redisClusterContext *cc, char *cmd,
                                        int len) {
-    int slot_num;
+    int slot_num, appended = 0;
     struct cmd *command = NULL, *sub_command;
-    hilist *commands = NULL;
     listNode *list_node;
 
     if (cc->requests == NULL) {
@@ -3163,14 +4451,7 @@ int redisClusterAppendFormattedCommand(redisClusterContext *cc, char *cmd,
     command->cmd = cmd;
     command->clen = len;
 
-    commands = listCreate();
-    if (commands == NULL) {
-        goto oom;
-    }
-
-    commands->free = listCommandFree;
-
-    slot_num = command_format_by_slot(cc, command, commands);
+    slot_num = command_format_by_slot(cc, command);
 
     if (slot_num < 0) {
         goto error;
@@ -3179,57 +4460,65 @@ int redisClusterAppendFormattedCommand(redisClusterContext *cc, char *cmd,
         goto error;
     }
 
+    /* Keep a copy of the command to re-send it when redirected. The parts of
+     * a multi-key command are kept by the command itself. */
+    if (command->sub_commands == NULL && cc->max_retry_count > 0) {
+        command->cmd = hi_malloc(len);
+        if (command->cmd == NULL) {
+            goto oom;
+        }
+        memcpy(command->cmd, cmd, len);
+    }
+
+    if (listAddNodeTail(cc->requests, command) == NULL) {
+        goto oom;
+    }
+
     // Append command(s)
-    if (listLength(commands) == 0) {
+    if (command->sub_commands == NULL) {
         // All keys belong to one slot
         if (__redisClusterAppendCommand(cc, command) != REDIS_OK) {
-            goto error;
+            goto unsent;
         }
     } else {
         // Keys belongs to different slots
-        ASSERT(listLength(commands) != 1);
+        ASSERT(listLength(command->sub_commands) > 1);
 
         listIter li;
-        listRewind(commands, &li);
+        listRewind(command->sub_commands, &li);
 
         while ((list_node = listNext(&li)) != NULL) {
             sub_command = list_node->value;
 
             if (__redisClusterAppendCommand(cc, sub_command) != REDIS_OK) {
-                goto error;
+                goto unsent;
             }
+            appended++;
         }
     }
 
-    if (listLength(commands) > 0) {
-        command->sub_commands = commands;
-    } else {
-        listRelease(commands);
-    }
-    commands = NULL;
-    command->cmd = NULL;
-
-    if (listAddNodeTail(cc->requests, command) == NULL) {
-        goto oom;
-    }
+    if (command->cmd == cmd)
+        command->cmd = NULL;
+    cluster_pipeline_add(cc, command);
     return REDIS_OK;
 
+unsent:
+    cluster_pipeline_unsend(cc, command, appended);
+    if (command->cmd == cmd)
+        command->cmd = NULL;
+    listDelNode(cc->requests, listLast(cc->requests));
+    return REDIS_ERR;
+
 oom:
     __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
     // passthrough
 
 error:
     if (command != NULL) {
-        command->cmd = NULL;
+        if (command->cmd == cmd)
+            command->cmd = NULL;
         command_destroy(command);
     }
-    if (commands != NULL) {
-        listRelease(commands);
-    }
-
-    /* Attention: mybe here we must pop the
-      sub_commands that had append to the nodes.
-      But now we do not handle it. */
     return REDIS_ERR;
 }
 
@@ -3276,6 +4565,7 @@ int redisClustervAppendCommandToNode(redisClusterContext *cc,
                                      va_list ap) {
     redisContext *c;
     struct cmd *command = NULL;
+    dictEntry *de;
     char *cmd = NULL;
     int len;
 
@@ -3304,13 +4594,6 @@ int redisClustervAppendCommandToNode(redisClusterContext *cc,
         return REDIS_ERR;
     }
 
-    // Append the command to the outgoing hiredis buffer
-    if (redisAppendFormattedCommand(c, cmd, len) != REDIS_OK) {
-        __redisClusterSetError(cc, c->err, c->errstr);
-        hi_free(cmd);
-        return REDIS_ERR;
-    }
-
     // Keep the command in the outstanding request list
     command = command_get();
     if (command == NULL) {
@@ -3326,6 +4609,18 @@ int redisClustervAppendCommandToNode(redisClusterContext *cc,
     if (listAddNodeTail(cc->requests, command) == NULL)
         goto oom;
 
+    // Append the command to the outgoing hiredis buffer
+    if (redisAppendFormattedCommand(c, cmd, len) != REDIS_OK) {
+        __redisClusterSetError(cc, c->err, c->errstr);
+        listDelNode(cc->requests, listLast(cc->requests));
+        return REDIS_ERR;
+    }
+
+    command->pipeline_index = cc->pipeline_appended++;
+    de = dictFind(cc->nodes, node->addr);
+    if (de != NULL)
+        cluster_pipeline_push(dictGetEntryVal(de), command);
+
     return REDIS_OK;
 
 oom:
@@ -3370,87 +4665,333 @@ int redisClusterAppendCommandArgv(redisClusterContext *cc, int argc,
     return ret;
 }
 
-static int redisClusterSendAll(redisClusterContext *cc) {
-    dictEntry *de;
+/* Re-sends a pipelined command which got a MOVED or ASK reply to the node
+ * given in the redirect, where it waits for a new reply. Returns 1 when the
+ * command is re-sent, 0 when the reply is for the caller, or -1 on error. */
+static int cluster_pipeline_redirect(redisClusterContext *cc,
+                                     struct cmd *command, redisReply *reply) {
     redisClusterNode *node;
-    redisContext *c = NULL;
-    int wdone = 0;
+    redisContext *c;
+    int error_type, slot = -1;
 
-    if (cc == NULL || cc->nodes == NULL) {
-        return REDIS_ERR;
+    error_type = cluster_reply_error_type(reply);
+    if (error_type != CLUSTER_ERR_MOVED && error_type != CLUSTER_ERR_ASK)
+        return 0;
+    if (command->cmd == NULL || command->node_addr != NULL ||
+        command->redirects >= cc->max_retry_count)
+        return 0; /* Not redirected, like commands sent to a given node */
+
+    node = getNodeFromRedirectReply(cc, reply, &slot);
+    if (node == NULL) {
+        goto error; /* Specific error already set */
+    }
+    if (error_type == CLUSTER_ERR_MOVED) {
+        /* Update the slot mapping entry now and the slotmap on reset */
+        if (cc->table != NULL && slot >= 0 && slot < REDIS_CLUSTER_SLOTS)
+            cc->table[slot] = node;
+        cc->need_update_route = 1;
     }
 
-    dictIterator di;
-    dictInitIterator(&di, cc->nodes);
+    c = ctx_get_by_node(cc, node);
+    if (c == NULL) {
+        goto error;
+    } else if (c->err) {
+        __redisClusterSetError(cc, c->err, c->errstr);
+        goto error;
+    }
 
-    while ((de = dictNext(&di)) != NULL) {
-        node = dictGetEntryVal(de);
-        if (node == NULL) {
-            continue;
+    /* Re-sent commands are written together with the next flush */
+    if (error_type == CLUSTER_ERR_ASK) {
+        if (redisAppendCommand(c, REDIS_COMMAND_ASKING) != REDIS_OK) {
+            __redisClusterSetError(cc, c->err, c->errstr);
+            goto error;
         }
-
-        c = ctx_get_by_node(cc, node);
-        if (c == NULL) {
-            continue;
+        command->asking = 1;
+    }
+    if (redisAppendFormattedCommand(c, command->cmd, command->clen) !=
+        REDIS_OK) {
+        __redisClusterSetError(cc, c->err, c->errstr);
+        if (command->asking) {
+            /* The reply to ASKING would be taken for another reply */
+            command->asking = 0;
+            cluster_pipeline_drop(node);
         }
-
-        /* Write until done */
-        do {
-            if (redisBufferWrite(c, &wdone) == REDIS_ERR) {
-                return REDIS_ERR;
-            }
-        } while (!wdone);
+        goto error;
     }
+    command->redirects++;
+    cluster_pipeline_push(node, command);
 
-    return REDIS_OK;
-}
+    freeReplyObject(reply);
+    return 1;
 
-static int redisClusterClearAll(redisClusterContext *cc) {
-    dictEntry *de;
-    redisClusterNode *node;
-    redisContext *c = NULL;
+error:
+    freeReplyObject(reply);
+    return -1;
+}
 
-    if (cc == NULL) {
-        return REDIS_ERR;
+/* Hands a reply read from a node to the first command waiting on the node.
+ * Returns 1 when this completes a pipelined command, which is returned by
+ * pointer with its reply, 2 when the command was redirected, 0 when more
+ * replies are needed, or -1 on error. */
+static int cluster_pipeline_complete(redisClusterContext *cc,
+                                     redisClusterNode *node, void *r,
+                                     struct cmd **completed) {
+    struct cmd *command;
+    int ret;
+
+    command = node->pipeline_head;
+    if (command == NULL) {
+        freeReplyObject(r);
+        __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                               "reply received for no command");
+        return -1;
+    }
+    if (command->asking) {
+        /* Reply to the ASKING preceding a redirected command */
+        command->asking = 0;
+        freeReplyObject(r);
+        return 0;
     }
+    cluster_pipeline_pop(node);
 
-    if (cc->err) {
-        cc->err = 0;
-        memset(cc->errstr, '\0', strlen(cc->errstr));
+    ret = cluster_pipeline_redirect(cc, command, r);
+    if (ret != 0)
+        return ret > 0 ? 2 : -1;
+
+    if (cluster_reply_error_type(r) == CLUSTER_ERR_MOVED)
+        cc->need_update_route = 1;
+
+    command->reply = r;
+    if (command->parent != NULL) {
+        command = command->parent;
+        if (--command->pipeline_pending > 0)
+            return 0; /* Wait for the remaining parts */
+        command->reply = command_post_fragment(cc, command);
+        if (command->reply == NULL)
+            return -1;
     }
 
-    if (cc->nodes == NULL) {
+    *completed = command;
+    return 1;
+}
+
+/* Returns the node which a pipelined command waits for a reply from. The
+ * sub-commands before `pipeline_part` already have their replies, so they are
+ * not scanned again for every reply. */
+static redisClusterNode *cluster_pipeline_node(struct cmd *command) {
+    struct cmd *sub_command;
+
+    if (command->sub_commands == NULL)
+        return command->pipeline_node;
+
+    while (command->pipeline_part != NULL) {
+        sub_command = command->pipeline_part->value;
+        if (sub_command->reply == NULL)
+            return sub_command->pipeline_node;
+        command->pipeline_part = listNextNode(command->pipeline_part);
+    }
+    return NULL;
+}
+
+/* Abandons a pipelined command after an error. Its replies, when still
+ * expected, can't be told apart from the replies of following commands, so
+ * the connections it waits on are closed. */
+static void cluster_pipeline_abandon(struct cmd *command) {
+    struct cmd *sub_command;
+    listNode *list_node;
+    listIter li;
+
+    if (command->pipeline_node != NULL)
+        cluster_pipeline_drop(command->pipeline_node);
+    if (command->sub_commands != NULL) {
+        listRewind(command->sub_commands, &li);
+        while ((list_node = listNext(&li)) != NULL) {
+            sub_command = list_node->value;
+            if (sub_command->pipeline_node != NULL)
+                cluster_pipeline_drop(sub_command->pipeline_node);
+        }
+    }
+}
+
+int redisClusterGetReply(redisClusterContext *cc, void **reply) {
+
+    struct cmd *command, *completed;
+    listNode *list_command;
+    redisClusterNode *node;
+    void *r;
+    int ret;
+
+    if (cc == NULL || reply == NULL)
         return REDIS_ERR;
+
+    cc->err = 0;
+    cc->errstr[0] = '\0';
+
+    *reply = NULL;
+
+    if (cc->requests == NULL)
+        return REDIS_ERR; // No queued requests
+
+    /* Skip commands already replied by redisClusterGetAnyReply() */
+    while ((list_command = listFirst(cc->requests)) != NULL &&
+           ((struct cmd *)list_command->value)->replied) {
+        listDelNode(cc->requests, list_command);
+    }
+
+    // no more reply
+    if (list_command == NULL) {
+        *reply = NULL;
+        return REDIS_OK;
+    }
+
+    command = list_command->value;
+    if (command->reply != NULL) {
+        cc->pipeline_unclaimed--; /* Received while waiting for others */
+    }
+
+    /* Read from the node of the command until it is completed. Replies to
+     * other commands are kept, e.g. when a redirect has re-sent this command
+     * after them. */
+    while (command->reply == NULL) {
+        node = cluster_pipeline_node(command);
+        if (node == NULL) {
+            __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                                   "command was sent to a now unknown node");
+            goto error;
+        }
+        if (__redisClusterGetReplyFromNode(cc, node, &r) != REDIS_OK) {
+            goto error;
+        }
+        ret = cluster_pipeline_complete(cc, node, r, &completed);
+        if (ret < 0) {
+            goto error;
+        } else if (ret == 1 && completed != command) {
+            cc->pipeline_unclaimed++;
+        }
     }
 
+    *reply = command->reply;
+    command->reply = NULL;
+    listDelNode(cc->requests, list_command);
+    return REDIS_OK;
+
+error:
+    cluster_pipeline_abandon(command);
+    listDelNode(cc->requests, list_command);
+    return REDIS_ERR;
+}
+
+/* Reads the replies already received from the nodes, until a pipelined
+ * command is completed. Returns 1 when a command is completed, 0 when more
+ * data is needed or -1 on error. */
+static int cluster_pipeline_read(redisClusterContext *cc,
+                                 struct cmd **completed) {
+    redisClusterNode *node;
+    dictEntry *de;
     dictIterator di;
+    void *r;
+    int ret;
+
+restart:
     dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        while (node->pipeline_head != NULL && node->con != NULL) {
+            if (redisGetReplyFromReader(node->con, &r) != REDIS_OK) {
+                __redisClusterSetError(cc, node->con->err,
+                                       node->con->errstr);
+                return -1;
+            }
+            if (r == NULL)
+                break;
+            ret = cluster_pipeline_complete(cc, node, r, completed);
+            if (ret == 2)
+                goto restart; /* A redirect may have added a node */
+            if (ret != 0)
+                return ret;
+        }
+    }
+    return 0;
+}
+
+/* Flushes the output buffers and waits until any node with outstanding
+ * replies has sent more data, which is read into its reader. */
+static int cluster_pipeline_wait(redisClusterContext *cc) {
+    redisClusterNode *node, **nodes;
+    struct pollfd *fds;
+    redisContext *c;
+    dictEntry *de;
+    dictIterator di;
+    int n = 0, i, rc, timeout = -1;
+
+    if (cluster_pipeline_flush(cc) != REDIS_OK)
+        return REDIS_ERR;
 
+    nodes = cluster_pollset(cc, &fds);
+    if (nodes == NULL)
+        return REDIS_ERR;
+
+    dictInitIterator(&di, cc->nodes);
     while ((de = dictNext(&di)) != NULL) {
         node = dictGetEntryVal(de);
-        if (node == NULL) {
+        if (node->pipeline_head == NULL)
             continue;
-        }
 
         c = node->con;
         if (c == NULL) {
-            continue;
+            __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                                   "connection lost with pending replies");
+            return REDIS_ERR;
         }
 
-        redisFree(c);
-        node->con = NULL;
+        nodes[n] = node;
+        fds[n].fd = c->fd;
+        fds[n].events = POLLIN;
+        fds[n].revents = 0;
+        n++;
+    }
+    if (n == 0) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                               "no node to receive the replies from");
+        return REDIS_ERR;
+    }
+
+    if (cc->command_timeout != NULL) {
+        timeout = (int)(cc->command_timeout->tv_sec * 1000 +
+                        cc->command_timeout->tv_usec / 1000);
+    }
+    do {
+        rc = poll(fds, n, timeout);
+    } while (rc < 0 && errno == EINTR);
+
+    if (rc < 0) {
+        __redisClusterSetError(cc, REDIS_ERR_IO, NULL);
+        return REDIS_ERR;
+    } else if (rc == 0) {
+        __redisClusterSetError(cc, REDIS_ERR_TIMEOUT,
+                               "Timeout waiting for replies");
+        return REDIS_ERR;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (fds[i].revents == 0)
+            continue;
+        c = nodes[i]->con;
+        if (redisBufferRead(c) != REDIS_OK) {
+            __redisClusterSetError(cc, c->err, c->errstr);
+            return REDIS_ERR;
+        }
     }
 
     return REDIS_OK;
 }
 
-int redisClusterGetReply(redisClusterContext *cc, void **reply) {
-
-    struct cmd *command, *sub_command;
-    hilist *commands = NULL;
-    listNode *list_command, *list_sub_command;
-    int slot_num;
-    void *sub_reply;
+int redisClusterGetAnyReply(redisClusterContext *cc, void **reply,
+                            long long *index) {
+    struct cmd *command = NULL;
+    listNode *list_command;
+    listIter li;
+    int ret;
 
     if (cc == NULL || reply == NULL)
         return REDIS_ERR;
@@ -3463,125 +5004,306 @@ int redisClusterGetReply(redisClusterContext *cc, void **reply) {
     if (cc->requests == NULL)
         return REDIS_ERR; // No queued requests
 
-    list_command = listFirst(cc->requests);
+    /* Forget the commands at the front which are already replied */
+    while ((list_command = listFirst(cc->requests)) != NULL &&
+           ((struct cmd *)list_command->value)->replied) {
+        listDelNode(cc->requests, list_command);
+    }
 
     // no more reply
-    if (list_command == NULL) {
-        *reply = NULL;
+    if (list_command == NULL)
         return REDIS_OK;
-    }
 
-    command = list_command->value;
-    if (command == NULL) {
-        __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                               "command in the requests list is null");
-        goto error;
+    if (cc->pipeline_unclaimed > 0) {
+        /* Replies kept by redisClusterGetReply() are returned first */
+        listRewind(cc->requests, &li);
+        while ((list_command = listNext(&li)) != NULL) {
+            command = list_command->value;
+            if (!command->replied && command->reply != NULL)
+                break;
+        }
+        if (list_command == NULL) {
+            /* The count of kept replies is out of sync */
+            __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                                   "pipelined reply not found");
+            return REDIS_ERR;
+        }
+        cc->pipeline_unclaimed--;
+    } else {
+        while ((ret = cluster_pipeline_read(cc, &command)) == 0) {
+            if (cluster_pipeline_wait(cc) != REDIS_OK)
+                return REDIS_ERR;
+        }
+        if (ret < 0)
+            return REDIS_ERR;
     }
 
-    slot_num = command->slot_num;
-    if (slot_num >= 0) {
-        /* Command was sent via single slot */
-        listDelNode(cc->requests, list_command);
-        return __redisClusterGetReply(cc, slot_num, reply);
+    command->replied = 1;
+    *reply = command->reply;
+    command->reply = NULL;
+    if (index != NULL)
+        *index = command->pipeline_index;
+    return REDIS_OK;
+}
 
-    } else if (command->node_addr) {
-        /* Command was sent to a single node */
-        dictEntry *de;
+/* Reads and discards the replies of a pipeline from all nodes concurrently.
+ * Connections which fail, or don't deliver their replies in time, are closed
+ * while the others are kept. */
+static void cluster_pipeline_drain(redisClusterContext *cc) {
+    redisClusterNode *node, **nodes;
+    struct pollfd *fds;
+    redisContext *c;
+    dictEntry *de;
+    dictIterator di;
+    int64_t deadline, timeout;
+    int n, i, rc, wdone;
+    void *r;
+
+    timeout = PIPELINE_DRAIN_TIMEOUT_USEC;
+    if (cc->command_timeout != NULL) {
+        timeout = cc->command_timeout->tv_sec * 1000000 +
+                  cc->command_timeout->tv_usec;
+    }
+    deadline = hi_usec_now() + timeout;
+    nodes = cluster_pollset(cc, &fds);
+
+    for (;;) {
+        n = 0;
+        dictInitIterator(&di, cc->nodes);
+        while ((de = dictNext(&di)) != NULL) {
+            node = dictGetEntryVal(de);
+            c = node->con;
+            while (c != NULL && node->pipeline_head != NULL) {
+                if (redisGetReplyFromReader(c, &r) != REDIS_OK) {
+                    c = NULL;
+                    break;
+                }
+                if (r == NULL)
+                    break;
+                if (cluster_reply_error_type(r) == CLUSTER_ERR_MOVED)
+                    cc->need_update_route = 1;
+                freeReplyObject(r);
+
+                if (node->pipeline_head->asking)
+                    node->pipeline_head->asking = 0;
+                else
+                    cluster_pipeline_pop(node);
+            }
+            if (node->pipeline_head == NULL)
+                continue;
+            if (c == NULL || c->err || nodes == NULL ||
+                cluster_set_blocking(c, 0) != REDIS_OK) {
+                cluster_pipeline_drop(node);
+                continue;
+            }
+            nodes[n] = node;
+            fds[n].fd = c->fd;
+            fds[n].events = POLLIN;
+            if (sdslen(c->obuf) > 0)
+                fds[n].events |= POLLOUT;
+            fds[n].revents = 0;
+            n++;
+        }
+        if (n == 0)
+            break;
 
-        de = dictFind(cc->nodes, command->node_addr);
-        if (de != NULL) {
-            listDelNode(cc->requests, list_command);
-            return __redisClusterGetReplyFromNode(cc, dictGetEntryVal(de),
-                                                  reply);
-        } else {
-            __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                                   "command was sent to a now unknown node");
-            goto error;
+        timeout = deadline - hi_usec_now();
+        rc = 0;
+        if (timeout > 0) {
+            do {
+                rc = poll(fds, n, (int)((timeout + 999) / 1000));
+            } while (rc < 0 && errno == EINTR);
+        }
+        for (i = 0; i < n; i++) {
+            c = nodes[i]->con;
+            if (rc <= 0 ||
+                ((fds[i].revents & POLLOUT) &&
+                 redisBufferWrite(c, &wdone) != REDIS_OK) ||
+                ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                 redisBufferRead(c) != REDIS_OK)) {
+                /* Timed out or failed */
+                cluster_pipeline_drop(nodes[i]);
+                continue;
+            }
+            cluster_set_blocking(c, 1);
         }
     }
+}
 
-    commands = command->sub_commands;
-    if (commands == NULL) {
-        __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                               "sub_commands in command is null");
+/* Plans a command of a batch: formats it and finds the slots of its keys. */
+static struct cmd *cluster_batch_command(redisClusterContext *cc, int argc,
+                                         const char **argv,
+                                         const size_t *argvlen) {
+    struct cmd *command;
+    int slot_num, len;
+
+    command = cluster_command_get(cc);
+    if (command == NULL) {
+        __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+        return NULL;
+    }
+
+    /* The command owns the formatted command, for re-sending it */
+    len = redisFormatCommandArgv(&command->cmd, argc, argv, argvlen);
+    if (len == -1) {
+        command->cmd = NULL;
+        __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+        goto error;
+    }
+    command->clen = len;
+
+    slot_num = command_format_by_slot(cc, command);
+    if (slot_num < 0) {
+        goto error;
+    } else if (slot_num >= REDIS_CLUSTER_SLOTS) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER, "slot_num is out of range");
         goto error;
     }
+    return command;
 
-    ASSERT(listLength(commands) != 1);
+error:
+    cluster_command_release(cc, command);
+    return NULL;
+}
 
+int redisClusterExecBatch(redisClusterContext *cc, int n, const int *argcs,
+                          const char **argvs[], const size_t *argvlens[],
+                          redisReply **replies) {
+    struct cmd **commands, *command;
+    listNode *list_node;
     listIter li;
-    listRewind(commands, &li);
+    int i, ret, appended, received = 0, sent = 0;
 
-    while ((list_sub_command = listNext(&li)) != NULL) {
-        sub_command = list_sub_command->value;
-        if (sub_command == NULL) {
-            __redisClusterSetError(cc, REDIS_ERR_OTHER, "sub_command is null");
+    if (cc == NULL || n < 0 || argcs == NULL || argvs == NULL ||
+        replies == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->err = 0;
+    cc->errstr[0] = '\0';
+
+    if (cc->requests != NULL && listLength(cc->requests) > 0) {
+        __redisClusterSetError(cc, REDIS_ERR_OTHER,
+                               "batch not allowed during a pipeline");
+        return REDIS_ERR;
+    }
+    for (i = 0; i < n; i++) {
+        replies[i] = NULL;
+    }
+    if (n == 0) {
+        return REDIS_OK;
+    }
+
+    commands = hi_calloc(n, sizeof(*commands));
+    if (commands == NULL) {
+        __redisClusterSetError(cc, REDIS_ERR_OOM, "Out of memory");
+        return REDIS_ERR;
+    }
+
+    /* Plan all commands before sending anything */
+    for (i = 0; i < n; i++) {
+        commands[i] = cluster_batch_command(
+            cc, argcs[i], argvs[i], argvlens ? argvlens[i] : NULL);
+        if (commands[i] == NULL) {
             goto error;
         }
+    }
 
-        slot_num = sub_command->slot_num;
-        if (slot_num < 0) {
-            __redisClusterSetError(cc, REDIS_ERR_OTHER,
-                                   "sub_command slot_num is less then zero");
-            goto error;
+    /* Queue the commands per node and send them in one flush */
+    cc->pipeline_appended = 0;
+    sent = 1;
+    for (i = 0; i < n; i++) {
+        command = commands[i];
+        if (command->sub_commands == NULL) {
+            if (__redisClusterAppendCommand(cc, command) != REDIS_OK)
+                goto error;
+        } else {
+            appended = 0;
+            listRewind(command->sub_commands, &li);
+            while ((list_node = listNext(&li)) != NULL) {
+                if (__redisClusterAppendCommand(cc, list_node->value) !=
+                    REDIS_OK) {
+                    cluster_pipeline_unsend(cc, command, appended);
+                    goto error;
+                }
+                appended++;
+            }
         }
+        cluster_pipeline_add(cc, command);
+    }
 
-        if (__redisClusterGetReply(cc, slot_num, &sub_reply) != REDIS_OK) {
+    /* Collect the replies as they arrive, following redirects */
+    while (received < n) {
+        ret = cluster_pipeline_read(cc, &command);
+        if (ret < 0) {
             goto error;
+        } else if (ret == 0) {
+            if (cluster_pipeline_wait(cc) != REDIS_OK)
+                goto error;
+            continue;
         }
-
-        sub_command->reply = sub_reply;
+        replies[command->pipeline_index] = command->reply;
+        command->reply = NULL;
+        received++;
     }
 
-    *reply = command_post_fragment(cc, command, commands);
-    if (*reply == NULL) {
-        goto error;
+    cluster_pipeline_clear(cc);
+    for (i = 0; i < n; i++) {
+        cluster_command_release(cc, commands[i]);
     }
+    hi_free(commands);
 
-    listDelNode(cc->requests, list_command);
+    if (cc->need_update_route) {
+        if (redisClusterUpdateSlotmap(cc) == REDIS_OK) {
+            cc->need_update_route = 0;
+        } else {
+            /* Replies are kept, and the update is made on the next reset */
+            cc->err = 0;
+            cc->errstr[0] = '\0';
+        }
+    }
     return REDIS_OK;
 
 error:
-
-    listDelNode(cc->requests, list_command);
+    /* Replies not read are discarded, before the commands are released */
+    if (sent) {
+        char errstr[sizeof(cc->errstr)];
+        ret = cc->err;
+        memcpy(errstr, cc->errstr, sizeof(errstr));
+        cluster_pipeline_drain(cc);
+        cc->err = ret;
+        memcpy(cc->errstr, errstr, sizeof(errstr));
+    }
+    cluster_pipeline_clear(cc);
+    for (i = 0; i < n; i++) {
+        freeReplyObject(replies[i]);
+        replies[i] = NULL;
+        if (commands[i] != NULL)
+            cluster_command_release(cc, commands[i]);
+    }
+    hi_free(commands);
     return REDIS_ERR;
 }
 
-/**
- * Resets cluster state after pipeline. 
- * Resets Redis node connections if pipeline commands were not called beforehand.
- */
+/* Resets the context after pipelining. The replies not read are discarded,
+ * and connections are only closed when they fail to deliver them. */
 void redisClusterReset(redisClusterContext *cc) {
     int status;
-    void *reply;
 
     if (cc == NULL || cc->nodes == NULL) {
         return;
     }
 
-    if (cc->err) {
-        redisClusterClearAll(cc);
-    } else {
-        /* Write/flush each nodes output buffer to socket */
-        redisClusterSendAll(cc);
-
-        /* Expect a reply for each pipelined request */
-        do {
-            status = redisClusterGetReply(cc, &reply);
-            if (status == REDIS_OK) {
-                freeReplyObject(reply);
-            } else {
-                redisClusterClearAll(cc);
-                break;
-            }
-        } while (reply != NULL);
-    }
-
+    cluster_pipeline_drain(cc);
+    cluster_pipeline_clear(cc);
     if (cc->requests) {
         listRelease(cc->requests);
         cc->requests = NULL;
     }
 
+    cc->err = 0;
+    cc->errstr[0] = '\0';
+
     if (cc->need_update_route) {
         status = redisClusterUpdateSlotmap(cc);
         if (status != REDIS_OK) {
@@ -3625,6 +5347,7 @@ redisClusterAsyncInitialize(redisClusterContext *cc) {
         return NULL;
 
     acc->cc = cc;
+    cc->flags |= HIRCLUSTER_FLAG_ASYNC;
 
     /* We want the error field to be accessible directly instead of requiring
      * an indirection to the redisContext struct. */
@@ -3635,19 +5358,63 @@ redisClusterAsyncInitialize(redisClusterContext *cc) {
     return acc;
 }
 
-static cluster_async_data *cluster_async_data_create(void) {
-    /* use calloc to guarantee all fields are zeroed */
-    return hi_calloc(1, sizeof(cluster_async_data));
-}
+static cluster_async_data *
+cluster_async_data_create(redisClusterAsyncContext *acc) {
+    cluster_async_data *cad = acc->data_pool;
 
-static void cluster_async_data_free(cluster_async_data *cad) {
     if (cad == NULL) {
-        return;
+        /* use calloc to guarantee all fields are zeroed */
+        cad = hi_calloc(1, sizeof(cluster_async_data));
+        if (cad == NULL) {
+            return NULL;
+        }
+    } else {
+        acc->data_pool = cad->next_free;
+        acc->data_pool_n--;
+        memset(cad, 0, sizeof(*cad));
     }
+    cad->acc = acc;
+    return cad;
+}
 
-    command_destroy(cad->command);
+/* Remove a command from the timer wheel of deadlines. */
+static void cluster_async_deadline_unlink(cluster_async_data *cad) {
+    struct cluster_async_wheel *wheel = cad->acc->deadlines;
 
-    hi_free(cad);
+    if (cad->prev_deadline != NULL) {
+        cad->prev_deadline->next_deadline = cad->next_deadline;
+    } else {
+        wheel->slots[DEADLINE_WHEEL_SLOT(cad->deadline)] = cad->next_deadline;
+    }
+    if (cad->next_deadline != NULL) {
+        cad->next_deadline->prev_deadline = cad->prev_deadline;
+    }
+    cad->prev_deadline = cad->next_deadline = NULL;
+    cad->deadline = 0;
+    wheel->count--;
+}
+
+static void cluster_async_data_free(cluster_async_data *cad) {
+    redisClusterAsyncContext *acc;
+
+    if (cad == NULL) {
+        return;
+    }
+
+    acc = cad->acc;
+    if (cad->deadline != 0) {
+        cluster_async_deadline_unlink(cad);
+    }
+    if (acc == NULL || acc->data_pool_n >= CLUSTER_POOL_MAX_SIZE) {
+        command_destroy(cad->command);
+        hi_free(cad);
+        return;
+    }
+
+    cluster_command_release(acc->cc, cad->command);
+    cad->next_free = acc->data_pool;
+    acc->data_pool = cad;
+    acc->data_pool_n++;
 }
 
 static void unlinkAsyncContextAndNode(void *data) {
@@ -3655,35 +5422,223 @@ static void unlinkAsyncContextAndNode(void *data) {
 
     if (data) {
         node = (redisClusterNode *)(data);
+        if (node->acon != NULL) {
+            cluster_cache_connection_lost(node->acon);
+        }
         node->acon = NULL;
+        if (node->async_pool != NULL) {
+            node->async_pool->acon_pending = 0;
+        }
     }
 }
 
-redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
-                                    redisClusterNode *node) {
-    redisAsyncContext *ac;
-    int ret;
+static void unlinkAsyncContextAndPool(void *data) {
+    cluster_async_conn *conn;
 
-    if (node == NULL) {
+    if (data) {
+        conn = (cluster_async_conn *)(data);
+        if (conn->ac != NULL) {
+            cluster_cache_connection_lost(conn->ac);
+        }
+        conn->ac = NULL;
+        conn->pending = 0;
+    }
+}
+
+/* Get the node of an async connection, or NULL if the node is removed. */
+static redisClusterNode *actx_node(redisAsyncContext *ac) {
+    cluster_async_conn *conn;
+
+    if (ac->dataCleanup == unlinkAsyncContextAndPool) {
+        conn = ac->data;
+        return conn != NULL ? conn->node : NULL;
+    }
+    return ac->data;
+}
+
+/* Get the number of commands waiting for a reply on an async connection, or
+ * NULL when not counted since the node has no connection pool. */
+static int *actx_pending(redisAsyncContext *ac) {
+    cluster_async_conn *conn;
+    redisClusterNode *node;
+
+    if (ac->dataCleanup == unlinkAsyncContextAndPool) {
+        conn = ac->data;
+        return conn != NULL ? &conn->pending : NULL;
+    }
+    node = ac->data;
+    if (node == NULL || node->async_pool == NULL) {
         return NULL;
     }
+    return &node->async_pool->acon_pending;
+}
 
-    ac = node->acon;
-    if (ac != NULL) {
-        if (ac->c.err == 0) {
-            return ac;
+/* Read commands of a single key whose replies can be cached. */
+static int cluster_cache_command(struct cmd *command) {
+    if (command->keys == NULL || hiarray_n(command->keys) != 1) {
+        return 0;
+    }
+    switch (command->type) {
+    case CMD_REQ_REDIS_GET:
+    case CMD_REQ_REDIS_GETRANGE:
+    case CMD_REQ_REDIS_STRLEN:
+    case CMD_REQ_REDIS_HEXISTS:
+    case CMD_REQ_REDIS_HGET:
+    case CMD_REQ_REDIS_HGETALL:
+    case CMD_REQ_REDIS_HKEYS:
+    case CMD_REQ_REDIS_HLEN:
+    case CMD_REQ_REDIS_HMGET:
+    case CMD_REQ_REDIS_HSTRLEN:
+    case CMD_REQ_REDIS_HVALS:
+    case CMD_REQ_REDIS_LINDEX:
+    case CMD_REQ_REDIS_LLEN:
+    case CMD_REQ_REDIS_LRANGE:
+    case CMD_REQ_REDIS_SCARD:
+    case CMD_REQ_REDIS_SISMEMBER:
+    case CMD_REQ_REDIS_SMEMBERS:
+    case CMD_REQ_REDIS_SMISMEMBER:
+    case CMD_REQ_REDIS_ZCARD:
+    case CMD_REQ_REDIS_ZCOUNT:
+    case CMD_REQ_REDIS_ZMSCORE:
+    case CMD_REQ_REDIS_ZRANGE:
+    case CMD_REQ_REDIS_ZRANK:
+    case CMD_REQ_REDIS_ZREVRANK:
+    case CMD_REQ_REDIS_ZSCORE:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int cluster_cache_from_connection(hicache_entry *entry,
+                                         void *privdata) {
+    return entry->source == privdata;
+}
+
+/* Check if a cached reply was read on a connection to a node no longer
+ * serving its slot, either as the master or as a replica. */
+static int cluster_cache_slot_moved(hicache_entry *entry, void *privdata) {
+    redisClusterContext *cc = privdata;
+    redisClusterNode *node, *source;
+    listNode *ln;
+    listIter li;
+
+    node = cc->table != NULL ? cc->table[entry->slot] : NULL;
+    source = actx_node(entry->source);
+    if (node == NULL || source == NULL) {
+        return 1;
+    }
+    if (source == node) {
+        return 0;
+    }
+    if (node->slaves != NULL) {
+        listRewind(node->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            if (listNodeValue(ln) == source) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Push callback handling the invalidation messages of client tracking. */
+static void cluster_cache_push_callback(redisAsyncContext *ac, void *r) {
+    redisClusterAsyncContext *acc = ac->c.privdata;
+    redisReply *reply = r, *keys;
+    size_t i;
+
+    if (acc == NULL || acc->cache == NULL ||
+        reply->type != REDIS_REPLY_PUSH || reply->elements != 2 ||
+        reply->element[0]->type != REDIS_REPLY_STRING ||
+        strcmp(reply->element[0]->str, "invalidate") != 0) {
+        return;
+    }
+
+    keys = reply->element[1];
+    if (keys->type == REDIS_REPLY_NIL) {
+        /* All keys read on this connection, e.g. after a FLUSHALL. */
+        hicache_invalidate_if(acc->cache, cluster_cache_from_connection, ac);
+        return;
+    }
+    for (i = 0; keys->type == REDIS_REPLY_ARRAY && i < keys->elements; i++) {
+        if (keys->element[i]->type == REDIS_REPLY_STRING) {
+            hicache_invalidate_key(acc->cache, keys->element[i]->str,
+                                   keys->element[i]->len);
+        }
+    }
+}
+
+/* The server stops sending invalidations for the keys read on a connection
+ * when the connection is closed. */
+static void cluster_cache_connection_lost(redisAsyncContext *ac) {
+    redisClusterAsyncContext *acc = ac->c.privdata;
+
+    if (acc != NULL && acc->cache != NULL) {
+        hicache_invalidate_if(acc->cache, cluster_cache_from_connection, ac);
+    }
+}
+
+/* Reply callback of the handshake commands. When a handshake command fails the
+ * connection is closed, after the replies to the commands already sent. */
+static void actx_handshake_callback(redisAsyncContext *ac, void *r,
+                                    void *privdata) {
+    redisReply *reply = r;
+    redisClusterAsyncContext *acc = privdata;
+
+    if (reply == NULL || reply->type != REDIS_REPLY_ERROR) {
+        return;
+    }
+    __redisClusterAsyncSetError(acc, REDIS_ERR_OTHER, reply->str);
+    redisAsyncDisconnect(ac);
+}
+
+/* Queue the handshake commands on a new async connection, see
+ * cluster_handshake(). */
+static int actx_handshake(redisClusterAsyncContext *acc, redisAsyncContext *ac,
+                          int readonly) {
+    redisClusterContext *cc = acc->cc;
+    int ret = REDIS_OK, i;
+
+    if (cc->password != NULL) {
+        if (cc->username != NULL) {
+            ret = redisAsyncCommand(ac, actx_handshake_callback, acc,
+                                    "AUTH %s %s", cc->username, cc->password);
         } else {
-            /* The cluster node has a hiredis context with errors. Hiredis
-             * will asynchronously destruct the context and unlink it from
-             * the cluster node object. Return an error until done.
-             * An example scenario is when sending a command from a command
-             * callback, which has a NULL reply due to a disconnect. */
-            __redisClusterAsyncSetError(acc, ac->c.err, ac->c.errstr);
-            return NULL;
+            ret = redisAsyncCommand(ac, actx_handshake_callback, acc,
+                                    "AUTH %s", cc->password);
         }
     }
+    if (ret == REDIS_OK && (cc->protocol == 3 || cc->cache_max_memory > 0)) {
+        ret = redisAsyncCommand(ac, actx_handshake_callback, acc, "HELLO 3");
+    }
+    if (ret == REDIS_OK && cc->client_name != NULL) {
+        ret = redisAsyncCommand(ac, actx_handshake_callback, acc,
+                                "CLIENT SETNAME %s", cc->client_name);
+    }
+    // Get invalidation messages for the keys in the client-side cache
+    if (ret == REDIS_OK && cc->cache_max_memory > 0) {
+        redisAsyncSetPushCallback(ac, cluster_cache_push_callback);
+        ret = redisAsyncCommand(ac, actx_handshake_callback, acc,
+                                "CLIENT TRACKING on");
+    }
+    // Allow reads from a replica
+    if (ret == REDIS_OK && readonly) {
+        ret = redisAsyncCommand(ac, actx_handshake_callback, acc, "READONLY");
+    }
+    for (i = 0; ret == REDIS_OK && i < cc->handshake_ncmds; i++) {
+        ret = redisAsyncFormattedCommand(ac, actx_handshake_callback, acc,
+                                         cc->handshake_cmds[i].cmd,
+                                         cc->handshake_cmds[i].len);
+    }
+    return ret;
+}
 
-    // No async context exists, perform a connect
+/* Open a new async connection to a node. */
+static redisAsyncContext *actx_connect(redisClusterAsyncContext *acc,
+                                       redisClusterNode *node) {
+    redisAsyncContext *ac;
+    int ret;
 
     if (node->host == NULL || node->port <= 0) {
         __redisClusterAsyncSetError(acc, REDIS_ERR_OTHER,
@@ -3695,6 +5650,7 @@ redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
     REDIS_OPTIONS_SET_TCP(&options, node->host, node->port);
     options.connect_timeout = acc->cc->connect_timeout;
     options.command_timeout = acc->cc->command_timeout;
+    options.privdata = acc;
 
     node->lastConnectionAttempt = hi_usec_now();
 
@@ -3717,21 +5673,11 @@ redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
         return NULL;
     }
 
-    // Authenticate when needed
-    if (acc->cc->password != NULL) {
-        if (acc->cc->username != NULL) {
-            ret = redisAsyncCommand(ac, NULL, NULL, "AUTH %s %s",
-                                    acc->cc->username, acc->cc->password);
-        } else {
-            ret =
-                redisAsyncCommand(ac, NULL, NULL, "AUTH %s", acc->cc->password);
-        }
-
-        if (ret != REDIS_OK) {
-            __redisClusterAsyncSetError(acc, ac->c.err, ac->c.errstr);
-            redisAsyncFree(ac);
-            return NULL;
-        }
+    // Queue the handshake, written together with the first command
+    if (actx_handshake(acc, ac, node->role == REDIS_ROLE_SLAVE) != REDIS_OK) {
+        __redisClusterAsyncSetError(acc, ac->c.err, ac->c.errstr);
+        redisAsyncFree(ac);
+        return NULL;
     }
 
     if (acc->adapter) {
@@ -3757,6 +5703,42 @@ redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
         redisAsyncSetDisconnectCallback(ac, acc->onDisconnect);
     }
 
+    return ac;
+}
+
+redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
+                                    redisClusterNode *node) {
+    redisAsyncContext *ac;
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (acc->cc->idle_timeout > 0 || acc->cc->max_connections > 0) {
+        cluster_reap_connections(acc->cc, node, node->acon == NULL);
+    }
+
+    ac = node->acon;
+    if (ac != NULL) {
+        if (ac->c.err == 0) {
+            return ac;
+        } else {
+            /* The cluster node has a hiredis context with errors. Hiredis
+             * will asynchronously destruct the context and unlink it from
+             * the cluster node object. Return an error until done.
+             * An example scenario is when sending a command from a command
+             * callback, which has a NULL reply due to a disconnect. */
+            __redisClusterAsyncSetError(acc, ac->c.err, ac->c.errstr);
+            return NULL;
+        }
+    }
+
+    // No async context exists, perform a connect
+    ac = actx_connect(acc, node);
+    if (ac == NULL) {
+        return NULL;
+    }
+
     ac->data = node;
     ac->dataCleanup = unlinkAsyncContextAndNode;
     node->acon = ac;
@@ -3764,6 +5746,235 @@ redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
     return ac;
 }
 
+/* Get the number of commands waiting for a reply on a connection in the pool,
+ * where index -1 is node->acon. */
+static int cluster_async_pool_pending(redisClusterNode *node, int i) {
+    if (i < 0) {
+        return node->acon != NULL ? node->async_pool->acon_pending : 0;
+    }
+    return node->async_pool->conns[i].pending;
+}
+
+/* Get a connection to a node for a command. The commands are spread over the
+ * connection pool of the node when configured, and blocking commands are sent
+ * on dedicated connections when enabled. */
+static redisAsyncContext *actx_get_for_command(redisClusterAsyncContext *acc,
+                                               redisClusterNode *node,
+                                               struct cmd *command) {
+    redisClusterContext *cc = acc->cc;
+    struct cluster_async_pool *pool;
+    cluster_async_conn *conn;
+    redisAsyncContext *ac;
+    int blocking, first, count, i, selected;
+
+    blocking = command->blocking &&
+               (cc->flags & HIRCLUSTER_FLAG_BLOCKING_CONNECTIONS);
+    if (node == NULL || (cc->pool_size <= 1 && !blocking)) {
+        return actx_get_by_node(acc, node);
+    }
+
+    pool = node->async_pool;
+    if (pool == NULL) {
+        count = cc->pool_size - 1;
+        if (cc->flags & HIRCLUSTER_FLAG_BLOCKING_CONNECTIONS) {
+            count += cc->pool_size;
+        }
+        pool = hi_calloc(1, sizeof(*pool) + count * sizeof(pool->conns[0]));
+        if (pool == NULL) {
+            __redisClusterAsyncSetError(acc, REDIS_ERR_OOM, "Out of memory");
+            return NULL;
+        }
+        pool->size = cc->pool_size;
+        pool->nblocking = count - (cc->pool_size - 1);
+        for (i = 0; i < count; i++) {
+            pool->conns[i].node = node;
+        }
+        node->async_pool = pool;
+    }
+
+    if (blocking && pool->nblocking > 0) {
+        first = pool->size - 1;
+        count = pool->nblocking;
+    } else {
+        first = -1; /* node->acon */
+        count = pool->size;
+    }
+
+    selected = pool->next++ % count;
+    if (cc->pool_dispatch == HIRCLUSTER_POOL_LEAST_PENDING) {
+        /* Start at the next connection in turn to spread the commands over
+         * idle connections. */
+        for (i = 1; i < count; i++) {
+            int candidate = (selected + i) % count;
+            if (cluster_async_pool_pending(node, first + candidate) <
+                cluster_async_pool_pending(node, first + selected)) {
+                selected = candidate;
+            }
+        }
+    }
+
+    if (first + selected < 0) {
+        return actx_get_by_node(acc, node);
+    }
+
+    conn = &pool->conns[first + selected];
+    if (cc->idle_timeout > 0 || cc->max_connections > 0) {
+        cluster_reap_connections(cc, node, conn->ac == NULL);
+    }
+    if (conn->ac != NULL) {
+        if (conn->ac->c.err != 0) {
+            /* Destructed asynchronously, like node->acon. */
+            __redisClusterAsyncSetError(acc, conn->ac->c.err,
+                                        conn->ac->c.errstr);
+            return NULL;
+        }
+        return conn->ac;
+    }
+
+    ac = actx_connect(acc, node);
+    if (ac == NULL) {
+        return NULL;
+    }
+
+    ac->data = conn;
+    ac->dataCleanup = unlinkAsyncContextAndPool;
+    conn->ac = ac;
+
+    return ac;
+}
+
+/* Get a connection to a replica for a read-only command. Returns NULL when the
+ * command should be sent to the master instead, which includes when the
+ * replica can't be reached. */
+static redisAsyncContext *actx_get_for_read(redisClusterAsyncContext *acc,
+                                            redisClusterNode *master,
+                                            struct cmd *command) {
+    redisClusterNode *node;
+    redisAsyncContext *ac;
+
+    node = node_select_for_read(acc->cc, master);
+    if (node == master) {
+        return NULL;
+    }
+
+    ac = actx_get_for_command(acc, node, command);
+    if (ac == NULL) {
+        /* Fallback to the master */
+        acc->err = 0;
+        acc->errstr[0] = '\0';
+        if (node->latency < NODE_LATENCY_PENALTY) {
+            node->latency = NODE_LATENCY_PENALTY;
+        }
+    }
+    return ac;
+}
+
+/* Check if a node has reached the limits of commands waiting for a reply and
+ * of bytes waiting to be written, set by redisClusterAsyncSetMaxInFlight(). */
+static int cluster_async_node_full(redisClusterAsyncContext *acc,
+                                   redisClusterNode *node) {
+    struct cluster_async_pool *pool = node->async_pool;
+    size_t bytes = 0;
+    int i;
+
+    if (acc->max_inflight > 0 && node->inflight >= acc->max_inflight) {
+        return 1;
+    }
+    if (acc->max_buffered == 0) {
+        return 0;
+    }
+    if (node->acon != NULL) {
+        bytes += sdslen(node->acon->c.obuf);
+    }
+    for (i = 0; pool != NULL && i < pool->size - 1 + pool->nblocking; i++) {
+        if (pool->conns[i].ac != NULL) {
+            bytes += sdslen(pool->conns[i].ac->c.obuf);
+        }
+    }
+    return bytes >= acc->max_buffered;
+}
+
+/* Refuse a command to a node which has reached its limits. The producer may
+ * wait for the drain callback before sending more commands. */
+static int cluster_async_admit(redisClusterAsyncContext *acc,
+                               redisAsyncContext *ac) {
+    redisClusterNode *node;
+
+    if (acc->max_inflight == 0 && acc->max_buffered == 0) {
+        return REDIS_OK;
+    }
+    node = actx_node(ac);
+    if (node == NULL || !cluster_async_node_full(acc, node)) {
+        return REDIS_OK;
+    }
+    node->blocked = 1;
+    acc->rejected++;
+    __redisClusterAsyncSetError(acc, REDIS_ERR_CLUSTER_WOULD_BLOCK,
+                                "node is busy");
+    return REDIS_ERR;
+}
+
+/* Count a command sent on a connection as waiting for a reply, and start
+ * tracking the response time of the node when needed. */
+static void cluster_async_data_sent(cluster_async_data *cad,
+                                    redisAsyncContext *ac) {
+    redisClusterNode *node = actx_node(ac);
+    int *pending = actx_pending(ac);
+
+    if (pending != NULL) {
+        (*pending)++;
+        cad->pending = 1;
+    }
+    if (node == NULL) {
+        return;
+    }
+    node->inflight++;
+    cad->inflight = 1;
+    if (cad->acc->cc->read_policy == HIRCLUSTER_READ_LEAST_LATENCY) {
+        cad->start = hi_usec_now();
+    }
+}
+
+/* Update the counters and the response time of the node when a command sent
+ * on a connection completes. Producers are told when a node refusing commands
+ * is below its limits again. */
+static void cluster_async_data_replied(cluster_async_data *cad,
+                                       redisAsyncContext *ac, void *reply) {
+    redisClusterAsyncContext *acc = cad->acc;
+    redisClusterNode *node = actx_node(ac);
+    int *pending;
+
+    if (cad->pending) {
+        pending = actx_pending(ac);
+        if (pending != NULL && *pending > 0) {
+            (*pending)--;
+        }
+        cad->pending = 0;
+    }
+    if (!cad->inflight) {
+        return;
+    }
+    cad->inflight = 0;
+    if (node == NULL) {
+        return;
+    }
+    if (node->inflight > 0) {
+        node->inflight--;
+    }
+    if (cad->start != 0 && reply != NULL) {
+        node_update_latency(node, hi_usec_now() - cad->start);
+    }
+    cad->start = 0;
+
+    if (node->blocked && !cluster_async_node_full(acc, node)) {
+        node->blocked = 0;
+        acc->drains++;
+        if (acc->onDrain != NULL) {
+            acc->onDrain(acc, acc->drain_privdata);
+        }
+    }
+}
+
 redisClusterAsyncContext *redisClusterAsyncContextInit(void) {
     redisClusterContext *cc;
     redisClusterAsyncContext *acc;
@@ -3842,25 +6053,136 @@ int redisClusterAsyncSetDisconnectCallback(redisClusterAsyncContext *acc,
     return REDIS_ERR;
 }
 
-/* Reply callback function for CLUSTER SLOTS */
-void clusterSlotsReplyCallback(redisAsyncContext *ac, void *r, void *privdata) {
-    UNUSED(ac);
-    redisReply *reply = (redisReply *)r;
-    redisClusterAsyncContext *acc = (redisClusterAsyncContext *)privdata;
-    acc->lastSlotmapUpdateAttempt = hi_usec_now();
-
-    if (reply == NULL) {
-        /* Retry using available nodes */
-        updateSlotMapAsync(acc, NULL);
-        return;
+int redisClusterAsyncSetMaxInFlight(redisClusterAsyncContext *acc,
+                                    int max_commands, size_t max_bytes) {
+    if (acc == NULL || max_commands < 0) {
+        return REDIS_ERR;
     }
+    acc->max_inflight = max_commands;
+    acc->max_buffered = max_bytes;
+    return REDIS_OK;
+}
 
-    redisClusterContext *cc = acc->cc;
-    dict *nodes = parse_cluster_slots(cc, &ac->c, reply);
-    if (updateNodesAndSlotmap(cc, nodes) != REDIS_OK) {
-        /* Retry using available nodes */
-        updateSlotMapAsync(acc, NULL);
+int redisClusterAsyncSetDrainCallback(redisClusterAsyncContext *acc,
+                                      redisClusterDrainFn *fn,
+                                      void *privdata) {
+    if (acc == NULL) {
+        return REDIS_ERR;
     }
+    acc->onDrain = fn;
+    acc->drain_privdata = privdata;
+    return REDIS_OK;
+}
+
+int redisClusterAsyncSetCork(redisClusterAsyncContext *acc, size_t max_bytes) {
+    if (acc == NULL) {
+        return REDIS_ERR;
+    }
+    acc->cork_max_bytes = max_bytes;
+    return REDIS_OK;
+}
+
+int redisClusterAsyncSetCommandDeadline(redisClusterAsyncContext *acc,
+                                        const struct timeval tv) {
+    if (acc == NULL || tv.tv_sec < 0 || tv.tv_usec < 0) {
+        return REDIS_ERR;
+    }
+    acc->command_deadline = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    return REDIS_OK;
+}
+
+/* Reply callback for the PING sent on each connection opened by a warm-up. */
+static void clusterWarmUpCallback(redisAsyncContext *ac, void *r,
+                                  void *privdata) {
+    UNUSED(ac);
+    UNUSED(r);
+    redisClusterAsyncContext *acc = (redisClusterAsyncContext *)privdata;
+    redisClusterContext *cc = acc->cc;
+
+    if (--cc->warm_up_pending == 0 && !(cc->flags & HIRCLUSTER_FLAG_SHUTDOWN)) {
+        cluster_event_ready(cc);
+    }
+}
+
+/* Connect to a node not yet connected and send a PING, queued after the
+ * authentication, to know when the connection is ready. */
+static void actx_warm_up_node(redisClusterAsyncContext *acc,
+                              redisClusterNode *node) {
+    redisAsyncContext *ac;
+
+    if (node->acon != NULL) {
+        return;
+    }
+    ac = actx_get_by_node(acc, node);
+    if (ac != NULL &&
+        redisAsyncCommand(ac, clusterWarmUpCallback, acc, "PING") == REDIS_OK) {
+        acc->cc->warm_up_pending++;
+    }
+}
+
+/* Connect concurrently to all masters, and to their replicas when enabled. The
+ * ready event is sent when all new connections are done, successful or not. */
+static void actx_warm_up(redisClusterAsyncContext *acc) {
+    redisClusterContext *cc = acc->cc;
+    redisClusterNode *node;
+    dictEntry *de;
+    listNode *ln;
+    listIter li;
+    dictIterator di;
+
+    dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        actx_warm_up_node(acc, node);
+
+        if (!(cc->flags & HIRCLUSTER_FLAG_WARM_UP_REPLICAS) ||
+            node->slaves == NULL) {
+            continue;
+        }
+        listRewind(node->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            actx_warm_up_node(acc, listNodeValue(ln));
+        }
+    }
+
+    if (cc->warm_up_pending == 0) {
+        cluster_event_ready(cc);
+    }
+}
+
+/* Called when a slotmap update is done. */
+static void clusterSlotmapUpdated(redisClusterAsyncContext *acc) {
+    if (acc->cache != NULL) {
+        hicache_invalidate_if(acc->cache, cluster_cache_slot_moved, acc->cc);
+    }
+    if (acc->cc->flags & HIRCLUSTER_FLAG_WARM_UP) {
+        actx_warm_up(acc);
+    } else {
+        cluster_event_ready(acc->cc);
+    }
+}
+
+/* Reply callback function for CLUSTER SLOTS */
+void clusterSlotsReplyCallback(redisAsyncContext *ac, void *r, void *privdata) {
+    UNUSED(ac);
+    redisReply *reply = (redisReply *)r;
+    redisClusterAsyncContext *acc = (redisClusterAsyncContext *)privdata;
+    acc->lastSlotmapUpdateAttempt = hi_usec_now();
+
+    if (reply == NULL) {
+        /* Retry using available nodes */
+        updateSlotMapAsync(acc, NULL);
+        return;
+    }
+
+    redisClusterContext *cc = acc->cc;
+    dict *nodes = parse_cluster_slots(cc, &ac->c, reply);
+    if (updateNodesAndSlotmap(cc, nodes) != REDIS_OK) {
+        /* Retry using available nodes */
+        updateSlotMapAsync(acc, NULL);
+        return;
+    }
+    clusterSlotmapUpdated(acc);
 }
 
 /* Reply callback function for CLUSTER NODES */
@@ -3880,7 +6202,9 @@ void clusterNodesReplyCallback(redisAsyncContext *ac, void *r, void *privdata) {
     if (updateNodesAndSlotmap(cc, nodes) != REDIS_OK) {
         /* Retry using available nodes */
         updateSlotMapAsync(acc, NULL);
+        return;
     }
+    clusterSlotmapUpdated(acc);
 }
 
 #define nodeIsConnected(n)                                                     \
@@ -3940,6 +6264,17 @@ static int updateSlotMapAsync(redisClusterAsyncContext *acc,
         /* No slot map updates during a client shutdown. */
         return REDIS_ERR;
     }
+#ifdef HAVE_SUBMIT
+    /* The first shard of a sharded client owns the slotmap, and publishes
+     * its first one without being asked */
+    if (acc->cc->shards != NULL && cluster_shard_index(acc->cc) > 0) {
+        if (acc->cc->table != NULL) {
+            cluster_shards_request_update(acc->cc->shards);
+        }
+        acc->lastSlotmapUpdateAttempt = hi_usec_now();
+        return REDIS_OK;
+    }
+#endif
 
     if (ac == NULL) {
         if (acc->cc->nodes == NULL) {
@@ -3988,6 +6323,354 @@ static void throttledUpdateSlotMapAsync(redisClusterAsyncContext *acc,
     }
 }
 
+static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
+                                      void *privdata);
+
+/* Write the commands appended in cork mode to the connections of a node. */
+static void cluster_async_cork_flush_node(redisClusterNode *node) {
+    struct cluster_async_pool *pool = node->async_pool;
+    redisAsyncContext *ac;
+    int i;
+
+    ac = node->acon;
+    if (ac != NULL && sdslen(ac->c.obuf) > 0) {
+        redisAsyncHandleWrite(ac);
+    }
+    if (pool == NULL) {
+        return;
+    }
+    for (i = 0; i < pool->size - 1 + pool->nblocking; i++) {
+        ac = pool->conns[i].ac;
+        if (ac != NULL && sdslen(ac->c.obuf) > 0) {
+            redisAsyncHandleWrite(ac);
+        }
+    }
+}
+
+/* Write the commands appended in cork mode when the timer fires, in the event
+ * loop iteration following the one they were sent in. */
+static void cluster_async_cork_timeout(void *privdata) {
+    redisClusterAsyncContext *acc = privdata;
+    redisClusterNode *node, *slave;
+    dictEntry *de;
+    dictIterator di;
+    listNode *ln;
+    listIter li;
+
+    acc->cork_timer = NULL;
+    if (acc->cc->nodes == NULL) {
+        return;
+    }
+    dictInitIterator(&di, acc->cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        cluster_async_cork_flush_node(node);
+        if (node->slaves == NULL) {
+            continue;
+        }
+        listRewind(node->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            slave = listNodeValue(ln);
+            cluster_async_cork_flush_node(slave);
+        }
+    }
+}
+
+/* Used as the write hook of a connection while a command is appended in cork
+ * mode, to not start waiting for the socket to be writable. */
+static void cluster_async_cork_add_write(void *privdata) {
+    UNUSED(privdata);
+}
+
+/* Send a command on a connection. In cork mode the command is only appended
+ * to the output buffer, which is written together with the other commands
+ * sent in the same event loop iteration, or when it reaches the max size. */
+static int cluster_async_send(redisClusterAsyncContext *acc,
+                              redisAsyncContext *ac, cluster_async_data *cad,
+                              const char *cmd, int len) {
+    void (*add_write)(void *);
+    int status;
+
+    add_write = ac->ev.addWrite;
+    if (acc->cork_max_bytes == 0 || acc->timer_start_fn == NULL ||
+        add_write == NULL || !(ac->c.flags & REDIS_CONNECTED)) {
+        return redisAsyncFormattedCommand(ac, redisClusterAsyncCallback, cad,
+                                          cmd, len);
+    }
+
+    ac->ev.addWrite = cluster_async_cork_add_write;
+    status = redisAsyncFormattedCommand(ac, redisClusterAsyncCallback, cad, cmd,
+                                        len);
+    ac->ev.addWrite = add_write;
+    if (status != REDIS_OK) {
+        return REDIS_ERR;
+    }
+
+    if (sdslen(ac->c.obuf) < acc->cork_max_bytes) {
+        if (acc->cork_timer == NULL) {
+            acc->cork_timer = acc->timer_start_fn(
+                acc->adapter, 0, cluster_async_cork_timeout, acc);
+        }
+        if (acc->cork_timer != NULL) {
+            return REDIS_OK;
+        }
+    }
+    /* Written when the socket is writable, as without cork mode */
+    add_write(ac->ev.data);
+    return REDIS_OK;
+}
+
+/* Remove a command from the list of commands waiting for a retry. */
+static void cluster_async_delayed_unlink(redisClusterAsyncContext *acc,
+                                         cluster_async_data *cad) {
+    if (cad->prev_delayed != NULL) {
+        cad->prev_delayed->next_delayed = cad->next_delayed;
+    } else {
+        acc->delayed = cad->next_delayed;
+    }
+    if (cad->next_delayed != NULL) {
+        cad->next_delayed->prev_delayed = cad->prev_delayed;
+    }
+    cad->prev_delayed = cad->next_delayed = NULL;
+    cad->timer = NULL;
+}
+
+/* Reply to a command which can't be retried, and release it. */
+static void cluster_async_data_fail(cluster_async_data *cad) {
+    redisClusterAsyncContext *acc = cad->acc;
+
+    cad->callback(acc, NULL, cad->privdata);
+    if (acc->cc->err) {
+        acc->cc->err = 0;
+        memset(acc->cc->errstr, '\0', strlen(acc->cc->errstr));
+    }
+    if (acc->err) {
+        acc->err = 0;
+        memset(acc->errstr, '\0', strlen(acc->errstr));
+    }
+    cluster_async_data_free(cad);
+}
+
+/* Resend a command when its retry timer fires. The slot may have moved to
+ * another node while waiting, e.g. after a failover. */
+static void cluster_async_retry_timeout(void *privdata) {
+    cluster_async_data *cad = privdata;
+    redisClusterAsyncContext *acc = cad->acc;
+    struct cmd *command = cad->command;
+    redisClusterNode *node;
+    redisAsyncContext *ac;
+
+    cluster_async_delayed_unlink(acc, cad);
+
+    node = node_get_by_table(acc->cc, (uint32_t)command->slot_num);
+    if (node == NULL) {
+        __redisClusterAsyncSetError(acc, acc->cc->err, acc->cc->errstr);
+        goto error;
+    }
+    ac = actx_get_for_command(acc, node, command);
+    if (ac == NULL) {
+        /* Specific error already set */
+        goto error;
+    }
+    if (cluster_async_send(acc, ac, cad, command->cmd, command->clen) !=
+        REDIS_OK) {
+        __redisClusterAsyncSetError(acc, ac->err, ac->errstr);
+        goto error;
+    }
+    cluster_async_data_sent(cad, ac);
+    return;
+
+error:
+    cluster_async_data_fail(cad);
+}
+
+/* Deliver a cached reply from the event loop, like a reply from a node. */
+static void cluster_async_cache_timeout(void *privdata) {
+    cluster_async_data *cad = privdata;
+    redisClusterAsyncContext *acc = cad->acc;
+
+    cluster_async_delayed_unlink(acc, cad);
+    cad->callback(acc, cad->cache_entry->reply, cad->privdata);
+    hicache_release(cad->cache_entry);
+    cluster_async_data_free(cad);
+}
+
+/* Start a timer calling `fn` for a command after the delay. */
+static int cluster_async_delay(redisClusterAsyncContext *acc,
+                               cluster_async_data *cad, int64_t delay,
+                               void (*fn)(void *)) {
+    cad->timer = acc->timer_start_fn(acc->adapter, delay > 0 ? delay : 0, fn,
+                                     cad);
+    if (cad->timer == NULL) {
+        return REDIS_ERR;
+    }
+    cad->prev_delayed = NULL;
+    cad->next_delayed = acc->delayed;
+    if (acc->delayed != NULL) {
+        acc->delayed->prev_delayed = cad;
+    }
+    acc->delayed = cad;
+    return REDIS_OK;
+}
+
+/* Start a timer for retrying a command at the given time. */
+static int cluster_async_retry_delayed(redisClusterAsyncContext *acc,
+                                       cluster_async_data *cad,
+                                       int64_t retry_at) {
+    return cluster_async_delay(acc, cad, retry_at - hi_usec_now(),
+                               cluster_async_retry_timeout);
+}
+
+/* Stop the timers of all commands waiting for a retry and fail them. Cached
+ * replies are delivered right away. */
+static void cluster_async_retry_cancel(redisClusterAsyncContext *acc) {
+    cluster_async_data *cad;
+
+    while ((cad = acc->delayed) != NULL) {
+        acc->timer_stop_fn(cad->timer);
+        if (cad->cache_entry != NULL) {
+            cad->timer = NULL;
+            cluster_async_cache_timeout(cad);
+            continue;
+        }
+        cluster_async_delayed_unlink(acc, cad);
+        __redisClusterAsyncSetError(acc, REDIS_ERR_OTHER, "client closing");
+        cluster_async_data_fail(cad);
+    }
+}
+
+static void cluster_async_deadline_timeout(void *privdata);
+
+/* Start the timer of the deadline wheel to fire at the end of a tick, unless
+ * it already fires before that. */
+static int cluster_async_deadline_arm(redisClusterAsyncContext *acc,
+                                      int64_t tick) {
+    struct cluster_async_wheel *wheel = acc->deadlines;
+
+    if (wheel->timer != NULL) {
+        if (wheel->timer_tick <= tick) {
+            return REDIS_OK;
+        }
+        acc->timer_stop_fn(wheel->timer);
+    }
+    wheel->timer = acc->timer_start_fn(
+        acc->adapter, (tick + 1) * DEADLINE_WHEEL_TICK_USEC - hi_usec_now(),
+        cluster_async_deadline_timeout, acc);
+    if (wheel->timer == NULL) {
+        return REDIS_ERR;
+    }
+    wheel->timer_tick = tick;
+    return REDIS_OK;
+}
+
+/* Give a command the deadline set on the context, if any, and add it to the
+ * timer wheel. */
+static int cluster_async_deadline_start(redisClusterAsyncContext *acc,
+                                        cluster_async_data *cad) {
+    struct cluster_async_wheel *wheel = acc->deadlines;
+    cluster_async_data **slot;
+    int64_t now;
+
+    if (acc->command_deadline == 0 || acc->timer_start_fn == NULL) {
+        return REDIS_OK;
+    }
+    if (wheel == NULL) {
+        wheel = hi_calloc(1, sizeof(*wheel));
+        if (wheel == NULL) {
+            return REDIS_ERR;
+        }
+        acc->deadlines = wheel;
+    }
+
+    now = hi_usec_now();
+    if (wheel->count == 0) {
+        wheel->tick = now / DEADLINE_WHEEL_TICK_USEC;
+    }
+    if (cluster_async_deadline_arm(acc, (now + acc->command_deadline) /
+                                            DEADLINE_WHEEL_TICK_USEC) !=
+        REDIS_OK) {
+        return REDIS_ERR;
+    }
+
+    cad->deadline = now + acc->command_deadline;
+    slot = &wheel->slots[DEADLINE_WHEEL_SLOT(cad->deadline)];
+    cad->prev_deadline = NULL;
+    cad->next_deadline = *slot;
+    if (*slot != NULL) {
+        (*slot)->prev_deadline = cad;
+    }
+    *slot = cad;
+    wheel->count++;
+    return REDIS_OK;
+}
+
+/* Fail a command which deadline has passed. A command waiting for a reply is
+ * kept until the reply arrives, which is then discarded. */
+static void cluster_async_deadline_expire(cluster_async_data *cad) {
+    redisClusterAsyncContext *acc = cad->acc;
+
+    cluster_async_deadline_unlink(cad);
+    __redisClusterAsyncSetError(acc, REDIS_ERR_TIMEOUT,
+                                "command deadline exceeded");
+    if (cad->timer != NULL) {
+        /* Waiting for a retry */
+        acc->timer_stop_fn(cad->timer);
+        cluster_async_delayed_unlink(acc, cad);
+        cluster_async_data_fail(cad);
+        return;
+    }
+
+    cad->expired = 1;
+    cad->callback(acc, NULL, cad->privdata);
+    if (acc->cc->err) {
+        acc->cc->err = 0;
+        memset(acc->cc->errstr, '\0', strlen(acc->cc->errstr));
+    }
+    if (acc->err) {
+        acc->err = 0;
+        memset(acc->errstr, '\0', strlen(acc->errstr));
+    }
+}
+
+/* Expire the commands in the ticks that have passed when the timer of the
+ * deadline wheel fires, and start it again for the next tick having
+ * commands. */
+static void cluster_async_deadline_timeout(void *privdata) {
+    redisClusterAsyncContext *acc = privdata;
+    struct cluster_async_wheel *wheel = acc->deadlines;
+    cluster_async_data *cad;
+    int64_t now, now_tick, tick;
+    int n;
+
+    wheel->timer = NULL;
+    now = hi_usec_now();
+    now_tick = now / DEADLINE_WHEEL_TICK_USEC;
+    for (n = 0; wheel->tick < now_tick && n < DEADLINE_WHEEL_SLOTS; n++) {
+        /* The slot is searched again after each callback, which may send or
+         * complete other commands. Later rounds are left in the slot. */
+        do {
+            cad = wheel->slots[wheel->tick % DEADLINE_WHEEL_SLOTS];
+            while (cad != NULL && cad->deadline > now) {
+                cad = cad->next_deadline;
+            }
+            if (cad != NULL) {
+                cluster_async_deadline_expire(cad);
+            }
+        } while (cad != NULL);
+        wheel->tick++;
+    }
+    wheel->tick = now_tick;
+
+    if (wheel->count == 0) {
+        return;
+    }
+    for (tick = now_tick;
+         wheel->slots[tick % DEADLINE_WHEEL_SLOTS] == NULL; tick++)
+        ;
+    /* Not expired in time when out of memory, but at the next arm. */
+    cluster_async_deadline_arm(acc, tick);
+}
+
 static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
                                       void *privdata) {
     int ret;
@@ -3999,6 +6682,7 @@ static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
     int error_type;
     redisClusterNode *node;
     struct cmd *command;
+    int64_t retry_at;
 
     if (cad == NULL) {
         goto error;
@@ -4019,11 +6703,25 @@ static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
         goto error;
     }
 
+    cluster_async_data_replied(cad, ac, reply);
+
+    if (acc->err) {
+        /* Left by an earlier call, like a command refused by a busy node */
+        acc->err = 0;
+        memset(acc->errstr, '\0', strlen(acc->errstr));
+    }
+
+    if (cad->expired) {
+        /* Already failed by its deadline */
+        cluster_async_data_free(cad);
+        return;
+    }
+
     if (reply == NULL) {
         /* Copy reply specific error from hiredis */
         __redisClusterAsyncSetError(acc, ac->err, ac->errstr);
 
-        node = (redisClusterNode *)ac->data;
+        node = actx_node(ac);
         if (node == NULL)
             goto done; /* Node already removed from topology */
 
@@ -4062,7 +6760,7 @@ static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
             if (slot >= 0) {
                 cc->table[slot] = node;
             }
-            ac_retry = actx_get_by_node(acc, node);
+            ac_retry = actx_get_for_command(acc, node, command);
 
             break;
         case CLUSTER_ERR_ASK:
@@ -4072,7 +6770,7 @@ static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
                 goto done;
             }
 
-            ac_retry = actx_get_by_node(acc, node);
+            ac_retry = actx_get_for_command(acc, node, command);
             if (ac_retry == NULL) {
                 /* Specific error already set */
                 goto done;
@@ -4086,6 +6784,26 @@ static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
             break;
         case CLUSTER_ERR_TRYAGAIN:
         case CLUSTER_ERR_CLUSTERDOWN:
+            if (cc->retry_backoff_min > 0 && acc->timer_start_fn != NULL) {
+                /* Wait for the migration or failover to complete. */
+                retry_at = cluster_retry_time(cc, cad->retry_count,
+                                              &cad->first_retry);
+                if (retry_at < 0) {
+                    __redisClusterAsyncSetError(
+                        acc, REDIS_ERR_CLUSTER_TOO_MANY_RETRIES,
+                        "cluster retry deadline exceeded");
+                    goto done;
+                }
+                if (cad->deadline != 0 && retry_at >= cad->deadline) {
+                    __redisClusterAsyncSetError(acc, REDIS_ERR_TIMEOUT,
+                                                "command deadline exceeded");
+                    goto done;
+                }
+                if (cluster_async_retry_delayed(acc, cad, retry_at) ==
+                    REDIS_OK) {
+                    return;
+                }
+            }
             ac_retry = ac;
 
             break;
@@ -4100,6 +6818,15 @@ static void redisClusterAsyncCallback(redisAsyncContext *ac, void *r,
 
 done:
 
+    if (cad->cache_miss && !acc->err && reply != NULL &&
+        reply->type != REDIS_REPLY_ERROR &&
+        acc->cache != NULL && ac->push_cb == cluster_cache_push_callback) {
+        /* Not caching a reply when out of memory is harmless. */
+        hicache_add(acc->cache, command->cmd, command->clen,
+                    command->cmd + cad->cache_key_pos, cad->cache_key_len,
+                    command->slot_num, ac, reply);
+    }
+
     if (acc->err) {
         cad->callback(acc, NULL, cad->privdata);
     } else {
@@ -4122,11 +6849,11 @@ done:
 
 retry:
 
-    ret = redisAsyncFormattedCommand(ac_retry, redisClusterAsyncCallback, cad,
-                                     command->cmd, command->clen);
+    ret = cluster_async_send(acc, ac_retry, cad, command->cmd, command->clen);
     if (ret != REDIS_OK) {
         goto error;
     }
+    cluster_async_data_sent(cad, ac_retry);
 
     return;
 
@@ -4135,28 +6862,96 @@ error:
     cluster_async_data_free(cad);
 }
 
-int redisClusterAsyncFormattedCommand(redisClusterAsyncContext *acc,
+/* Check the client-side cache before sending a command. A cached reply is
+ * delivered from the event loop using the returned `cad`. On a miss `cad` is
+ * returned for a command which reply can be added to the cache. A command
+ * writing a key invalidates the cached replies of the key. */
+static int cluster_async_cache_lookup(redisClusterAsyncContext *acc,
+                                      struct cmd *command,
                                       redisClusterCallbackFn *fn,
-                                      void *privdata, char *cmd, int len) {
-
-    redisClusterContext *cc;
-    int status = REDIS_OK;
-    int slot_num;
-    redisClusterNode *node;
-    redisAsyncContext *ac;
-    struct cmd *command = NULL;
-    hilist *commands = NULL;
-    cluster_async_data *cad = NULL;
+                                      void *privdata,
+                                      cluster_async_data **cadp) {
+    cluster_async_data *cad;
+    struct keypos *kp;
+    hicache_entry *entry;
+    uint32_t i;
 
-    if (acc == NULL) {
-        return REDIS_ERR;
+    if (acc->cache == NULL) {
+        acc->cache = hicache_create(acc->cc->cache_max_memory);
+        if (acc->cache == NULL) {
+            return REDIS_ERR;
+        }
     }
 
-    cc = acc->cc;
-
+    if (!cluster_cache_command(command)) {
+        if (command->readonly || command->keys == NULL) {
+            return REDIS_OK;
+        }
+        for (i = 0; i < hiarray_n(command->keys); i++) {
+            kp = hiarray_get(command->keys, i);
+            hicache_invalidate_key(acc->cache, kp->start,
+                                   kp->end - kp->start);
+        }
+        return REDIS_OK;
+    }
+
+    cad = cluster_async_data_create(acc);
+    if (cad == NULL) {
+        return REDIS_ERR;
+    }
+    entry = hicache_get(acc->cache, command->cmd, command->clen);
+    if (entry == NULL) {
+        kp = hiarray_get(command->keys, 0);
+        cad->cache_miss = 1;
+        cad->cache_key_pos = (uint32_t)(kp->start - command->cmd);
+        cad->cache_key_len = (uint32_t)(kp->end - kp->start);
+        *cadp = cad;
+        return REDIS_OK;
+    }
+
+    cad->cache_entry = entry;
+    cad->callback = fn;
+    cad->privdata = privdata;
+    if (cluster_async_delay(acc, cad, 0, cluster_async_cache_timeout) !=
+        REDIS_OK) {
+        hicache_release(entry);
+        cluster_async_data_free(cad);
+        return REDIS_ERR;
+    }
+    *cadp = cad;
+    return REDIS_OK;
+}
+
+/* Send a formatted command to the node serving its keys. When `owned` is set
+ * the buffer is handed over and freed together with the command, otherwise
+ * the command is copied if it might be resent due to a redirect. */
+static int cluster_async_formatted_command(redisClusterAsyncContext *acc,
+                                           redisClusterCallbackFn *fn,
+                                           void *privdata, char *cmd, int len,
+                                           int owned) {
+    redisClusterContext *cc;
+    int status = REDIS_OK;
+    int slot_num;
+    redisClusterNode *node;
+    redisAsyncContext *ac;
+    struct cmd *command = NULL;
+    cluster_async_data *cad = NULL;
+
+    if (acc == NULL) {
+        if (owned) {
+            hi_free(cmd);
+        }
+        return REDIS_ERR;
+    }
+
+    cc = acc->cc;
+
     /* Don't accept new commands when the client is about to be shutdown. */
     if (cc->flags & HIRCLUSTER_FLAG_SHUTDOWN) {
         __redisClusterAsyncSetError(acc, REDIS_ERR_OTHER, "client closing");
+        if (owned) {
+            hi_free(cmd);
+        }
         return REDIS_ERR;
     }
 
@@ -4170,26 +6965,19 @@ int redisClusterAsyncFormattedCommand(redisClusterAsyncContext *acc,
         memset(acc->errstr, '\0', strlen(acc->errstr));
     }
 
-    command = command_get();
+    command = cluster_command_get(cc);
     if (command == NULL) {
+        if (owned) {
+            hi_free(cmd);
+        }
         goto oom;
     }
 
-    command->cmd = hi_calloc(len, sizeof(*command->cmd));
-    if (command->cmd == NULL) {
-        goto oom;
-    }
-    memcpy(command->cmd, cmd, len);
+    /* The keys are parsed directly from the given buffer */
+    command->cmd = cmd;
     command->clen = len;
 
-    commands = listCreate();
-    if (commands == NULL) {
-        goto oom;
-    }
-
-    commands->free = listCommandFree;
-
-    slot_num = command_format_by_slot(cc, command, commands);
+    slot_num = command_format_by_slot(cc, command);
 
     if (slot_num < 0) {
         __redisClusterAsyncSetError(acc, cc->err, cc->errstr);
@@ -4201,8 +6989,8 @@ int redisClusterAsyncFormattedCommand(redisClusterAsyncContext *acc,
     }
 
     // all keys not belong to one slot
-    if (listLength(commands) > 0) {
-        ASSERT(listLength(commands) != 1);
+    if (command->sub_commands != NULL) {
+        ASSERT(listLength(command->sub_commands) > 1);
 
         __redisClusterAsyncSetError(
             acc, REDIS_ERR_OTHER,
@@ -4210,6 +6998,20 @@ int redisClusterAsyncFormattedCommand(redisClusterAsyncContext *acc,
         goto error;
     }
 
+    if (cc->cache_max_memory > 0 && acc->timer_start_fn != NULL) {
+        status = cluster_async_cache_lookup(acc, command, fn, privdata, &cad);
+        if (status != REDIS_OK) {
+            goto oom;
+        }
+        if (cad != NULL && cad->cache_entry != NULL) {
+            if (!owned) {
+                command->cmd = NULL; /* Buffer owned by the caller */
+            }
+            cluster_command_release(cc, command);
+            return REDIS_OK;
+        }
+    }
+
     node = node_get_by_table(cc, (uint32_t)slot_num);
     if (node == NULL) {
         /* Initiate a slotmap update since the slot is not served. */
@@ -4220,33 +7022,56 @@ int redisClusterAsyncFormattedCommand(redisClusterAsyncContext *acc,
         goto error;
     }
 
-    ac = actx_get_by_node(acc, node);
+    ac = NULL;
+    if (command->readonly) {
+        ac = actx_get_for_read(acc, node, command);
+    }
+    if (ac == NULL) {
+        ac = actx_get_for_command(acc, node, command);
+    }
     if (ac == NULL) {
         /* Specific error already set */
         goto error;
     }
+    if (cluster_async_admit(acc, ac) != REDIS_OK) {
+        goto error;
+    }
+
+    if (!owned) {
+        /* Keep a copy of the command only when it can be resent after a
+         * redirect, since hiredis copies the command to its output buffer. */
+        command->cmd = NULL;
+        if (cc->max_retry_count > 0 || (cad != NULL && cad->cache_miss)) {
+            command->cmd = hi_malloc(len);
+            if (command->cmd == NULL) {
+                goto oom;
+            }
+            memcpy(command->cmd, cmd, len);
+        }
+    }
 
-    cad = cluster_async_data_create();
     if (cad == NULL) {
-        goto oom;
+        cad = cluster_async_data_create(acc);
+        if (cad == NULL) {
+            goto oom;
+        }
     }
 
-    cad->acc = acc;
     cad->command = command;
     command = NULL; /* Memory ownership moved. */
     cad->callback = fn;
     cad->privdata = privdata;
 
-    status = redisAsyncFormattedCommand(ac, redisClusterAsyncCallback, cad, cmd,
-                                        len);
+    if (cluster_async_deadline_start(acc, cad) != REDIS_OK) {
+        goto oom;
+    }
+
+    status = cluster_async_send(acc, ac, cad, cmd, len);
     if (status != REDIS_OK) {
         __redisClusterAsyncSetError(acc, ac->err, ac->errstr);
         goto error;
     }
-
-    if (commands != NULL) {
-        listRelease(commands);
-    }
+    cluster_async_data_sent(cad, ac);
 
     return REDIS_OK;
 
@@ -4256,13 +7081,19 @@ oom:
 
 error:
     cluster_async_data_free(cad);
-    command_destroy(command);
-    if (commands != NULL) {
-        listRelease(commands);
+    if (command != NULL && !owned && command->cmd == cmd) {
+        command->cmd = NULL; /* Buffer owned by the caller */
     }
+    cluster_command_release(cc, command);
     return REDIS_ERR;
 }
 
+int redisClusterAsyncFormattedCommand(redisClusterAsyncContext *acc,
+                                      redisClusterCallbackFn *fn,
+                                      void *privdata, char *cmd, int len) {
+    return cluster_async_formatted_command(acc, fn, privdata, cmd, len, 0);
+}
+
 int redisClusterAsyncFormattedCommandToNode(redisClusterAsyncContext *acc,
                                             redisClusterNode *node,
                                             redisClusterCallbackFn *fn,
@@ -4296,35 +7127,37 @@ int redisClusterAsyncFormattedCommandToNode(redisClusterAsyncContext *acc,
         memset(acc->errstr, '\0', strlen(acc->errstr));
     }
 
-    command = command_get();
-    if (command == NULL) {
-        goto oom;
+    if (cluster_async_admit(acc, ac) != REDIS_OK) {
+        return REDIS_ERR;
     }
 
-    command->cmd = hi_calloc(len, sizeof(*command->cmd));
-    if (command->cmd == NULL) {
+    /* The command is not resent on redirects, so no copy is kept */
+    command = cluster_command_get(cc);
+    if (command == NULL) {
         goto oom;
     }
-    memcpy(command->cmd, cmd, len);
     command->clen = len;
 
-    cad = cluster_async_data_create();
+    cad = cluster_async_data_create(acc);
     if (cad == NULL)
         goto oom;
 
-    cad->acc = acc;
     cad->command = command;
     command = NULL; /* Memory ownership moved. */
     cad->callback = fn;
     cad->privdata = privdata;
     cad->retry_count = NO_RETRY;
 
-    status = redisAsyncFormattedCommand(ac, redisClusterAsyncCallback, cad, cmd,
-                                        len);
+    if (cluster_async_deadline_start(acc, cad) != REDIS_OK) {
+        goto oom;
+    }
+
+    status = cluster_async_send(acc, ac, cad, cmd, len);
     if (status != REDIS_OK) {
         __redisClusterAsyncSetError(acc, ac->err, ac->errstr);
         goto error;
     }
+    cluster_async_data_sent(cad, ac);
     return REDIS_OK;
 
 oom:
@@ -4333,14 +7166,13 @@ oom:
 
 error:
     cluster_async_data_free(cad);
-    command_destroy(command);
+    cluster_command_release(cc, command);
     return REDIS_ERR;
 }
 
 int redisClustervAsyncCommand(redisClusterAsyncContext *acc,
                               redisClusterCallbackFn *fn, void *privdata,
                               const char *format, va_list ap) {
-    int ret;
     char *cmd;
     int len;
 
@@ -4358,11 +7190,8 @@ int redisClustervAsyncCommand(redisClusterAsyncContext *acc,
         return REDIS_ERR;
     }
 
-    ret = redisClusterAsyncFormattedCommand(acc, fn, privdata, cmd, len);
-
-    hi_free(cmd);
-
-    return ret;
+    /* The formatted command is handed over to avoid copying it */
+    return cluster_async_formatted_command(acc, fn, privdata, cmd, len, 1);
 }
 
 int redisClusterAsyncCommand(redisClusterAsyncContext *acc,
@@ -4411,7 +7240,6 @@ int redisClusterAsyncCommandArgv(redisClusterAsyncContext *acc,
                                  redisClusterCallbackFn *fn, void *privdata,
                                  int argc, const char **argv,
                                  const size_t *argvlen) {
-    int ret;
     char *cmd;
     int len;
 
@@ -4421,11 +7249,8 @@ int redisClusterAsyncCommandArgv(redisClusterAsyncContext *acc,
         return REDIS_ERR;
     }
 
-    ret = redisClusterAsyncFormattedCommand(acc, fn, privdata, cmd, len);
-
-    hi_free(cmd);
-
-    return ret;
+    /* The formatted command is handed over to avoid copying it */
+    return cluster_async_formatted_command(acc, fn, privdata, cmd, len, 1);
 }
 
 int redisClusterAsyncCommandArgvToNode(redisClusterAsyncContext *acc,
@@ -4453,6 +7278,743 @@ int redisClusterAsyncCommandArgvToNode(redisClusterAsyncContext *acc,
     return ret;
 }
 
+#ifdef HAVE_SUBMIT
+/* A command submitted from any thread, to be sent from the event loop thread */
+typedef struct cluster_submission {
+    struct cluster_submission *next;
+    redisClusterCallbackFn *fn;
+    void *privdata;
+    char *cmd;
+    int len;
+} cluster_submission;
+
+/* Lock-free queue of submitted commands, with any number of producers and the
+ * event loop thread as the single consumer. Producers link a command at the
+ * head using an atomic exchange, and the consumer takes commands from the
+ * tail. The stub keeps the queue from becoming empty, so producers never touch
+ * the tail. The event loop is woken up by a write to a pipe, unless a wakeup
+ * is already signaled and not yet handled. */
+struct cluster_submit_queue {
+    cluster_submission *head;
+    cluster_submission *tail;
+    cluster_submission stub;
+    int signaled; /* A wakeup is written to the pipe */
+    int fds[2];   /* Read and write end of the pipe */
+    void *watch;  /* Watch of the read end in the event loop, or NULL */
+};
+
+static void cluster_submit_push(struct cluster_submit_queue *q,
+                                cluster_submission *s) {
+    cluster_submission *prev;
+
+    s->next = NULL; /* Published by the exchange */
+    prev = ATOMIC_EXCHANGE(&q->head, s);
+    /* The command is not reachable by the consumer until linked */
+    ATOMIC_STORE(&prev->next, s);
+}
+
+/* Take the oldest submitted command from the queue. Returns NULL when empty,
+ * or when the next command is not yet linked by its producer, which signals
+ * a wakeup when it is. */
+static cluster_submission *cluster_submit_pop(struct cluster_submit_queue *q) {
+    cluster_submission *tail = q->tail;
+    cluster_submission *next = ATOMIC_LOAD(&tail->next);
+
+    if (tail == &q->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        q->tail = next;
+        tail = next;
+        next = ATOMIC_LOAD(&tail->next);
+    }
+    if (next != NULL) {
+        q->tail = next;
+        return tail;
+    }
+    if (tail != ATOMIC_LOAD(&q->head)) {
+        return NULL;
+    }
+    /* Put the stub back to be able to take the last command */
+    cluster_submit_push(q, &q->stub);
+    next = ATOMIC_LOAD(&tail->next);
+    if (next != NULL) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/* Wake up the event loop, unless it is already signaled. */
+static void cluster_submit_wakeup(struct cluster_submit_queue *q) {
+    /* Avoid writing to the flag, shared with other threads, when signaled */
+    if (ATOMIC_LOAD(&q->signaled) == 0 &&
+        ATOMIC_EXCHANGE(&q->signaled, 1) == 0) {
+        /* Fails only when the pipe is full, which is a wakeup as well */
+        ssize_t n = write(q->fds[1], "", 1);
+        UNUSED(n);
+    }
+}
+
+/* Send a submitted command, or give the error to its callback since the
+ * submitting thread can't access the context. */
+static void cluster_submit_send(redisClusterAsyncContext *acc,
+                                cluster_submission *s) {
+    /* The formatted command is handed over to avoid copying it */
+    if (cluster_async_formatted_command(acc, s->fn, s->privdata, s->cmd,
+                                        s->len, 1) != REDIS_OK) {
+        if (s->fn != NULL) {
+            s->fn(acc, NULL, s->privdata);
+        }
+        acc->err = 0;
+        memset(acc->errstr, '\0', strlen(acc->errstr));
+    }
+    hi_free(s);
+}
+
+/* Send the submitted commands when the event loop is woken up. */
+static void cluster_submit_handle(void *privdata) {
+    redisClusterAsyncContext *acc = privdata;
+    struct cluster_submit_queue *q = acc->submit_queue;
+    cluster_submission *s;
+    char buf[64];
+
+    while (read(q->fds[0], buf, sizeof(buf)) > 0)
+        ;
+    /* Commands submitted from now on signal a new wakeup */
+    ATOMIC_STORE(&q->signaled, 0);
+    if (acc->cc->shards != NULL) {
+        cluster_shards_handle(acc);
+    }
+    while ((s = cluster_submit_pop(q)) != NULL) {
+        cluster_submit_send(acc, s);
+    }
+    /* Not when already stopping, i.e. called from the disconnect */
+    if (acc->cc->shards != NULL && q->watch != NULL &&
+        cluster_shards_stop_requested(acc)) {
+        redisClusterAsyncDisconnect(acc);
+    }
+}
+
+/* Stop watching for submitted commands, after sending the commands already
+ * submitted. Later commands are failed when the context is freed. */
+static void cluster_submit_stop(redisClusterAsyncContext *acc) {
+    struct cluster_submit_queue *q = acc->submit_queue;
+
+    if (q == NULL || q->watch == NULL) {
+        return;
+    }
+    acc->watch_stop_fn(q->watch);
+    q->watch = NULL;
+    cluster_submit_handle(acc);
+}
+
+static void cluster_submit_free(redisClusterAsyncContext *acc) {
+    struct cluster_submit_queue *q = acc->submit_queue;
+    cluster_submission *s;
+
+    if (q == NULL) {
+        return;
+    }
+    ATOMIC_STORE(&acc->submit_queue, NULL);
+    if (q->watch != NULL) {
+        acc->watch_stop_fn(q->watch);
+    }
+    while ((s = cluster_submit_pop(q)) != NULL) {
+        if (s->fn != NULL) {
+            s->fn(acc, NULL, s->privdata);
+        }
+        hi_free(s->cmd);
+        hi_free(s);
+    }
+    close(q->fds[0]);
+    close(q->fds[1]);
+    hi_free(q);
+}
+
+/* State of a shard of a sharded client. The first shard owns the slotmap: it
+ * is the only one fetching it from the cluster, and hands a copy over to each
+ * other shard, which installs it from its own thread. */
+struct cluster_shard {
+    dict *published; /* Slotmap handed over by the first shard, or NULL */
+    int update;      /* Slotmap update requested from the first shard */
+    int stop;        /* Disconnect requested by redisClusterAsyncShardsStop() */
+    int stale; /* Connections to nodes of other shards are still in use. Only
+                * accessed from the thread of the shard. */
+};
+
+static int cluster_shard_index(redisClusterContext *cc) {
+    int i;
+
+    for (i = 0; cc->shards->acc[i]->cc != cc; i++)
+        ;
+    return i;
+}
+
+/* Get the first slot served by a master, or REDIS_CLUSTER_SLOTS if none. */
+static uint32_t node_first_slot(redisClusterNode *node) {
+    uint32_t first = REDIS_CLUSTER_SLOTS;
+    cluster_slot *slot;
+    listNode *ln;
+    listIter li;
+
+    if (node->slots == NULL) {
+        return first;
+    }
+    listRewind(node->slots, &li);
+    while ((ln = listNext(&li)) != NULL) {
+        slot = listNodeValue(ln);
+        if (slot->start < first) {
+            first = slot->start;
+        }
+    }
+    return first;
+}
+
+/* Get the shard owning a master. The masters are spread over the shards in the
+ * order of their first slot, and masters without slots go to the first shard.
+ * The replicas go with their master. */
+static int cluster_node_shard(redisClusterContext *cc, redisClusterNode *node) {
+    uint32_t first = node_first_slot(node);
+    int rank = 0;
+    dictEntry *de;
+    dictIterator di;
+
+    if (first == REDIS_CLUSTER_SLOTS) {
+        return 0;
+    }
+    dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        if (node_first_slot(dictGetEntryVal(de)) < first) {
+            rank++;
+        }
+    }
+    return rank % cc->shards->count;
+}
+
+/* Copy a node of a slotmap, without its connections. */
+static redisClusterNode *cluster_node_copy(redisClusterNode *node) {
+    redisClusterNode *copy, *slave;
+    cluster_slot *slot, *slot_copy;
+    listNode *ln;
+    listIter li;
+
+    copy = createRedisClusterNode();
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->role = node->role;
+    copy->port = node->port;
+    copy->addr = sdsdup(node->addr);
+    copy->host = sdsdup(node->host);
+    if (copy->addr == NULL || copy->host == NULL) {
+        goto oom;
+    }
+    if (node->name != NULL && (copy->name = sdsdup(node->name)) == NULL) {
+        goto oom;
+    }
+    if (node->slots != NULL) {
+        listRewind(node->slots, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            slot = listNodeValue(ln);
+            slot_copy = cluster_slot_create(copy);
+            if (slot_copy == NULL) {
+                goto oom;
+            }
+            slot_copy->start = slot->start;
+            slot_copy->end = slot->end;
+        }
+    }
+    if (node->slaves != NULL) {
+        copy->slaves = listCreate();
+        if (copy->slaves == NULL) {
+            goto oom;
+        }
+        copy->slaves->free = listClusterNodeDestructor;
+        listRewind(node->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            slave = cluster_node_copy(listNodeValue(ln));
+            if (slave == NULL) {
+                goto oom;
+            }
+            if (listAddNodeTail(copy->slaves, slave) == NULL) {
+                freeRedisClusterNode(slave);
+                goto oom;
+            }
+        }
+    }
+    return copy;
+
+oom:
+    freeRedisClusterNode(copy);
+    return NULL;
+}
+
+/* Copy the nodes of a slotmap, to be installed by another shard. */
+static dict *cluster_nodes_copy(dict *nodes) {
+    redisClusterNode *copy;
+    dictEntry *de;
+    dictIterator di;
+    dict *copies;
+    sds key;
+
+    copies = dictCreate(&clusterNodesDictType, NULL);
+    if (copies == NULL) {
+        return NULL;
+    }
+    dictInitIterator(&di, nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        copy = cluster_node_copy(dictGetEntryVal(de));
+        if (copy == NULL) {
+            goto oom;
+        }
+        key = sdsdup(copy->addr);
+        if (key == NULL || dictAdd(copies, key, copy) != DICT_OK) {
+            sdsfree(key);
+            freeRedisClusterNode(copy);
+            goto oom;
+        }
+    }
+    return copies;
+
+oom:
+    dictRelease(copies);
+    return NULL;
+}
+
+/* Close the connections to a node when they have no replies to wait for.
+ * Returns 1 when connections are left open. */
+static int node_connection_close_idle(redisClusterContext *cc,
+                                      redisClusterNode *node) {
+    if (node_connection_count(node) == 0) {
+        return 0;
+    }
+    if (!node_connection_idle(cc, node)) {
+        return 1;
+    }
+    node_connection_close(node);
+    return 0;
+}
+
+/* Close the connections of a shard to the nodes of other shards, opened before
+ * a slotmap change or to follow redirects. Connections still waiting for
+ * replies are closed later. Returns 1 when some are left open. */
+static int cluster_shards_close_others(redisClusterContext *cc, int index) {
+    redisClusterNode *master;
+    dictEntry *de;
+    dictIterator di;
+    listNode *ln;
+    listIter li;
+    int open = 0;
+
+    dictInitIterator(&di, cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        master = dictGetEntryVal(de);
+        if (cluster_node_shard(cc, master) == index) {
+            continue;
+        }
+        open |= node_connection_close_idle(cc, master);
+        if (master->slaves == NULL) {
+            continue;
+        }
+        listRewind(master->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            open |= node_connection_close_idle(cc, listNodeValue(ln));
+        }
+    }
+    return open;
+}
+
+static void cluster_shards_wakeup(redisClusterAsyncContext *acc) {
+    struct cluster_submit_queue *q = ATOMIC_LOAD(&acc->submit_queue);
+
+    /* When not yet enabled, the shard looks when enabled and connecting */
+    if (q != NULL) {
+        cluster_submit_wakeup(q);
+    }
+}
+
+/* Hand a copy of the slotmap of the first shard over to the other shards,
+ * followed by the owning shard of each slot for the submitting threads. A
+ * shard keeps its previous slotmap when out of memory, and follows the
+ * redirects. */
+static void cluster_shards_publish(redisClusterContext *cc) {
+    redisClusterAsyncShards *shards = cc->shards;
+    redisClusterNode *node = NULL;
+    unsigned char shard = 0;
+    dict *nodes;
+    int i, slot;
+
+    for (i = 1; i < shards->count; i++) {
+        nodes = cluster_nodes_copy(cc->nodes);
+        if (nodes == NULL) {
+            continue;
+        }
+        nodes = ATOMIC_EXCHANGE(&shards->shard[i].published, nodes);
+        if (nodes != NULL) {
+            /* Not installed by the shard yet */
+            dictRelease(nodes);
+        }
+        cluster_shards_wakeup(shards->acc[i]);
+    }
+    for (slot = 0; slot < REDIS_CLUSTER_SLOTS; slot++) {
+        if (cc->table[slot] != node) {
+            node = cc->table[slot];
+            shard = node ? (unsigned char)cluster_node_shard(cc, node) : 0;
+        }
+        ATOMIC_STORE(&shards->slot_shard[slot], shard);
+    }
+}
+
+/* Called when a shard has got a new slotmap: fetched by the first shard, which
+ * publishes it, or installed by another shard. */
+static void cluster_shards_update(redisClusterContext *cc) {
+    int index = cluster_shard_index(cc);
+
+    if (index == 0) {
+        cluster_shards_publish(cc);
+    }
+    cc->shards->shard[index].stale = cluster_shards_close_others(cc, index);
+}
+
+static void cluster_shards_request_update(redisClusterAsyncShards *shards) {
+    ATOMIC_STORE(&shards->shard[0].update, 1);
+    cluster_shards_wakeup(shards->acc[0]);
+}
+
+/* Install the slotmap published by the first shard, from the thread of
+ * another shard. Before the first shard has got a slotmap, none is published
+ * and it is installed when the shard is woken up. */
+static int cluster_shards_follow(redisClusterContext *cc) {
+    struct cluster_shard *shard = &cc->shards->shard[cluster_shard_index(cc)];
+    dict *nodes;
+
+    nodes = ATOMIC_EXCHANGE(&shard->published, NULL);
+    if (nodes == NULL) {
+        return REDIS_OK;
+    }
+    return updateNodesAndSlotmap(cc, nodes);
+}
+
+/* Handle the requests to a shard when its event loop is woken up, before
+ * sending the submitted commands. */
+static void cluster_shards_handle(redisClusterAsyncContext *acc) {
+    redisClusterContext *cc = acc->cc;
+    int index = cluster_shard_index(cc);
+    struct cluster_shard *shard = &cc->shards->shard[index];
+
+    if (index == 0) {
+        if (ATOMIC_LOAD(&shard->update) &&
+            ATOMIC_EXCHANGE(&shard->update, 0)) {
+            throttledUpdateSlotMapAsync(acc, NULL);
+        }
+    } else if (cluster_shards_follow(cc) != REDIS_OK) {
+        /* The previous slotmap is kept */
+        cc->err = 0;
+        memset(cc->errstr, '\0', strlen(cc->errstr));
+    }
+    if (shard->stale) {
+        shard->stale = cluster_shards_close_others(cc, index);
+    }
+}
+
+static int cluster_shards_stop_requested(redisClusterAsyncContext *acc) {
+    redisClusterAsyncShards *shards = acc->cc->shards;
+
+    return ATOMIC_LOAD(&shards->shard[cluster_shard_index(acc->cc)].stop);
+}
+#endif
+
+int redisClusterAsyncEnableSubmit(redisClusterAsyncContext *acc) {
+#ifndef HAVE_SUBMIT
+    __redisClusterAsyncSetError(acc, REDIS_ERR_OTHER,
+                                "Submitting commands is not supported");
+    return REDIS_ERR;
+#else
+    struct cluster_submit_queue *q;
+    int i;
+
+    if (acc->submit_queue != NULL) {
+        return REDIS_OK;
+    }
+    if (acc->watch_start_fn == NULL) {
+        __redisClusterAsyncSetError(acc, REDIS_ERR_OTHER,
+                                    "Adapter can't watch the wakeup pipe");
+        return REDIS_ERR;
+    }
+    q = hi_calloc(1, sizeof(*q));
+    if (q == NULL) {
+        __redisClusterAsyncSetError(acc, REDIS_ERR_OOM, "Out of memory");
+        return REDIS_ERR;
+    }
+    q->head = &q->stub;
+    q->tail = &q->stub;
+
+    if (pipe(q->fds) != 0) {
+        __redisClusterAsyncSetError(acc, REDIS_ERR_IO, NULL);
+        hi_free(q);
+        return REDIS_ERR;
+    }
+    for (i = 0; i < 2; i++) {
+        if (fcntl(q->fds[i], F_SETFL, O_NONBLOCK) == -1 ||
+            fcntl(q->fds[i], F_SETFD, FD_CLOEXEC) == -1) {
+            __redisClusterAsyncSetError(acc, REDIS_ERR_IO, NULL);
+            goto error;
+        }
+    }
+    q->watch = acc->watch_start_fn(acc->adapter, q->fds[0],
+                                   cluster_submit_handle, acc);
+    if (q->watch == NULL) {
+        __redisClusterAsyncSetError(acc, REDIS_ERR_OOM, "Out of memory");
+        goto error;
+    }
+    /* Published to the producers when ready */
+    ATOMIC_STORE(&acc->submit_queue, q);
+    return REDIS_OK;
+
+error:
+    close(q->fds[0]);
+    close(q->fds[1]);
+    hi_free(q);
+    return REDIS_ERR;
+#endif
+}
+
+/* Queue a formatted command, which is handed over, and wake up the event loop
+ * unless it is already signaled. */
+static int cluster_submit(redisClusterAsyncContext *acc,
+                          redisClusterCallbackFn *fn, void *privdata,
+                          char *cmd, int len) {
+#ifndef HAVE_SUBMIT
+    UNUSED(acc);
+    UNUSED(fn);
+    UNUSED(privdata);
+    UNUSED(len);
+    hi_free(cmd);
+    return REDIS_ERR;
+#else
+    struct cluster_submit_queue *q = ATOMIC_LOAD(&acc->submit_queue);
+    cluster_submission *s;
+
+    if (q == NULL) {
+        hi_free(cmd);
+        return REDIS_ERR;
+    }
+    s = hi_malloc(sizeof(*s));
+    if (s == NULL) {
+        hi_free(cmd);
+        return REDIS_ERR;
+    }
+    s->fn = fn;
+    s->privdata = privdata;
+    s->cmd = cmd;
+    s->len = len;
+    cluster_submit_push(q, s);
+    cluster_submit_wakeup(q);
+    return REDIS_OK;
+#endif
+}
+
+int redisClusterAsyncSubmit(redisClusterAsyncContext *acc,
+                            redisClusterCallbackFn *fn, void *privdata,
+                            const char *format, ...) {
+    va_list ap;
+    char *cmd;
+    int len;
+
+    va_start(ap, format);
+    len = redisvFormatCommand(&cmd, format, ap);
+    va_end(ap);
+
+    if (len < 0) {
+        return REDIS_ERR;
+    }
+    return cluster_submit(acc, fn, privdata, cmd, len);
+}
+
+int redisClusterAsyncSubmitArgv(redisClusterAsyncContext *acc,
+                                redisClusterCallbackFn *fn, void *privdata,
+                                int argc, const char **argv,
+                                const size_t *argvlen) {
+    char *cmd;
+    int len;
+
+    len = redisFormatCommandArgv(&cmd, argc, argv, argvlen);
+    if (len < 0) {
+        return REDIS_ERR;
+    }
+    return cluster_submit(acc, fn, privdata, cmd, len);
+}
+
+int redisClusterAsyncSubmitFormatted(redisClusterAsyncContext *acc,
+                                     redisClusterCallbackFn *fn,
+                                     void *privdata, const char *cmd,
+                                     int len) {
+    char *copy;
+
+    copy = hi_malloc(len);
+    if (copy == NULL) {
+        return REDIS_ERR;
+    }
+    memcpy(copy, cmd, len);
+    return cluster_submit(acc, fn, privdata, copy, len);
+}
+
+redisClusterAsyncShards *redisClusterAsyncShardsInit(int count) {
+#ifndef HAVE_SUBMIT
+    UNUSED(count);
+    return NULL;
+#else
+    redisClusterAsyncShards *shards;
+    int i;
+
+    if (count < 1 || count > HIRCLUSTER_MAX_SHARDS) {
+        return NULL;
+    }
+    shards = hi_calloc(1, sizeof(*shards));
+    if (shards == NULL) {
+        return NULL;
+    }
+    shards->acc = hi_calloc(count, sizeof(*shards->acc));
+    shards->slot_shard = hi_calloc(REDIS_CLUSTER_SLOTS, 1);
+    shards->shard = hi_calloc(count, sizeof(*shards->shard));
+    if (shards->acc == NULL || shards->slot_shard == NULL ||
+        shards->shard == NULL) {
+        goto oom;
+    }
+    for (; shards->count < count; shards->count++) {
+        i = shards->count;
+        shards->acc[i] = redisClusterAsyncContextInit();
+        if (shards->acc[i] == NULL) {
+            goto oom;
+        }
+        shards->acc[i]->cc->shards = shards;
+    }
+    return shards;
+
+oom:
+    redisClusterAsyncShardsFree(shards);
+    return NULL;
+#endif
+}
+
+void redisClusterAsyncShardsFree(redisClusterAsyncShards *shards) {
+    int i;
+
+    if (shards == NULL) {
+        return;
+    }
+    for (i = 0; i < shards->count; i++) {
+        redisClusterAsyncFree(shards->acc[i]);
+#ifdef HAVE_SUBMIT
+        if (shards->shard[i].published != NULL) {
+            dictRelease(shards->shard[i].published);
+        }
+#endif
+    }
+    hi_free(shards->acc);
+    hi_free(shards->slot_shard);
+    hi_free(shards->shard);
+    hi_free(shards);
+}
+
+void redisClusterAsyncShardsStop(redisClusterAsyncShards *shards) {
+#ifndef HAVE_SUBMIT
+    UNUSED(shards);
+#else
+    int i;
+
+    for (i = 0; i < shards->count; i++) {
+        ATOMIC_STORE(&shards->shard[i].stop, 1);
+        cluster_shards_wakeup(shards->acc[i]);
+    }
+#endif
+}
+
+/* Submit a formatted command, which is handed over, to the shard owning the
+ * slot of its first key. A command without keys goes to the first shard,
+ * which gives the error to the callback. */
+static int cluster_shards_submit(redisClusterAsyncShards *shards,
+                                 redisClusterCallbackFn *fn, void *privdata,
+                                 char *cmd, int len) {
+#ifndef HAVE_SUBMIT
+    UNUSED(shards);
+    UNUSED(fn);
+    UNUSED(privdata);
+    UNUSED(len);
+    hi_free(cmd);
+    return REDIS_ERR;
+#else
+    struct cmd *command;
+    struct keypos *kp;
+    int shard = 0;
+
+    command = command_get();
+    if (command == NULL) {
+        hi_free(cmd);
+        return REDIS_ERR;
+    }
+    command->cmd = cmd;
+    command->clen = len;
+    redis_parse_cmd(command);
+    if (command->result == CMD_PARSE_OK && hiarray_n(command->keys) > 0) {
+        kp = hiarray_get(command->keys, 0);
+        shard = ATOMIC_LOAD(&shards->slot_shard[keyHashSlot(
+            kp->start, kp->end - kp->start)]);
+    }
+    command->cmd = NULL; /* Buffer handed over to the shard */
+    command_destroy(command);
+
+    return cluster_submit(shards->acc[shard], fn, privdata, cmd, len);
+#endif
+}
+
+int redisClusterAsyncShardsSubmit(redisClusterAsyncShards *shards,
+                                  redisClusterCallbackFn *fn, void *privdata,
+                                  const char *format, ...) {
+    va_list ap;
+    char *cmd;
+    int len;
+
+    va_start(ap, format);
+    len = redisvFormatCommand(&cmd, format, ap);
+    va_end(ap);
+
+    if (len < 0) {
+        return REDIS_ERR;
+    }
+    return cluster_shards_submit(shards, fn, privdata, cmd, len);
+}
+
+int redisClusterAsyncShardsSubmitArgv(redisClusterAsyncShards *shards,
+                                      redisClusterCallbackFn *fn,
+                                      void *privdata, int argc,
+                                      const char **argv,
+                                      const size_t *argvlen) {
+    char *cmd;
+    int len;
+
+    len = redisFormatCommandArgv(&cmd, argc, argv, argvlen);
+    if (len < 0) {
+        return REDIS_ERR;
+    }
+    return cluster_shards_submit(shards, fn, privdata, cmd, len);
+}
+
+int redisClusterAsyncShardsSubmitFormatted(redisClusterAsyncShards *shards,
+                                           redisClusterCallbackFn *fn,
+                                           void *privdata, const char *cmd,
+                                           int len) {
+    char *copy;
+
+    copy = hi_malloc(len);
+    if (copy == NULL) {
+        return REDIS_ERR;
+    }
+    memcpy(copy, cmd, len);
+    return cluster_shards_submit(shards, fn, privdata, copy, len);
+}
+
 void redisClusterAsyncDisconnect(redisClusterAsyncContext *acc) {
     redisClusterContext *cc;
     redisAsyncContext *ac;
@@ -4463,8 +8025,20 @@ void redisClusterAsyncDisconnect(redisClusterAsyncContext *acc) {
         return;
     }
 
+#ifdef HAVE_SUBMIT
+    /* Send the commands submitted so far, to get their replies */
+    cluster_submit_stop(acc);
+#endif
+
     cc = acc->cc;
     cc->flags |= HIRCLUSTER_FLAG_SHUTDOWN;
+    cluster_async_retry_cancel(acc);
+
+    /* Write the commands waiting in cork mode, to get their replies */
+    if (acc->cork_timer != NULL) {
+        acc->timer_stop_fn(acc->cork_timer);
+        cluster_async_cork_timeout(acc);
+    }
 
     if (cc->nodes == NULL) {
         return;
@@ -4476,6 +8050,23 @@ void redisClusterAsyncDisconnect(redisClusterAsyncContext *acc) {
     while ((de = dictNext(&di)) != NULL) {
         node = dictGetEntryVal(de);
 
+        if (node->slaves != NULL) {
+            redisClusterNode *slave;
+            listNode *ln;
+
+            listIter li;
+            listRewind(node->slaves, &li);
+
+            while ((ln = listNext(&li)) != NULL) {
+                slave = listNodeValue(ln);
+                if (slave->acon != NULL) {
+                    redisAsyncDisconnect(slave->acon);
+                }
+                cluster_async_pool_disconnect(slave->async_pool);
+            }
+        }
+
+        cluster_async_pool_disconnect(node->async_pool);
         ac = node->acon;
 
         if (ac == NULL) {
@@ -4486,6 +8077,71 @@ void redisClusterAsyncDisconnect(redisClusterAsyncContext *acc) {
     }
 }
 
+void redisClusterAsyncGetCacheStats(redisClusterAsyncContext *acc,
+                                    redisClusterCacheStats *stats) {
+    hicache *cache = acc->cache;
+
+    memset(stats, 0, sizeof(*stats));
+    if (cache == NULL) {
+        return;
+    }
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->invalidations = cache->invalidations;
+    stats->evictions = cache->evictions;
+    stats->entries = dictSize(cache->entries);
+    stats->memory = cache->memory;
+}
+
+/* Add the commands in flight and the bytes waiting to be written on the
+ * connections of a node to the statistics. */
+static void cluster_async_node_stats(redisClusterNode *node,
+                                     redisClusterAsyncStats *stats) {
+    struct cluster_async_pool *pool = node->async_pool;
+    int i;
+
+    stats->inflight += node->inflight;
+    if (node->acon != NULL) {
+        stats->buffered += sdslen(node->acon->c.obuf);
+    }
+    for (i = 0; pool != NULL && i < pool->size - 1 + pool->nblocking; i++) {
+        if (pool->conns[i].ac != NULL) {
+            stats->buffered += sdslen(pool->conns[i].ac->c.obuf);
+        }
+    }
+    if (node->blocked) {
+        stats->blocked_nodes++;
+    }
+}
+
+void redisClusterAsyncGetStats(redisClusterAsyncContext *acc,
+                               redisClusterAsyncStats *stats) {
+    redisClusterNode *node;
+    dictEntry *de;
+    dictIterator di;
+    listNode *ln;
+    listIter li;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->rejected = acc->rejected;
+    stats->drains = acc->drains;
+    if (acc->cc->nodes == NULL) {
+        return;
+    }
+    dictInitIterator(&di, acc->cc->nodes);
+    while ((de = dictNext(&di)) != NULL) {
+        node = dictGetEntryVal(de);
+        cluster_async_node_stats(node, stats);
+        if (node->slaves == NULL) {
+            continue;
+        }
+        listRewind(node->slaves, &li);
+        while ((ln = listNext(&li)) != NULL) {
+            cluster_async_node_stats(listNodeValue(ln), stats);
+        }
+    }
+}
+
 void redisClusterAsyncFree(redisClusterAsyncContext *acc) {
     redisClusterContext *cc;
 
@@ -4495,8 +8151,29 @@ void redisClusterAsyncFree(redisClusterAsyncContext *acc) {
 
     cc = acc->cc;
     cc->flags |= HIRCLUSTER_FLAG_SHUTDOWN;
+    cluster_async_retry_cancel(acc);
+    if (acc->cork_timer != NULL) {
+        acc->timer_stop_fn(acc->cork_timer);
+    }
+#ifdef HAVE_SUBMIT
+    cluster_submit_free(acc);
+#endif
 
     redisClusterFree(cc);
+    hicache_free(acc->cache);
+
+    if (acc->deadlines != NULL) {
+        if (acc->deadlines->timer != NULL) {
+            acc->timer_stop_fn(acc->deadlines->timer);
+        }
+        hi_free(acc->deadlines);
+    }
+
+    while (acc->data_pool != NULL) {
+        cluster_async_data *cad = acc->data_pool;
+        acc->data_pool = cad->next_free;
+        hi_free(cad);
+    }
 
     hi_free(acc);
 }
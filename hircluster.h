@@ -52,8 +52,8 @@
 
 /* Configuration flags */
 #define HIRCLUSTER_FLAG_NULL 0x0
-/* Flag to enable parsing of slave nodes. Currently not used, but the
-   information is added to its master node structure. */
+/* Flag to enable parsing of slave nodes. The information is added to its
+   master node structure and used when a read policy is set. */
 #define HIRCLUSTER_FLAG_ADD_SLAVE 0x1000
 /* Flag to enable parsing of importing/migrating slots for master nodes.
  * Only applicable when 'cluster nodes' command is used for route updates. */
@@ -64,6 +64,30 @@
 /* Flag specific to the async API which means that the user requested a
  * client shutdown by a disconnect or free. */
 #define HIRCLUSTER_FLAG_SHUTDOWN 0x8000
+/* Flag specific to the async API to send blocking commands, like BLPOP, using
+ * dedicated connections. */
+#define HIRCLUSTER_FLAG_BLOCKING_CONNECTIONS 0x10000
+/* Flag to connect to all masters after each slotmap update, before sending
+ * the ready event. */
+#define HIRCLUSTER_FLAG_WARM_UP 0x20000
+/* Flag to also connect to replicas during the warm-up. */
+#define HIRCLUSTER_FLAG_WARM_UP_REPLICAS 0x40000
+/* Flag set on the context of an asynchronous client. */
+#define HIRCLUSTER_FLAG_ASYNC 0x80000
+
+/* Read policies, for redisClusterSetOptionReadPolicy() */
+#define HIRCLUSTER_READ_MASTER 0         /* Send all commands to masters */
+#define HIRCLUSTER_READ_PREFER_REPLICA 1 /* Read-only commands to replicas */
+#define HIRCLUSTER_READ_ROUND_ROBIN 2    /* Read-only commands to any node */
+#define HIRCLUSTER_READ_LEAST_LATENCY 3  /* Read-only commands to fastest */
+
+/* Connection selection, for redisClusterSetOptionConnectionPool() */
+#define HIRCLUSTER_POOL_LEAST_PENDING 0 /* Fewest commands waiting for reply */
+#define HIRCLUSTER_POOL_ROUND_ROBIN 1   /* Connections take turns */
+
+/* Error of an async command refused since its node has reached the limits set
+ * using redisClusterAsyncSetMaxInFlight() */
+#define REDIS_ERR_CLUSTER_WOULD_BLOCK 101
 
 /* Events, for redisClusterSetEventCallback() */
 #define HIRCLUSTER_EVENT_SLOTMAP_UPDATED 1
@@ -83,12 +107,33 @@ extern "C" {
 
 struct dict;
 struct hilist;
+struct cmd;
+struct cluster_async_data;
+struct redisClusterContext;
 struct redisClusterAsyncContext;
+struct cluster_async_pool;
+struct cluster_handshake_cmd;
+struct cluster_async_wheel;
+struct cluster_submit_queue;
+struct cluster_shard;
+struct redisClusterAsyncShards;
+struct hicache;
 
 typedef int(adapterAttachFn)(redisAsyncContext *, void *);
+typedef void(adapterTimerFn)(void *privdata);
+typedef void *(adapterTimerStartFn)(void *adapter, int64_t usec,
+                                    adapterTimerFn *fn, void *privdata);
+typedef void(adapterTimerStopFn)(void *timer);
+typedef void(adapterWatchFn)(void *privdata);
+typedef void *(adapterWatchStartFn)(void *adapter, int fd, adapterWatchFn *fn,
+                                    void *privdata);
+typedef void(adapterWatchStopFn)(void *watch);
 typedef int(sslInitFn)(redisContext *, void *);
 typedef void(redisClusterCallbackFn)(struct redisClusterAsyncContext *, void *,
                                      void *);
+typedef void(redisClusterDrainFn)(struct redisClusterAsyncContext *, void *);
+typedef void(redisClusterKeyReplyFn)(struct redisClusterContext *,
+                                     unsigned int, redisReply *, void *);
 typedef struct redisClusterNode {
     sds name;
     sds addr;
@@ -96,7 +141,7 @@ typedef struct redisClusterNode {
     uint16_t port;
     uint8_t role;
     uint8_t pad;
-    int failure_count; /* consecutive failing attempts in async */
+    int failure_count; /* Consecutive failing connection attempts */
     redisContext *con;
     redisAsyncContext *acon;
     int64_t lastConnectionAttempt; /* Timestamp */
@@ -104,6 +149,14 @@ typedef struct redisClusterNode {
     struct hilist *slaves;
     struct hiarray *migrating; /* copen_slot[] */
     struct hiarray *importing; /* copen_slot[] */
+    int64_t latency; /* Moving average of the response time in usec */
+    int inflight;    /* Number of async commands waiting for a reply */
+    int blocked;     /* Async commands refused due to the in-flight limits */
+    struct cluster_async_pool *async_pool; /* Additional async connections */
+    int64_t reconnect_after; /* No connection attempts before this time */
+    int64_t last_used;       /* Timestamp of the last command sent */
+    struct cmd *pipeline_head; /* Pipelined commands waiting for a reply */
+    struct cmd *pipeline_tail;
 } redisClusterNode;
 
 typedef struct cluster_slot {
@@ -149,6 +202,43 @@ typedef struct redisClusterContext {
                            void *privdata);
     void *event_privdata;
 
+    struct cmd *command_pool;    /* Unused commands kept for reuse */
+    unsigned int command_pool_n; /* Number of commands in the pool */
+
+    int read_policy;           /* Routing of read-only commands */
+    unsigned int read_counter; /* Selects the next replica to read from */
+
+    int pool_size;     /* Async connections per node */
+    int pool_dispatch; /* Selection of a connection in the pool */
+
+    int64_t reconnect_backoff_min; /* Delay after a failed connect, in usec */
+    int64_t reconnect_backoff_max; /* Max delay after repeated failures */
+
+    int64_t retry_backoff_min;      /* Delay before the first retry, in usec */
+    int64_t retry_backoff_max;      /* Max delay between retries */
+    int64_t retry_backoff_deadline; /* Max total delay of retries, or 0 */
+
+    int warm_up_pending; /* Connections opened by a warm-up, not yet ready */
+    int ready;           /* Set when the ready event has been sent */
+
+    int protocol;      /* RESP version requested using HELLO, or 0 */
+    char *client_name; /* Name set using CLIENT SETNAME, or NULL */
+    struct cluster_handshake_cmd *handshake_cmds; /* Extra handshake commands */
+    int handshake_ncmds;
+
+    size_t cache_max_memory; /* Size of the client-side cache, or 0 */
+
+    int64_t idle_timeout; /* Close connections unused this long, in usec */
+    int max_connections;  /* Max open connections before closing idle ones */
+    int64_t next_reap;    /* Time to look for idle connections */
+
+    long long pipeline_appended; /* Commands appended since the last reset */
+    long long pipeline_unclaimed; /* Replies received ahead of their turn */
+    void *pollset;       /* Nodes and pollfds for waiting on the pipeline */
+    size_t pollset_size; /* Number of nodes there is room for in the pollset */
+
+    struct redisClusterAsyncShards *shards; /* Sharded client, or NULL */
+
 } redisClusterContext;
 
 /* Context for accessing a Redis Cluster asynchronously */
@@ -173,8 +263,71 @@ typedef struct redisClusterAsyncContext {
     redisConnectCallbackNC *onConnectNC;
 #endif
 
+    struct cluster_async_data *data_pool; /* Unused callback data for reuse */
+    unsigned int data_pool_n;             /* Number of entries in the pool */
+
+    /* One-shot timers in the event loop, set by adapters supporting them. A
+     * started timer is released when it fires or is stopped. */
+    adapterTimerStartFn *timer_start_fn;
+    adapterTimerStopFn *timer_stop_fn;
+    struct cluster_async_data *delayed; /* Commands waiting for a retry */
+
+    struct hicache *cache; /* Client-side cache of replies */
+
+    int64_t command_deadline; /* Deadline given to sent commands, or 0 */
+    struct cluster_async_wheel *deadlines; /* Commands having a deadline */
+
+    size_t cork_max_bytes; /* Max size of deferred writes, or 0 if disabled */
+    void *cork_timer;      /* Timer writing the deferred commands, or NULL */
+
+    int max_inflight;    /* Max commands waiting for a reply per node, or 0 */
+    size_t max_buffered; /* Max bytes waiting to be written per node, or 0 */
+    redisClusterDrainFn *onDrain; /* Called when a busy node accepts again */
+    void *drain_privdata;
+    unsigned long long rejected; /* Commands refused due to the limits */
+    unsigned long long drains;   /* Times a busy node has accepted again */
+
+    /* Watch of a file descriptor becoming readable in the event loop, set by
+     * adapters supporting it. A started watch is kept until it is stopped. */
+    adapterWatchStartFn *watch_start_fn;
+    adapterWatchStopFn *watch_stop_fn;
+    struct cluster_submit_queue *submit_queue; /* Commands from any thread */
+
 } redisClusterAsyncContext;
 
+/* Max number of event loops of a sharded client */
+#define HIRCLUSTER_MAX_SHARDS 256
+
+/* Client using an async context per event loop, i.e. a shard. The first shard
+ * owns the slotmap and publishes it to the others. The nodes are spread over
+ * the shards and a command is submitted to the shard owning the node serving
+ * its slot. */
+typedef struct redisClusterAsyncShards {
+    int count;
+    redisClusterAsyncContext **acc; /* Context of each shard */
+    unsigned char *slot_shard; /* Owning shard per slot, read by any thread */
+    struct cluster_shard *shard; /* Slotmap handover and requests per shard */
+} redisClusterAsyncShards;
+
+/* Statistics of the client-side cache */
+typedef struct redisClusterCacheStats {
+    unsigned long long hits;          /* Replies served from the cache */
+    unsigned long long misses;        /* Cacheable commands sent to a node */
+    unsigned long long invalidations; /* Entries removed due to changes */
+    unsigned long long evictions;     /* Entries removed to make room */
+    size_t entries;                   /* Number of cached replies */
+    size_t memory;                    /* Memory used by the cache */
+} redisClusterCacheStats;
+
+/* Statistics of the commands sent using the asynchronous API */
+typedef struct redisClusterAsyncStats {
+    unsigned long long rejected; /* Commands refused due to the limits */
+    unsigned long long drains;   /* Times a busy node has accepted again */
+    long long inflight;          /* Commands waiting for a reply */
+    size_t buffered;             /* Bytes of commands not yet written */
+    int blocked_nodes;           /* Nodes currently refusing commands */
+} redisClusterAsyncStats;
+
 typedef struct redisClusterNodeIterator {
     redisClusterContext *cc;
     uint64_t route_version;
@@ -206,13 +359,96 @@ int redisClusterSetOptionUsername(redisClusterContext *cc,
                                   const char *username);
 int redisClusterSetOptionPassword(redisClusterContext *cc,
                                   const char *password);
+/* Select the RESP protocol version, 2 or 3, using HELLO on each connection. */
+int redisClusterSetOptionProtocol(redisClusterContext *cc, int protocol);
+/* Name each connection using CLIENT SETNAME. Disabled by NULL or "". */
+int redisClusterSetOptionClientName(redisClusterContext *cc, const char *name);
+/* Add a command, like "CLIENT TRACKING ON", sent on each new connection after
+ * AUTH, HELLO, CLIENT SETNAME and READONLY. All handshake commands are sent
+ * in a single write and a connection is only used when none of them fails.
+ * A NULL format removes the added commands. */
+int redisClusterSetOptionHandshakeCommand(redisClusterContext *cc,
+                                          const char *format, ...);
+/* Keep the replies to read commands of a single key, like GET and HGET, in a
+ * client-side cache of up to `max_memory` bytes in the asynchronous API. The
+ * connections use RESP3 and CLIENT TRACKING, and the cached replies are
+ * invalidated when the keys are changed, when the connection they were read
+ * on is lost, or when their slot moves to another node. Must be set before
+ * connecting. Disabled by 0. */
+int redisClusterSetOptionClientCache(redisClusterContext *cc,
+                                     size_t max_memory);
 int redisClusterSetOptionParseSlaves(redisClusterContext *cc);
 int redisClusterSetOptionParseOpenSlots(redisClusterContext *cc);
 int redisClusterSetOptionRouteUseSlots(redisClusterContext *cc);
+/* Send read-only commands to the replicas of the master serving the slot.
+ * With HIRCLUSTER_READ_PREFER_REPLICA the replicas take turns and the master
+ * is only used when no replica is reachable. With HIRCLUSTER_READ_ROUND_ROBIN
+ * the master and its replicas take turns. With HIRCLUSTER_READ_LEAST_LATENCY
+ * the node with the lowest response time is preferred, based on the moving
+ * average of the response times and the number of commands waiting for a
+ * reply on each node. Connections to replicas are put in read-only mode
+ * using READONLY. This enables parsing of replicas and applies to blocking and
+ * asynchronous commands, but not to pipelined commands. */
+int redisClusterSetOptionReadPolicy(redisClusterContext *cc, int policy);
+/* Use a pool of `size` connections to each node in the asynchronous API, so
+ * that a large reply only delays the commands sent on the same connection.
+ * Commands are sent on the connection with the fewest commands waiting for a
+ * reply using HIRCLUSTER_POOL_LEAST_PENDING, or on each connection in turn
+ * using HIRCLUSTER_POOL_ROUND_ROBIN. Connections are opened when needed. */
+int redisClusterSetOptionConnectionPool(redisClusterContext *cc, int size,
+                                        int dispatch);
+/* Send blocking commands, like BLPOP and XREAD, on dedicated connections in
+ * the asynchronous API so that they don't delay other commands. The number of
+ * such connections per node is the size of the connection pool. */
+int redisClusterSetOptionBlockingConnections(redisClusterContext *cc);
+/* Connect to all masters after each slotmap update, and to their replicas when
+ * `replicas` is set, so that the first commands to each node don't wait for
+ * the connect and authentication. The HIRCLUSTER_EVENT_READY event is sent
+ * when the initial connections are done, successful or not. The asynchronous
+ * API connects to all nodes concurrently, but needs the initial slotmap to be
+ * fetched using redisClusterAsyncConnect2(). */
+int redisClusterSetOptionWarmUp(redisClusterContext *cc, int replicas);
+/* Close the connections to a node that hasn't been used for the given time.
+ * The connections are reopened when needed. Idle connections are looked for
+ * when sending commands. Disabled by zero, which is the default. */
+int redisClusterSetOptionIdleTimeout(redisClusterContext *cc,
+                                     const struct timeval tv);
+/* Limit the number of open connections by closing the connections to the
+ * least recently used node before opening a new connection. Connections with
+ * commands waiting for a reply are not closed, so the limit can be exceeded
+ * when all connections are in use. Disabled by zero, which is the default. */
+int redisClusterSetOptionMaxConnections(redisClusterContext *cc, int max);
+/* Wait before connecting again to a node after a failed connection attempt,
+ * instead of paying the connect timeout on each command sent to the node.
+ * Meanwhile commands to the node fail immediately, or are sent to the master
+ * if the node is a replica. The delay starts at `min` and is doubled for each
+ * consecutive failure, up to `max`, and is randomly reduced by up to a half to
+ * spread out reconnects. A `min` of zero disables the delay, which is the
+ * default, e.g. 100 milliseconds to 10 seconds can be used. Only used by the
+ * synchronous API. */
+int redisClusterSetOptionReconnectBackoff(redisClusterContext *cc,
+                                          const struct timeval min,
+                                          const struct timeval max);
+/* Wait before retrying a command that got a TRYAGAIN or CLUSTERDOWN reply,
+ * which are returned while slots are migrated or during a failover. The delay
+ * starts at `min` and is doubled for each retry of the command, up to `max`,
+ * and is randomly reduced by up to a half. The command fails when the total
+ * delay would exceed `deadline`, unless zero, or after the max number of
+ * retries. A `min` of zero disables the delay, which is the default, e.g. 10
+ * milliseconds to 1 second can be used. The synchronous API blocks during the
+ * delay. The asynchronous API needs an adapter supporting timers, otherwise
+ * commands are retried immediately. */
+int redisClusterSetOptionRetryBackoff(redisClusterContext *cc,
+                                      const struct timeval min,
+                                      const struct timeval max,
+                                      const struct timeval deadline);
 int redisClusterSetOptionConnectTimeout(redisClusterContext *cc,
                                         const struct timeval tv);
 int redisClusterSetOptionTimeout(redisClusterContext *cc,
                                  const struct timeval tv);
+/* Max number of retries of a command after a redirect or a temporary cluster
+ * error. A value of 0 disables retries, which also avoids keeping a copy of
+ * each asynchronous command for resending it. */
 int redisClusterSetOptionMaxRetry(redisClusterContext *cc, int max_retry_count);
 /* Deprecated function, replaced with redisClusterSetOptionMaxRetry() */
 void redisClusterSetMaxRedirect(redisClusterContext *cc,
@@ -257,6 +493,25 @@ void *redisClusterCommandArgv(redisClusterContext *cc, int argc,
 /* Send a Redis protocol encoded string */
 void *redisClusterFormattedCommand(redisClusterContext *cc, char *cmd, int len);
 
+/* Streaming
+ * Like the blocking functions above, but each reply is handed to `fn` as soon
+ * as it arrives instead of being returned. A MGET with keys on several nodes
+ * is delivered one key at a time, as each node answers, with `index` being
+ * the position of the key in the command. Other commands give a single reply
+ * with index 0. The callback takes ownership of the reply.
+ *
+ * Returns REDIS_ERR and sets `cc->err` on failures, including error replies.
+ */
+int redisClusterCommandStream(redisClusterContext *cc,
+                              redisClusterKeyReplyFn *fn, void *privdata,
+                              const char *format, ...);
+int redisClustervCommandStream(redisClusterContext *cc,
+                               redisClusterKeyReplyFn *fn, void *privdata,
+                               const char *format, va_list ap);
+int redisClusterFormattedCommandStream(redisClusterContext *cc,
+                                       redisClusterKeyReplyFn *fn,
+                                       void *privdata, char *cmd, int len);
+
 /* Pipelining
  * The following functions will write a command to the output buffer.
  * A call to `redisClusterGetReply()` will flush all commands in the output
@@ -282,10 +537,25 @@ int redisClusterAppendFormattedCommand(redisClusterContext *cc, char *cmd,
                                        int len);
 /* Flush output buffer and return first reply */
 int redisClusterGetReply(redisClusterContext *cc, void **reply);
+/* Flush output buffers and return the first reply received from any node.
+ * `index` is set to the position of the command in the pipeline, counted from
+ * 0 since the last reset. `reply` is set to NULL when all replies are read. */
+int redisClusterGetAnyReply(redisClusterContext *cc, void **reply,
+                            long long *index);
 
 /* Reset context after a performed pipelining */
 void redisClusterReset(redisClusterContext *cc);
 
+/* Batch execution
+ * Sends `n` commands, each given by argc, argv and argvlen like for
+ * redisClusterCommandArgv(), to their nodes at once and waits for all replies,
+ * following redirects. The replies are returned in the `replies` array in the
+ * order of the commands and are freed by the caller. On error no replies are
+ * returned and the connections with unread replies are closed. */
+int redisClusterExecBatch(redisClusterContext *cc, int n, const int *argcs,
+                          const char **argvs[], const size_t *argvlens[],
+                          redisReply **replies);
+
 /* Update the slotmap by querying any node. */
 int redisClusterUpdateSlotmap(redisClusterContext *cc);
 
@@ -315,6 +585,44 @@ redisClusterAsyncContext *redisClusterAsyncConnect(const char *addrs,
 int redisClusterAsyncConnect2(redisClusterAsyncContext *acc);
 void redisClusterAsyncDisconnect(redisClusterAsyncContext *acc);
 
+/* Limit the commands waiting for a reply per node to `max_commands`, and the
+ * bytes of the commands waiting to be written per node to `max_bytes`, to
+ * bound the memory used when a node is slow or unreachable. A command to a
+ * node at either limit is refused with the error REDIS_ERR_CLUSTER_WOULD_BLOCK
+ * and the drain callback is called when the node is below the limits again.
+ * Retries after redirects are not limited. Zero disables a limit, which is the
+ * default. */
+int redisClusterAsyncSetMaxInFlight(redisClusterAsyncContext *acc,
+                                    int max_commands, size_t max_bytes);
+int redisClusterAsyncSetDrainCallback(redisClusterAsyncContext *acc,
+                                      redisClusterDrainFn *fn, void *privdata);
+
+/* Get the statistics of the commands in flight and the refused commands. */
+void redisClusterAsyncGetStats(redisClusterAsyncContext *acc,
+                               redisClusterAsyncStats *stats);
+
+/* Cork mode: defer the writes of the commands sent in an event loop iteration
+ * to the next iteration, so that the commands sent to a connection are written
+ * using a single system call. A connection is instead written as usual when
+ * its output buffer reaches `max_bytes`. Reduces the number of system calls
+ * when many commands are sent per iteration. Disabled by zero, which is the
+ * default. Needs an adapter supporting timers. */
+int redisClusterAsyncSetCork(redisClusterAsyncContext *acc, size_t max_bytes);
+
+/* Fail the commands sent after this call that haven't got a reply within the
+ * given time, including the time spent on retries after redirects, TRYAGAIN
+ * and CLUSTERDOWN. Only the expired command fails, with the error
+ * REDIS_ERR_TIMEOUT, and its reply is discarded when it arrives later. Unlike
+ * the timeout given by redisClusterSetOptionTimeout(), the connection is kept.
+ * Disabled by zero, which is the default. Needs an adapter supporting timers.
+ */
+int redisClusterAsyncSetCommandDeadline(redisClusterAsyncContext *acc,
+                                        const struct timeval tv);
+
+/* Get the statistics of the client-side cache. */
+void redisClusterAsyncGetCacheStats(redisClusterAsyncContext *acc,
+                                    redisClusterCacheStats *stats);
+
 /* Commands */
 int redisClusterAsyncCommand(redisClusterAsyncContext *acc,
                              redisClusterCallbackFn *fn, void *privdata,
@@ -346,6 +654,69 @@ int redisClusterAsyncFormattedCommandToNode(redisClusterAsyncContext *acc,
                                             redisClusterCallbackFn *fn,
                                             void *privdata, char *cmd, int len);
 
+/* Let any thread submit commands, which are sent from the event loop thread.
+ * The event loop is woken up using a pipe watched by the adapter. To be called
+ * from the event loop thread after attaching the adapter. Other threads may
+ * submit commands once this has returned REDIS_OK, and until the context is
+ * freed, which the application orders with the submitting threads. Returns
+ * REDIS_ERR with `acc->err` set when not supported: on Windows, and with
+ * compilers lacking the atomic builtins of GCC and Clang. */
+int redisClusterAsyncEnableSubmit(redisClusterAsyncContext *acc);
+
+/* Submit a command from any thread, see redisClusterAsyncEnableSubmit() for
+ * when it is allowed. The command is sent, and the callback is called, from the
+ * event loop thread. Since `acc` is only accessed from the
+ * event loop thread, a failure to send the command is given to the callback as
+ * a NULL reply with `acc->err` set. Commands submitted after
+ * redisClusterAsyncDisconnect() fail when the context is freed. Returns
+ * REDIS_ERR, without setting `acc->err`, when submitting is not enabled, out
+ * of memory or the command can't be formatted. */
+int redisClusterAsyncSubmit(redisClusterAsyncContext *acc,
+                            redisClusterCallbackFn *fn, void *privdata,
+                            const char *format, ...);
+int redisClusterAsyncSubmitArgv(redisClusterAsyncContext *acc,
+                                redisClusterCallbackFn *fn, void *privdata,
+                                int argc, const char **argv,
+                                const size_t *argvlen);
+int redisClusterAsyncSubmitFormatted(redisClusterAsyncContext *acc,
+                                     redisClusterCallbackFn *fn,
+                                     void *privdata, const char *cmd, int len);
+
+/* Create a sharded client with `count` async contexts, to run in one event
+ * loop thread each, started by the application. The options are set on the
+ * context of each shard. In its thread, each context is attached to its event
+ * loop and submitting is enabled using redisClusterAsyncEnableSubmit() before
+ * connecting. Only the first shard fetches the slotmap from the cluster, and
+ * it hands a copy over to the other shards, which connect without contacting
+ * the cluster. A redirect received by another shard requests a slotmap update
+ * from the first shard. The masters are spread over the shards, and a shard
+ * closes its idle connections to the nodes of other shards. Until the first
+ * shard gets the slotmap, all commands go to it. Returns NULL when out of
+ * memory, or when submitting commands is not supported. */
+redisClusterAsyncShards *redisClusterAsyncShardsInit(int count);
+/* Disconnect all shards from their event loop threads, after sending the
+ * commands submitted so far. The event loops then run until the replies are
+ * received and the connections are closed. Can be called from any thread. */
+void redisClusterAsyncShardsStop(redisClusterAsyncShards *shards);
+/* Free the contexts of all shards, after their event loops have stopped. */
+void redisClusterAsyncShardsFree(redisClusterAsyncShards *shards);
+
+/* Submit a command from any thread to the shard owning the node serving the
+ * slot of its first key. The callback is called from the event loop thread of
+ * the shard, with its context. Returns as redisClusterAsyncSubmit(). */
+int redisClusterAsyncShardsSubmit(redisClusterAsyncShards *shards,
+                                  redisClusterCallbackFn *fn, void *privdata,
+                                  const char *format, ...);
+int redisClusterAsyncShardsSubmitArgv(redisClusterAsyncShards *shards,
+                                      redisClusterCallbackFn *fn,
+                                      void *privdata, int argc,
+                                      const char **argv,
+                                      const size_t *argvlen);
+int redisClusterAsyncShardsSubmitFormatted(redisClusterAsyncShards *shards,
+                                           redisClusterCallbackFn *fn,
+                                           void *privdata, const char *cmd,
+                                           int len);
+
 /* Internal functions */
 redisAsyncContext *actx_get_by_node(redisClusterAsyncContext *acc,
                                     redisClusterNode *node);
@@ -27,6 +27,173 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include "hircluster_ssl.h"
+#include "dict.h"
+
+#include <hiredis/alloc.h>
+#include <hiredis/sds.h>
+#include <openssl/ssl.h>
+#include <stdio.h>
+#include <string.h>
+
+struct redisClusterSSLSessionCache {
+    SSL_CTX *ssl_ctx;
+    char *server_name;
+    dict *sessions; /* "host:port" to SSL_SESSION */
+    unsigned long long full_handshakes;
+    unsigned long long resumed_handshakes;
+};
+
+/* Attached to each SSL object created using the session cache. */
+struct sslConnection {
+    redisClusterSSLSessionCache *cache;
+    sds addr;
+    int handshake_done;
+};
+
+/* Callbacks of an SSL_CTX from before a session cache was created from it,
+ * which are called by the callbacks of the cache. Attached to the SSL_CTX,
+ * since caches created from the same SSL_CTX share the callbacks. */
+struct sslContextCallbacks {
+    int (*new_session_cb)(SSL *ssl, SSL_SESSION *session);
+    void (*info_cb)(const SSL *ssl, int where, int ret);
+};
+
+static CRYPTO_ONCE ssl_index_once = CRYPTO_ONCE_STATIC_INIT;
+static int ssl_connection_index = -1;
+static int ssl_context_index = -1;
+
+static unsigned int dictSdsHash(const void *key) {
+    return dictGenHashFunction((const unsigned char *)key,
+                               sdslen((const sds)key));
+}
+
+static int dictSdsKeyCompare(void *privdata, const void *key1,
+                             const void *key2) {
+    DICT_NOTUSED(privdata);
+    return sdslen((const sds)key1) == sdslen((const sds)key2) &&
+           memcmp(key1, key2, sdslen((const sds)key1)) == 0;
+}
+
+static void dictSdsDestructor(void *privdata, void *val) {
+    DICT_NOTUSED(privdata);
+    sdsfree(val);
+}
+
+static void dictSessionDestructor(void *privdata, void *val) {
+    DICT_NOTUSED(privdata);
+    SSL_SESSION_free(val);
+}
+
+static dictType sslSessionsDictType = {
+    dictSdsHash,          /* hash function */
+    NULL,                 /* key dup */
+    NULL,                 /* val dup */
+    dictSdsKeyCompare,    /* key compare */
+    dictSdsDestructor,    /* key destructor */
+    dictSessionDestructor /* val destructor */
+};
+
+static void sslConnectionFree(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+                              int idx, long argl, void *argp) {
+    struct sslConnection *conn = ptr;
+    (void)parent;
+    (void)ad;
+    (void)idx;
+    (void)argl;
+    (void)argp;
+
+    if (conn != NULL) {
+        sdsfree(conn->addr);
+        hi_free(conn);
+    }
+}
+
+static void sslContextCallbacksFree(void *parent, void *ptr,
+                                    CRYPTO_EX_DATA *ad, int idx, long argl,
+                                    void *argp) {
+    (void)parent;
+    (void)ad;
+    (void)idx;
+    (void)argl;
+    (void)argp;
+
+    hi_free(ptr);
+}
+
+static void sslInitIndexes(void) {
+    ssl_connection_index =
+        SSL_get_ex_new_index(0, NULL, NULL, NULL, sslConnectionFree);
+    ssl_context_index =
+        SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, sslContextCallbacksFree);
+}
+
+static struct sslContextCallbacks *sslGetContextCallbacks(const SSL *ssl) {
+    return SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ssl_context_index);
+}
+
+/* Store a session received on a connection, replacing the last session of
+ * the node address. The cache holds a copy of the session, since OpenSSL marks
+ * the session of a connection which is freed without a TLS shutdown, as done
+ * by hiredis, as not resumable. */
+static void sslStoreSession(struct sslConnection *conn,
+                            SSL_SESSION *session) {
+    dictEntry *de;
+    sds addr;
+
+    session = SSL_SESSION_dup(session);
+    if (session == NULL) {
+        return; /* Not resumed when out of memory */
+    }
+    de = dictFind(conn->cache->sessions, conn->addr);
+    if (de != NULL) {
+        SSL_SESSION_free(dictGetEntryVal(de));
+        dictGetEntryVal(de) = session;
+        return;
+    }
+    addr = sdsdup(conn->addr);
+    if (addr == NULL) {
+        SSL_SESSION_free(session);
+        return;
+    }
+    if (dictAdd(conn->cache->sessions, addr, session) != DICT_OK) {
+        sdsfree(addr);
+        SSL_SESSION_free(session);
+    }
+}
+
+/* Called by OpenSSL when a session, or a TLSv1.3 ticket, is received. The
+ * reference of the session is left to the callback set before, if any. */
+static int sslSessionNewCallback(SSL *ssl, SSL_SESSION *session) {
+    struct sslConnection *conn = SSL_get_ex_data(ssl, ssl_connection_index);
+    struct sslContextCallbacks *callbacks = sslGetContextCallbacks(ssl);
+
+    if (conn != NULL) {
+        sslStoreSession(conn, session);
+    }
+    if (callbacks != NULL && callbacks->new_session_cb != NULL) {
+        return callbacks->new_session_cb(ssl, session);
+    }
+    return 0;
+}
+
+static void sslInfoCallback(const SSL *ssl, int where, int ret) {
+    struct sslConnection *conn = SSL_get_ex_data(ssl, ssl_connection_index);
+    struct sslContextCallbacks *callbacks = sslGetContextCallbacks(ssl);
+
+    /* Called again for post-handshake messages in TLSv1.3 */
+    if ((where & SSL_CB_HANDSHAKE_DONE) && conn != NULL &&
+        !conn->handshake_done) {
+        conn->handshake_done = 1;
+        if (SSL_session_reused((SSL *)ssl)) {
+            conn->cache->resumed_handshakes++;
+        } else {
+            conn->cache->full_handshakes++;
+        }
+    }
+    if (callbacks != NULL && callbacks->info_cb != NULL) {
+        callbacks->info_cb(ssl, where, ret);
+    }
+}
 
 static int redisClusterInitiateSSLWithContext(redisContext *c,
                                               void *redis_ssl_ctx) {
@@ -44,3 +211,163 @@ int redisClusterSetOptionEnableSSL(redisClusterContext *cc,
 
     return REDIS_OK;
 }
+
+redisClusterSSLSessionCache *
+redisClusterCreateSSLSessionCache(struct ssl_ctx_st *ssl_ctx,
+                                  const char *server_name) {
+    struct sslContextCallbacks *callbacks;
+    redisClusterSSLSessionCache *cache;
+
+    if (ssl_ctx == NULL) {
+        return NULL;
+    }
+    if (!CRYPTO_THREAD_run_once(&ssl_index_once, sslInitIndexes) ||
+        ssl_connection_index < 0 || ssl_context_index < 0) {
+        return NULL;
+    }
+
+    cache = hi_calloc(1, sizeof(*cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->sessions = dictCreate(&sslSessionsDictType, NULL);
+    if (cache->sessions == NULL) {
+        goto error;
+    }
+    if (server_name != NULL) {
+        cache->server_name = hi_strdup(server_name);
+        if (cache->server_name == NULL) {
+            goto error;
+        }
+    }
+
+    /* Sessions are stored per node address by the callback, since the
+     * internal cache of OpenSSL is shared by all servers. The callbacks are
+     * installed once per SSL_CTX and call the callbacks set before. */
+    if (SSL_CTX_get_ex_data(ssl_ctx, ssl_context_index) == NULL) {
+        callbacks = hi_calloc(1, sizeof(*callbacks));
+        if (callbacks == NULL) {
+            goto error;
+        }
+        callbacks->new_session_cb = SSL_CTX_sess_get_new_cb(ssl_ctx);
+        callbacks->info_cb = SSL_CTX_get_info_callback(ssl_ctx);
+        if (!SSL_CTX_set_ex_data(ssl_ctx, ssl_context_index, callbacks)) {
+            hi_free(callbacks);
+            goto error;
+        }
+        SSL_CTX_set_session_cache_mode(
+            ssl_ctx,
+            SSL_CTX_get_session_cache_mode(ssl_ctx) | SSL_SESS_CACHE_CLIENT);
+        SSL_CTX_sess_set_new_cb(ssl_ctx, sslSessionNewCallback);
+        SSL_CTX_set_info_callback(ssl_ctx, sslInfoCallback);
+    }
+    SSL_CTX_up_ref(ssl_ctx);
+    cache->ssl_ctx = ssl_ctx;
+    return cache;
+
+error:
+    redisClusterFreeSSLSessionCache(cache);
+    return NULL;
+}
+
+void redisClusterFreeSSLSessionCache(redisClusterSSLSessionCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    if (cache->sessions != NULL) {
+        dictRelease(cache->sessions);
+    }
+    hi_free(cache->server_name);
+    SSL_CTX_free(cache->ssl_ctx);
+    hi_free(cache);
+}
+
+void redisClusterGetSSLSessionStats(redisClusterSSLSessionCache *cache,
+                                    redisClusterSSLSessionStats *stats) {
+    stats->full_handshakes = cache->full_handshakes;
+    stats->resumed_handshakes = cache->resumed_handshakes;
+    stats->sessions = dictSize(cache->sessions);
+}
+
+static void sslSetError(redisContext *c, const char *str) {
+    c->err = REDIS_ERR_OTHER;
+    snprintf(c->errstr, sizeof(c->errstr), "%s", str);
+}
+
+/* Create the SSL object of a node connection, resuming the last session of
+ * the node address when there is one. */
+static int redisClusterInitiateSSLWithSessionCache(redisContext *c,
+                                                   void *privdata) {
+    redisClusterSSLSessionCache *cache = privdata;
+    struct sslConnection *conn;
+    SSL_SESSION *session;
+    dictEntry *de;
+    SSL *ssl;
+
+    ssl = SSL_new(cache->ssl_ctx);
+    if (ssl == NULL) {
+        sslSetError(c, "Couldn't create new SSL instance");
+        return REDIS_ERR;
+    }
+    if (cache->server_name != NULL &&
+        !SSL_set_tlsext_host_name(ssl, cache->server_name)) {
+        sslSetError(c, "Failed to set server_name/SNI");
+        goto error;
+    }
+
+    conn = hi_calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+        goto oom;
+    }
+    conn->cache = cache;
+    conn->addr = sdsempty();
+    if (conn->addr != NULL) {
+        conn->addr =
+            sdscatfmt(conn->addr, "%s:%i", c->tcp.host, c->tcp.port);
+    }
+    if (conn->addr == NULL ||
+        !SSL_set_ex_data(ssl, ssl_connection_index, conn)) {
+        sdsfree(conn->addr);
+        hi_free(conn);
+        goto oom;
+    }
+
+    de = dictFind(cache->sessions, conn->addr);
+    if (de != NULL) {
+        session = dictGetEntryVal(de);
+        if (SSL_SESSION_is_resumable(session)) {
+            /* A copy, for the same reason as when storing the session */
+            session = SSL_SESSION_dup(session);
+            if (session == NULL) {
+                goto oom;
+            }
+            SSL_set_session(ssl, session);
+            SSL_SESSION_free(session);
+        } else {
+            dictDelete(cache->sessions, conn->addr);
+        }
+    }
+
+    if (redisInitiateSSL(c, ssl) != REDIS_OK) {
+        goto error; /* Error set by hiredis */
+    }
+    return REDIS_OK;
+
+oom:
+    sslSetError(c, "Out of memory");
+error:
+    SSL_free(ssl);
+    return REDIS_ERR;
+}
+
+int redisClusterSetOptionEnableSSLSessionCache(
+    redisClusterContext *cc, redisClusterSSLSessionCache *cache) {
+    if (cc == NULL || cache == NULL) {
+        return REDIS_ERR;
+    }
+
+    cc->ssl = cache;
+    cc->ssl_init_fn = &redisClusterInitiateSSLWithSessionCache;
+
+    return REDIS_OK;
+}
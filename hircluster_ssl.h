@@ -32,6 +32,9 @@
 #include "hircluster.h"
 #include <hiredis/hiredis_ssl.h>
 
+/* For OpenSSL's SSL_CTX. */
+struct ssl_ctx_st;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,6 +45,42 @@ extern "C" {
 int redisClusterSetOptionEnableSSL(redisClusterContext *cc,
                                    redisSSLContext *ssl);
 
+/**
+ * A cache of TLS sessions per node address, used to resume the session when
+ * reconnecting to a node instead of doing a full TLS handshake. It is created
+ * from an OpenSSL client context and an optional server name to use for SNI.
+ * The cache can be shared by cluster contexts used in the same thread, and
+ * must be freed after them.
+ *
+ * The first cache created from an OpenSSL context adds SSL_SESS_CACHE_CLIENT
+ * to its session cache mode and installs a new session callback and an info
+ * callback on it. These call the callbacks which were set before, so they are
+ * still called for all connections. Callbacks set on the OpenSSL context
+ * after creating a cache replace the callbacks of the cache, which stops
+ * caching sessions and counting handshakes.
+ */
+typedef struct redisClusterSSLSessionCache redisClusterSSLSessionCache;
+
+typedef struct redisClusterSSLSessionStats {
+    unsigned long long full_handshakes;    /* Handshakes creating a session */
+    unsigned long long resumed_handshakes; /* Handshakes resuming a session */
+    size_t sessions;                       /* Number of cached sessions */
+} redisClusterSSLSessionStats;
+
+redisClusterSSLSessionCache *
+redisClusterCreateSSLSessionCache(struct ssl_ctx_st *ssl_ctx,
+                                  const char *server_name);
+void redisClusterFreeSSLSessionCache(redisClusterSSLSessionCache *cache);
+void redisClusterGetSSLSessionStats(redisClusterSSLSessionCache *cache,
+                                    redisClusterSSLSessionStats *stats);
+
+/**
+ * Configuration option to enable SSL/TLS negotiation on a context, resuming
+ * the cached TLS sessions.
+ */
+int redisClusterSetOptionEnableSSLSessionCache(
+    redisClusterContext *cc, redisClusterSSLSessionCache *cache);
+
 #ifdef __cplusplus
 }
 #endif
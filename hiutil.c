@@ -40,6 +40,7 @@
 #ifndef _WIN32
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #endif
@@ -401,3 +402,23 @@ int64_t hi_usec_now(void) {
  * Return the current time in milliseconds since Epoch
  */
 int64_t hi_msec_now(void) { return hi_usec_now() / 1000LL; }
+
+/*
+ * Block until the given time in microseconds, as returned by hi_usec_now()
+ */
+void hi_usec_wait_until(int64_t usec) {
+    int64_t left;
+
+    while ((left = usec - hi_usec_now()) > 0) {
+#ifdef _WIN32
+        Sleep((DWORD)((left + 999) / 1000));
+#else
+        struct timeval tv;
+
+        tv.tv_sec = (time_t)(left / 1000000);
+        tv.tv_usec = (suseconds_t)(left % 1000000);
+        /* Returns early when interrupted by a signal */
+        select(0, NULL, NULL, NULL, &tv);
+#endif
+    }
+}
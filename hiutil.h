@@ -175,6 +175,7 @@ void hi_stacktrace_fd(int fd);
 
 int64_t hi_usec_now(void);
 int64_t hi_msec_now(void);
+void hi_usec_wait_until(int64_t usec);
 
 uint16_t crc16(const char *buf, int len);
 
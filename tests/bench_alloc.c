@@ -0,0 +1,207 @@
+/*
+ * Benchmark of the number of memory allocations per command.
+ *
+ * Runs commands using the synchronous and the asynchronous API against an
+ * in-process stand-in cluster and reports the number of allocations made per
+ * command and the number of bytes allocated, including the allocations made by
+ * hiredis for requests and replies.
+ *
+ * Usage: bench_alloc [commands]
+ */
+#include "adapters/libevent.h"
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PORT 7800
+#define BENCH_NODES 3
+#define PIPELINE_DEPTH 100
+#define LARGE_VALUE_SIZE 16384
+
+static long long allocations = 0;
+static long long allocated_bytes = 0;
+
+static void *countingMalloc(size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    return malloc(size);
+}
+
+static void *countingCalloc(size_t nmemb, size_t size) {
+    allocations++;
+    allocated_bytes += nmemb * size;
+    return calloc(nmemb, size);
+}
+
+static void *countingRealloc(void *ptr, size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    return realloc(ptr, size);
+}
+
+static char *countingStrdup(const char *str) {
+    allocations++;
+    allocated_bytes += strlen(str) + 1;
+    return strdup(str);
+}
+
+static void resetCounters(void) {
+    allocations = 0;
+    allocated_bytes = 0;
+}
+
+static void report(const char *name, int commands, int64_t elapsed) {
+    printf("%-22s %10d %14.2f %14.0f %14.2f\n", name, commands,
+           (double)allocations / commands, (double)allocated_bytes / commands,
+           (double)elapsed / commands);
+}
+
+static void bench_sync(redisClusterContext *cc, const char *name,
+                       const char *cmd, int commands) {
+    redisReply *reply;
+
+    /* Warm up to create connections and fill any caches */
+    reply = redisClusterCommand(cc, cmd);
+    ASSERT_MSG(reply != NULL, cc->errstr);
+    freeReplyObject(reply);
+
+    resetCounters();
+    int64_t start = benchUsecNow();
+    for (int i = 0; i < commands; i++) {
+        reply = redisClusterCommand(cc, cmd);
+        ASSERT_MSG(reply != NULL, cc->errstr);
+        freeReplyObject(reply);
+    }
+    report(name, commands, benchUsecNow() - start);
+}
+
+static void bench_pipeline(redisClusterContext *cc, const char *name,
+                           const char *cmd, int commands) {
+    redisReply *reply;
+    int sent = 0, received = 0;
+
+    resetCounters();
+    int64_t start = benchUsecNow();
+    while (received < commands) {
+        for (; sent < commands && sent - received < PIPELINE_DEPTH; sent++) {
+            int status = redisClusterAppendCommand(cc, cmd);
+            ASSERT_MSG(status == REDIS_OK, cc->errstr);
+        }
+        for (; received < sent; received++) {
+            int status = redisClusterGetReply(cc, (void **)&reply);
+            ASSERT_MSG(status == REDIS_OK, cc->errstr);
+            freeReplyObject(reply);
+        }
+        redisClusterReset(cc);
+    }
+    report(name, commands, benchUsecNow() - start);
+}
+
+typedef struct asyncState {
+    struct event_base *base;
+    int sent;
+    int received;
+} asyncState;
+
+static void asyncCallback(redisClusterAsyncContext *acc, void *r,
+                          void *privdata) {
+    asyncState *state = privdata;
+    redisReply *reply = r;
+    ASSERT_MSG(reply != NULL, acc->errstr);
+
+    if (++state->received == state->sent) {
+        event_base_loopbreak(state->base);
+    }
+}
+
+static void bench_async(redisClusterAsyncContext *acc, struct event_base *base,
+                        const char *name, const char *cmd, int commands) {
+    asyncState state = {.base = base};
+    int total = 0;
+
+    /* Warm up to create connections and fill any caches */
+    int status = redisClusterAsyncCommand(acc, asyncCallback, &state, cmd);
+    ASSERT_MSG(status == REDIS_OK, acc->errstr);
+    state.sent++;
+    event_base_dispatch(base);
+
+    resetCounters();
+    int64_t start = benchUsecNow();
+    while (total < commands) {
+        state.sent = state.received = 0;
+        for (; state.sent < PIPELINE_DEPTH && total < commands; total++) {
+            status = redisClusterAsyncCommand(acc, asyncCallback, &state, cmd);
+            ASSERT_MSG(status == REDIS_OK, acc->errstr);
+            state.sent++;
+        }
+        event_base_dispatch(base);
+    }
+    report(name, commands, benchUsecNow() - start);
+}
+
+int main(int argc, char **argv) {
+    int commands = argc > 1 ? atoi(argv[1]) : 100000;
+    char addr[32];
+
+    /* A SET command with a large value, e.g. "SET key xxx..." */
+    char *large_set = malloc(LARGE_VALUE_SIZE + 9);
+    assert(large_set);
+    memcpy(large_set, "SET key ", 8);
+    memset(large_set + 8, 'x', LARGE_VALUE_SIZE);
+    large_set[LARGE_VALUE_SIZE + 8] = '\0';
+
+    hiredisAllocFuncs ha = {
+        .mallocFn = countingMalloc,
+        .callocFn = countingCalloc,
+        .reallocFn = countingRealloc,
+        .strdupFn = countingStrdup,
+        .freeFn = free,
+    };
+    hiredisSetAllocators(&ha);
+
+    benchServer *bs = benchServerStart(BENCH_PORT, BENCH_NODES);
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", BENCH_PORT);
+
+    printf("%-22s %10s %14s %14s %14s\n", "command", "commands",
+           "allocs/command", "bytes/command", "usec/command");
+
+    /* Synchronous API */
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+    redisClusterSetOptionAddNodes(cc, addr);
+    redisClusterSetOptionRouteUseSlots(cc);
+    int status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    bench_sync(cc, "sync GET", "GET key", commands);
+    bench_sync(cc, "sync MGET 10 keys", "MGET a b c d e f g h i j", commands);
+    bench_pipeline(cc, "pipeline GET", "GET key", commands);
+    redisClusterFree(cc);
+
+    /* Asynchronous API */
+    struct event_base *base = event_base_new();
+    redisClusterAsyncContext *acc = redisClusterAsyncContextInit();
+    assert(acc);
+    redisClusterSetOptionAddNodes(acc->cc, addr);
+    redisClusterSetOptionRouteUseSlots(acc->cc);
+    status = redisClusterConnect2(acc->cc);
+    ASSERT_MSG(status == REDIS_OK, acc->cc->errstr);
+    status = redisClusterLibeventAttach(acc, base);
+    assert(status == REDIS_OK);
+
+    bench_async(acc, base, "async GET", "GET key", commands);
+    bench_async(acc, base, "async MGET 3 keys", "MGET {k}a {k}b {k}c",
+                commands);
+    bench_async(acc, base, "async SET 16KB value", large_set, commands);
+
+    redisClusterAsyncFree(acc);
+    event_base_free(base);
+    benchServerStop(bs);
+    hiredisResetAllocators();
+    free(large_set);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Benchmark of write coalescing in the asynchronous API, i.e. cork mode.
+ *
+ * Runs GET commands using the asynchronous API against an in-process stand-in
+ * cluster, with cork mode disabled and enabled. The commands are either sent
+ * from the reply callbacks, keeping a number of commands in flight, or in
+ * bursts sent all at once when the replies of the previous burst are received. The number of socket writes per command, each being
+ * a system call, and the throughput are reported.
+ *
+ * Usage: bench_cork [commands]
+ */
+#include "adapters/libevent.h"
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PORT 7800
+#define BENCH_NODES 3
+#define BURST_SIZE 1024
+#define CORK_MAX_BYTES (64 * 1024)
+
+/* Number of commands in flight, when sent from the reply callbacks */
+static const int windows[] = {16, 128, 1024};
+
+/* Socket writes are counted by wrapping the write function of hiredis. */
+static long long writes = 0;
+static ssize_t (*hiredisWrite)(redisContext *c) = NULL;
+static redisContextFuncs countingFuncs;
+
+static ssize_t countingWrite(redisContext *c) {
+    writes++;
+    return hiredisWrite(c);
+}
+
+static void connectCallback(redisAsyncContext *ac, int status) {
+    if (status != REDIS_OK)
+        return;
+    if (hiredisWrite == NULL) {
+        countingFuncs = *ac->c.funcs;
+        hiredisWrite = countingFuncs.write;
+        countingFuncs.write = countingWrite;
+    }
+    assert(ac->c.funcs->write == hiredisWrite ||
+           ac->c.funcs->write == countingWrite);
+    ac->c.funcs = &countingFuncs;
+}
+
+typedef struct benchState {
+    struct event_base *base;
+    int commands;
+    int sent;
+    int received;
+    int burst; /* Send in bursts rather than one per reply */
+} benchState;
+
+static void sendCommand(redisClusterAsyncContext *acc, benchState *state);
+
+static void replyCallback(redisClusterAsyncContext *acc, void *r,
+                          void *privdata) {
+    benchState *state = privdata;
+    redisReply *reply = r;
+    ASSERT_MSG(reply != NULL, acc->errstr);
+
+    if (++state->received == state->commands) {
+        event_base_loopbreak(state->base);
+    } else if (!state->burst) {
+        if (state->sent < state->commands)
+            sendCommand(acc, state);
+    } else if (state->received == state->sent) {
+        for (int i = 0; i < BURST_SIZE && state->sent < state->commands; i++)
+            sendCommand(acc, state);
+    }
+}
+
+static void sendCommand(redisClusterAsyncContext *acc, benchState *state) {
+    int status = redisClusterAsyncCommand(acc, replyCallback, state,
+                                          "GET key%d", state->sent++);
+    ASSERT_MSG(status == REDIS_OK, acc->errstr);
+}
+
+static void bench(const char *addr, int window, int burst, int cork,
+                  int commands) {
+    struct event_base *base = event_base_new();
+    benchState state = {.base = base, .commands = commands, .burst = burst};
+
+    redisClusterAsyncContext *acc = redisClusterAsyncContextInit();
+    assert(acc);
+    redisClusterSetOptionAddNodes(acc->cc, addr);
+    redisClusterSetOptionRouteUseSlots(acc->cc);
+    redisClusterAsyncSetConnectCallbackNC(acc, connectCallback);
+    if (cork)
+        redisClusterAsyncSetCork(acc, CORK_MAX_BYTES);
+    int status = redisClusterConnect2(acc->cc);
+    ASSERT_MSG(status == REDIS_OK, acc->cc->errstr);
+    status = redisClusterLibeventAttach(acc, base);
+    assert(status == REDIS_OK);
+
+    writes = 0;
+    int64_t start = benchUsecNow();
+    for (int i = 0; i < window && i < commands; i++)
+        sendCommand(acc, &state);
+    event_base_dispatch(base);
+    int64_t usec = benchUsecNow() - start;
+
+    printf("%-6s %6d %-4s %10d %10lld %10.3f %12.0f\n",
+           burst ? "burst" : "window", window, cork ? "on" : "off", commands,
+           writes, (double)writes / commands, commands * 1e6 / usec);
+
+    redisClusterAsyncFree(acc);
+    event_base_free(base);
+}
+
+int main(int argc, char **argv) {
+    int commands = argc > 1 ? atoi(argv[1]) : 200000;
+    char addr[32];
+
+    benchServer *bs = benchServerStart(BENCH_PORT, BENCH_NODES);
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", BENCH_PORT);
+
+    printf("%-6s %6s %-4s %10s %10s %10s %12s\n", "mode", "size", "cork",
+           "commands", "writes", "writes/cmd", "commands/s");
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        for (int cork = 0; cork <= 1; cork++)
+            bench(addr, windows[i], 0, cork, commands);
+    }
+    for (int cork = 0; cork <= 1; cork++)
+        bench(addr, BURST_SIZE, 1, cork, commands);
+
+    benchServerStop(bs);
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Benchmark of multi-key MGET commands that are split per slot.
+ *
+ * Runs pipelined MGET commands with 2, 10, 100 and 1000 keys against an
+ * in-process stand-in cluster and reports the time spent per command.
+ *
+ * Usage: bench_mget [iterations]
+ */
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PORT 7800
+#define BENCH_NODES 3
+#define PIPELINE_DEPTH 100
+
+static void bench_mget(redisClusterContext *cc, int keys, int iterations) {
+    const char **argv = malloc(sizeof(char *) * (keys + 1));
+    size_t *argvlen = malloc(sizeof(size_t) * (keys + 1));
+    char (*names)[16] = malloc(sizeof(*names) * keys);
+    redisReply *reply;
+    int i, sent = 0, received = 0;
+
+    argv[0] = "MGET";
+    argvlen[0] = 4;
+    for (i = 0; i < keys; i++) {
+        argvlen[i + 1] = snprintf(names[i], sizeof(names[i]), "key:%d", i);
+        argv[i + 1] = names[i];
+    }
+
+    int64_t start = benchUsecNow();
+    while (received < iterations) {
+        for (; sent < iterations && sent - received < PIPELINE_DEPTH; sent++) {
+            int status = redisClusterAppendCommandArgv(cc, keys + 1, argv,
+                                                       argvlen);
+            ASSERT_MSG(status == REDIS_OK, cc->errstr);
+        }
+        for (; received < sent; received++) {
+            int status = redisClusterGetReply(cc, (void **)&reply);
+            ASSERT_MSG(status == REDIS_OK, cc->errstr);
+            assert(reply->type == REDIS_REPLY_ARRAY);
+            assert(reply->elements == (size_t)keys);
+            freeReplyObject(reply);
+        }
+        redisClusterReset(cc);
+    }
+    int64_t elapsed = benchUsecNow() - start;
+
+    printf("%6d %10d %14.2f %14.0f\n", keys, iterations,
+           (double)elapsed / iterations,
+           (double)keys * iterations * 1000000 / elapsed);
+
+    free(names);
+    free(argvlen);
+    free(argv);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    const int key_counts[] = {2, 10, 100, 1000};
+    char addr[32];
+
+    benchServer *bs = benchServerStart(BENCH_PORT, BENCH_NODES);
+
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", BENCH_PORT);
+    redisClusterSetOptionAddNodes(cc, addr);
+    redisClusterSetOptionRouteUseSlots(cc);
+
+    int status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    printf("%6s %10s %14s %14s\n", "keys", "commands", "usec/command",
+           "keys/sec");
+    for (size_t i = 0; i < sizeof(key_counts) / sizeof(key_counts[0]); i++) {
+        int n = key_counts[i];
+        /* Keep the total number of keys roughly the same per run */
+        int runs = n > 10 ? iterations * 10 / n : iterations;
+        bench_mget(cc, n, runs > 100 ? runs : 100);
+    }
+
+    redisClusterFree(cc);
+    benchServerStop(bs);
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * Benchmark of the response times of read-only commands per read policy.
+ *
+ * Runs GET commands using the synchronous and the asynchronous API against an
+ * in-process stand-in cluster where each master has two replicas. Every node
+ * adds a delay to its replies and two scenarios are run: one replica per master
+ * is slow, e.g. being overloaded or placed in a remote zone, or the masters are
+ * slow, e.g. busy serving the writes. A fixed choice of nodes gives a slow tail
+ * in one of the scenarios, while a policy worth its cost avoids the slow nodes
+ * in both. Each policy uses its own long-lived clients, and the policies take
+ * turns in a number of rounds so that a hiccup of the machine doesn't hit a
+ * single policy. The average, median, 90th and 99th percentile response times
+ * are reported for each scenario and read policy.
+ *
+ * Usage: bench_replica_latency [commands]
+ */
+#include "adapters/libevent.h"
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PORT 7800
+#define BENCH_NODES 3
+#define BENCH_REPLICAS 2
+#define ASYNC_CONCURRENCY 16
+#define ROUNDS 5
+
+#define BENCH_LISTENERS (BENCH_NODES * (1 + BENCH_REPLICAS))
+
+/* Reply delays in usec indexed by port offset: masters, first replicas and
+ * second replicas. The bench server waits in whole milliseconds, so the delays
+ * are too. The scenarios use their own ports so that no connection of the
+ * previous one lingers. */
+static const struct {
+    const char *name;
+    int64_t delays[BENCH_LISTENERS];
+} scenarios[] = {
+    {"slow replica",
+     {3000, 3000, 3000, 10000, 10000, 10000, 1000, 1000, 1000}},
+    {"slow master",
+     {10000, 10000, 10000, 3000, 3000, 3000, 1000, 1000, 1000}},
+};
+
+#define NSCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const struct {
+    int policy;
+    const char *name;
+} policies[] = {
+    {HIRCLUSTER_READ_MASTER, "master"},
+    {HIRCLUSTER_READ_PREFER_REPLICA, "prefer-replica"},
+    {HIRCLUSTER_READ_ROUND_ROBIN, "round-robin"},
+    {HIRCLUSTER_READ_LEAST_LATENCY, "least-latency"},
+};
+
+#define NPOLICIES (sizeof(policies) / sizeof(policies[0]))
+
+static int compareInt64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *scenario, const char *api, const char *policy,
+                   int64_t *samples, int commands) {
+    int64_t sum = 0;
+
+    for (int i = 0; i < commands; i++)
+        sum += samples[i];
+    qsort(samples, commands, sizeof(int64_t), compareInt64);
+    printf("%-13s %-6s %-15s %9d %9.0f %9lld %9lld %9lld\n", scenario, api,
+           policy, commands, (double)sum / commands,
+           (long long)samples[commands / 2],
+           (long long)samples[(int)(commands * 0.9)],
+           (long long)samples[(int)(commands * 0.99)]);
+}
+
+static redisClusterContext *connect_sync(const char *addr, int policy) {
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+    redisClusterSetOptionAddNodes(cc, addr);
+    redisClusterSetOptionRouteUseSlots(cc);
+    redisClusterSetOptionReadPolicy(cc, policy);
+    int status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    return cc;
+}
+
+static void bench_sync(redisClusterContext *cc, int commands,
+                       int64_t *samples) {
+    for (int i = 0; i < commands; i++) {
+        int64_t start = benchUsecNow();
+        redisReply *reply = redisClusterCommand(cc, "GET key%d", i);
+        ASSERT_MSG(reply != NULL, cc->errstr);
+        freeReplyObject(reply);
+        samples[i] = benchUsecNow() - start;
+    }
+}
+
+typedef struct asyncState {
+    struct event_base *base;
+    int64_t *samples;
+    int commands;
+    int sent;
+    int received;
+} asyncState;
+
+typedef struct asyncRequest {
+    asyncState *state;
+    int64_t start;
+} asyncRequest;
+
+static void sendNext(redisClusterAsyncContext *acc, asyncRequest *req);
+
+static void asyncCallback(redisClusterAsyncContext *acc, void *r,
+                          void *privdata) {
+    asyncRequest *req = privdata;
+    asyncState *state = req->state;
+    redisReply *reply = r;
+    ASSERT_MSG(reply != NULL, acc->errstr);
+
+    state->samples[state->received] = benchUsecNow() - req->start;
+    if (++state->received == state->commands) {
+        event_base_loopbreak(state->base);
+    } else if (state->sent < state->commands) {
+        sendNext(acc, req);
+    }
+}
+
+static void sendNext(redisClusterAsyncContext *acc, asyncRequest *req) {
+    asyncState *state = req->state;
+
+    req->start = benchUsecNow();
+    int status = redisClusterAsyncCommand(acc, asyncCallback, req, "GET key%d",
+                                          state->sent++);
+    ASSERT_MSG(status == REDIS_OK, acc->errstr);
+}
+
+static redisClusterAsyncContext *connect_async(const char *addr, int policy,
+                                               struct event_base *base) {
+    redisClusterAsyncContext *acc = redisClusterAsyncContextInit();
+    assert(acc);
+    redisClusterSetOptionAddNodes(acc->cc, addr);
+    redisClusterSetOptionRouteUseSlots(acc->cc);
+    redisClusterSetOptionReadPolicy(acc->cc, policy);
+    int status = redisClusterConnect2(acc->cc);
+    ASSERT_MSG(status == REDIS_OK, acc->cc->errstr);
+    status = redisClusterLibeventAttach(acc, base);
+    assert(status == REDIS_OK);
+    return acc;
+}
+
+static void bench_async(redisClusterAsyncContext *acc, struct event_base *base,
+                        int commands, int64_t *samples) {
+    asyncState state = {.base = base, .samples = samples, .commands = commands};
+    asyncRequest requests[ASYNC_CONCURRENCY];
+
+    for (int i = 0; i < ASYNC_CONCURRENCY && i < commands; i++) {
+        requests[i].state = &state;
+        sendNext(acc, &requests[i]);
+    }
+    event_base_dispatch(base);
+}
+
+/* Runs a scenario, after which the samples of the sync runs of each policy
+ * are followed by the async runs. */
+static void bench_scenario(int port, const int64_t *delays, int commands,
+                           int64_t *samples) {
+    redisClusterContext *ccs[NPOLICIES];
+    redisClusterAsyncContext *accs[NPOLICIES];
+    struct event_base *base = event_base_new();
+    int per_round = commands / ROUNDS;
+    char addr[32];
+
+    benchServer *bs =
+        benchServerStartWithReplicas(port, BENCH_NODES, BENCH_REPLICAS, delays);
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", port);
+    for (size_t i = 0; i < NPOLICIES; i++) {
+        ccs[i] = connect_sync(addr, policies[i].policy);
+        accs[i] = connect_async(addr, policies[i].policy, base);
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < NPOLICIES; i++) {
+            int64_t *sync_samples = samples + i * commands;
+            int64_t *async_samples = samples + (NPOLICIES + i) * commands;
+            bench_sync(ccs[i], per_round, sync_samples + round * per_round);
+            bench_async(accs[i], base, per_round,
+                        async_samples + round * per_round);
+        }
+    }
+
+    for (size_t i = 0; i < NPOLICIES; i++) {
+        redisClusterFree(ccs[i]);
+        redisClusterAsyncFree(accs[i]);
+    }
+    event_base_free(base);
+    benchServerStop(bs);
+}
+
+int main(int argc, char **argv) {
+    int commands = argc > 1 ? atoi(argv[1]) : 2000;
+
+    commands = commands / ROUNDS * ROUNDS;
+    int64_t *samples = malloc(sizeof(int64_t) * commands * NPOLICIES * 2);
+    assert(samples);
+
+    printf("%-13s %-6s %-15s %9s %9s %9s %9s %9s\n", "scenario", "api",
+           "read policy", "commands", "avg usec", "p50 usec", "p90 usec",
+           "p99 usec");
+    for (size_t s = 0; s < NSCENARIOS; s++) {
+        bench_scenario(BENCH_PORT + s * BENCH_LISTENERS, scenarios[s].delays,
+                       commands, samples);
+        for (size_t i = 0; i < NPOLICIES; i++)
+            report(scenarios[s].name, "sync", policies[i].name,
+                   samples + i * commands, commands);
+        for (size_t i = 0; i < NPOLICIES; i++)
+            report(scenarios[s].name, "async", policies[i].name,
+                   samples + (NPOLICIES + i) * commands, commands);
+    }
+
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,389 @@
+#include "bench_server.h"
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 1024
+#define MAX_ARGS 4096
+#define CLUSTER_SLOTS 16384
+
+typedef struct buffer {
+    char *data;
+    size_t len;
+    size_t cap;
+} buffer;
+
+/* Replies written before `due` may not be sent before that time. */
+typedef struct release {
+    size_t end;
+    int64_t due;
+} release;
+
+typedef struct client {
+    int fd;
+    int node; /* Index of the listener that accepted the connection */
+    buffer in;
+    buffer out;
+    size_t ready; /* Bytes of output that can be sent */
+    release *releases;
+    int nreleases;
+    int releases_cap;
+} client;
+
+struct benchServer {
+    int port;
+    int nodes;
+    int replicas;
+    int nlisteners; /* Masters followed by replicas */
+    int64_t *delays;
+    int *listeners;
+    int wakeup[2]; /* Pipe used to stop the server thread */
+    int slotmap_requests; /* Read by other threads */
+    client clients[MAX_CLIENTS];
+    int nclients;
+    pthread_t thread;
+};
+
+int64_t benchUsecNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void bufferAppend(buffer *b, const char *data, size_t len) {
+    if (b->len + len > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < b->len + len)
+            cap *= 2;
+        b->data = realloc(b->data, cap);
+        assert(b->data);
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+}
+
+static void bufferAppendFormat(buffer *b, const char *fmt, long long value) {
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), fmt, value);
+    bufferAppend(b, tmp, (size_t)len);
+}
+
+static void bufferAppendBulk(buffer *b, const char *str, size_t len) {
+    bufferAppendFormat(b, "$%lld\r\n", (long long)len);
+    bufferAppend(b, str, len);
+    bufferAppend(b, "\r\n", 2);
+}
+
+static void bufferConsume(buffer *b, size_t len) {
+    memmove(b->data, b->data + len, b->len - len);
+    b->len -= len;
+}
+
+static void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static int argIs(const char *arg, size_t len, const char *name) {
+    return len == strlen(name) && strncasecmp(arg, name, len) == 0;
+}
+
+static void replyClusterSlots(benchServer *bs, buffer *out) {
+    int per_node = CLUSTER_SLOTS / bs->nodes;
+    char id[41];
+
+    bufferAppendFormat(out, "*%lld\r\n", bs->nodes);
+    for (int i = 0; i < bs->nodes; i++) {
+        int first = i * per_node;
+        int last = (i == bs->nodes - 1) ? CLUSTER_SLOTS - 1 : first + per_node - 1;
+
+        bufferAppendFormat(out, "*%lld\r\n", 3 + bs->replicas);
+        bufferAppendFormat(out, ":%lld\r\n", first);
+        bufferAppendFormat(out, ":%lld\r\n", last);
+        for (int r = 0; r <= bs->replicas; r++) {
+            int node = r * bs->nodes + i;
+
+            snprintf(id, sizeof(id), "%040d", node);
+            bufferAppend(out, "*3\r\n", 4);
+            bufferAppendBulk(out, "127.0.0.1", 9);
+            bufferAppendFormat(out, ":%lld\r\n", bs->port + node);
+            bufferAppendBulk(out, id, 40);
+        }
+    }
+}
+
+static void executeCommand(benchServer *bs, buffer *out, int argc,
+                           char **argv, size_t *argvlen) {
+    if (argIs(argv[0], argvlen[0], "CLUSTER") && argc == 2 &&
+        argIs(argv[1], argvlen[1], "SLOTS")) {
+        __atomic_add_fetch(&bs->slotmap_requests, 1, __ATOMIC_SEQ_CST);
+        replyClusterSlots(bs, out);
+    } else if (argIs(argv[0], argvlen[0], "GET") && argc == 2) {
+        bufferAppendBulk(out, argv[1], argvlen[1]);
+    } else if (argIs(argv[0], argvlen[0], "MGET")) {
+        bufferAppendFormat(out, "*%lld\r\n", argc - 1);
+        for (int i = 1; i < argc; i++)
+            bufferAppendBulk(out, argv[i], argvlen[i]);
+    } else if (argIs(argv[0], argvlen[0], "DEL") ||
+               argIs(argv[0], argvlen[0], "UNLINK") ||
+               argIs(argv[0], argvlen[0], "EXISTS")) {
+        bufferAppendFormat(out, ":%lld\r\n", argc - 1);
+    } else if (argIs(argv[0], argvlen[0], "PING")) {
+        bufferAppend(out, "+PONG\r\n", 7);
+    } else if (argIs(argv[0], argvlen[0], "SET") ||
+               argIs(argv[0], argvlen[0], "MSET") ||
+               argIs(argv[0], argvlen[0], "AUTH") ||
+               argIs(argv[0], argvlen[0], "SELECT") ||
+               argIs(argv[0], argvlen[0], "CLIENT") ||
+               argIs(argv[0], argvlen[0], "READONLY")) {
+        bufferAppend(out, "+OK\r\n", 5);
+    } else {
+        const char *err = "-ERR unknown command\r\n";
+        bufferAppend(out, err, strlen(err));
+    }
+}
+
+/* Parse and execute all complete commands in the input buffer. */
+static void processInput(benchServer *bs, client *c) {
+    static char *argv[MAX_ARGS];
+    static size_t argvlen[MAX_ARGS];
+    size_t pos = 0;
+
+    while (pos < c->in.len) {
+        char *p = c->in.data + pos, *end = c->in.data + c->in.len, *nl;
+        long argc, len;
+        int i;
+
+        assert(*p == '*'); /* Only multibulk requests are supported */
+        if ((nl = memchr(p, '\n', end - p)) == NULL)
+            break;
+        argc = strtol(p + 1, NULL, 10);
+        assert(argc > 0 && argc <= MAX_ARGS);
+        p = nl + 1;
+
+        for (i = 0; i < argc; i++) {
+            if (p >= end || (nl = memchr(p, '\n', end - p)) == NULL)
+                break;
+            len = strtol(p + 1, NULL, 10);
+            if (end - (nl + 1) < len + 2)
+                break;
+            argv[i] = nl + 1;
+            argvlen[i] = (size_t)len;
+            p = nl + 1 + len + 2;
+        }
+        if (i < argc)
+            break; /* Incomplete command */
+
+        executeCommand(bs, &c->out, (int)argc, argv, argvlen);
+        pos = (size_t)(p - c->in.data);
+    }
+    bufferConsume(&c->in, pos);
+
+    if (bs->delays == NULL || bs->delays[c->node] == 0) {
+        c->ready = c->out.len;
+    } else if (c->out.len > c->ready) {
+        /* Hold back the new replies until the node's delay has passed */
+        if (c->nreleases == c->releases_cap) {
+            c->releases_cap = c->releases_cap ? c->releases_cap * 2 : 64;
+            c->releases =
+                realloc(c->releases, sizeof(release) * c->releases_cap);
+            assert(c->releases);
+        }
+        c->releases[c->nreleases].end = c->out.len;
+        c->releases[c->nreleases++].due = benchUsecNow() + bs->delays[c->node];
+    }
+}
+
+/* Make the delayed replies that are due available for sending. Returns the
+ * time when the next reply is due, or -1 if none. */
+static int64_t releaseReplies(client *c, int64_t now) {
+    int i;
+
+    for (i = 0; i < c->nreleases && c->releases[i].due <= now; i++)
+        c->ready = c->releases[i].end;
+    if (i > 0) {
+        memmove(c->releases, c->releases + i,
+                sizeof(release) * (c->nreleases - i));
+        c->nreleases -= i;
+    }
+    return c->nreleases ? c->releases[0].due : -1;
+}
+
+static void writeReplies(client *c) {
+    ssize_t w = write(c->fd, c->out.data, c->ready);
+    if (w <= 0)
+        return;
+
+    bufferConsume(&c->out, (size_t)w);
+    c->ready -= (size_t)w;
+    for (int i = 0; i < c->nreleases; i++)
+        c->releases[i].end -= (size_t)w;
+}
+
+static void closeClient(benchServer *bs, int idx) {
+    client *c = &bs->clients[idx];
+    close(c->fd);
+    free(c->in.data);
+    free(c->out.data);
+    free(c->releases);
+    bs->clients[idx] = bs->clients[--bs->nclients];
+}
+
+static void *serverThread(void *arg) {
+    benchServer *bs = arg;
+    struct pollfd *pfds;
+    int nlisteners = bs->nlisteners + 1;
+
+    pfds = malloc(sizeof(*pfds) * (nlisteners + MAX_CLIENTS));
+    assert(pfds);
+
+    for (;;) {
+        int i, n = 0, timeout = -1;
+        int64_t now = benchUsecNow(), next = -1;
+
+        pfds[n].fd = bs->wakeup[0];
+        pfds[n++].events = POLLIN;
+        for (i = 0; i < bs->nlisteners; i++) {
+            pfds[n].fd = bs->listeners[i];
+            pfds[n++].events = POLLIN;
+        }
+        for (i = 0; i < bs->nclients; i++) {
+            int64_t due = releaseReplies(&bs->clients[i], now);
+            if (due >= 0 && (next < 0 || due < next))
+                next = due;
+            pfds[n].fd = bs->clients[i].fd;
+            pfds[n++].events =
+                bs->clients[i].ready ? (POLLIN | POLLOUT) : POLLIN;
+        }
+        if (next >= 0)
+            timeout = (int)((next - now + 999) / 1000);
+
+        if (poll(pfds, n, timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (pfds[0].revents)
+            break; /* Stopped */
+
+        /* Handle clients first since accepting reorders the array */
+        for (i = bs->nclients - 1; i >= 0; i--) {
+            struct pollfd *pfd = &pfds[nlisteners + i];
+            client *c = &bs->clients[i];
+
+            if (pfd->revents & (POLLIN | POLLERR | POLLHUP)) {
+                char buf[16384];
+                ssize_t r = read(c->fd, buf, sizeof(buf));
+                if (r <= 0) {
+                    if (r < 0 && errno == EAGAIN)
+                        continue;
+                    closeClient(bs, i);
+                    continue;
+                }
+                bufferAppend(&c->in, buf, (size_t)r);
+                processInput(bs, c);
+            }
+            releaseReplies(c, benchUsecNow());
+            if (c->ready)
+                writeReplies(c);
+        }
+
+        for (i = 0; i < bs->nlisteners; i++) {
+            if (pfds[1 + i].revents & POLLIN) {
+                int fd = accept(bs->listeners[i], NULL, NULL);
+                if (fd < 0)
+                    continue;
+                assert(bs->nclients < MAX_CLIENTS);
+                int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                setNonBlocking(fd);
+                memset(&bs->clients[bs->nclients], 0, sizeof(client));
+                bs->clients[bs->nclients].node = i;
+                bs->clients[bs->nclients++].fd = fd;
+            }
+        }
+    }
+
+    free(pfds);
+    return NULL;
+}
+
+benchServer *benchServerStart(int port, int nodes) {
+    return benchServerStartWithReplicas(port, nodes, 0, NULL);
+}
+
+benchServer *benchServerStartWithReplicas(int port, int nodes, int replicas,
+                                          const int64_t *delays) {
+    benchServer *bs = calloc(1, sizeof(*bs));
+    assert(bs);
+    bs->port = port;
+    bs->nodes = nodes;
+    bs->replicas = replicas;
+    bs->nlisteners = nodes * (1 + replicas);
+    bs->listeners = calloc(bs->nlisteners, sizeof(int));
+    assert(bs->listeners);
+    if (delays != NULL) {
+        bs->delays = malloc(sizeof(int64_t) * bs->nlisteners);
+        assert(bs->delays);
+        memcpy(bs->delays, delays, sizeof(int64_t) * bs->nlisteners);
+    }
+
+    for (int i = 0; i < bs->nlisteners; i++) {
+        struct sockaddr_in sa = {0};
+        int on = 1;
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons(port + i);
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+            perror("bind");
+            exit(1);
+        }
+        listen(fd, 128);
+        bs->listeners[i] = fd;
+    }
+
+    if (pipe(bs->wakeup) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    pthread_create(&bs->thread, NULL, serverThread, bs);
+    return bs;
+}
+
+int benchServerSlotmapRequests(benchServer *bs) {
+    return __atomic_load_n(&bs->slotmap_requests, __ATOMIC_SEQ_CST);
+}
+
+void benchServerStop(benchServer *bs) {
+    if (write(bs->wakeup[1], "x", 1) != 1) {
+        perror("write");
+    }
+    pthread_join(bs->thread, NULL);
+
+    while (bs->nclients > 0)
+        closeClient(bs, bs->nclients - 1);
+    for (int i = 0; i < bs->nlisteners; i++)
+        close(bs->listeners[i]);
+    close(bs->wakeup[0]);
+    close(bs->wakeup[1]);
+    free(bs->listeners);
+    free(bs->delays);
+    free(bs);
+}
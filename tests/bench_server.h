@@ -0,0 +1,32 @@
+#ifndef __BENCH_SERVER_H__
+#define __BENCH_SERVER_H__
+
+#include <stdint.h>
+
+/* A minimal in-process stand-in for a Redis Cluster used by the benchmarks.
+ *
+ * The server runs in its own thread and serves a number of master nodes on
+ * consecutive ports on 127.0.0.1, with the slots evenly split between them.
+ * It answers CLUSTER SLOTS and a small set of data commands without storing
+ * anything: a GET or MGET replies with the key name as value, a SET or MSET
+ * replies OK and DEL or EXISTS replies with the number of keys. Connection
+ * related commands like PING, AUTH and READONLY are accepted. */
+typedef struct benchServer benchServer;
+
+benchServer *benchServerStart(int port, int nodes);
+
+/* Start a server where each master has a number of replicas. Replica r (from
+ * 1) of master i listens on port + r * nodes + i. When `delays` is given it
+ * holds the delay in microseconds added to each reply of every node, indexed
+ * by the port offset. */
+benchServer *benchServerStartWithReplicas(int port, int nodes, int replicas,
+                                          const int64_t *delays);
+void benchServerStop(benchServer *bs);
+
+/* Number of CLUSTER SLOTS commands received */
+int benchServerSlotmapRequests(benchServer *bs);
+
+/* Helpers */
+int64_t benchUsecNow(void);
+
+#endif
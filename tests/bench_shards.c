@@ -0,0 +1,177 @@
+/*
+ * Benchmark of a sharded asynchronous client, running an event loop thread
+ * per shard.
+ *
+ * Producer threads submit GET commands to an in-process stand-in cluster using
+ * a sharded client with a varying number of event loops. Each reply is checked
+ * to belong to its command, since the stand-in replies with the key name. The
+ * throughput and the number of commands handled by each shard are reported.
+ *
+ * Usage: bench_shards [commands]
+ */
+#include "adapters/libevent.h"
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PORT 7800
+#define BENCH_NODES 4
+#define PRODUCERS 4
+#define MAX_LOOPS 4
+
+static const int loop_counts[] = {1, 2, 4};
+
+typedef struct benchState {
+    redisClusterAsyncShards *shards;
+    const char *addr;
+    int commands;
+    int received; /* Updated atomically by the event loop threads */
+    pthread_barrier_t connected;
+    long long handled[MAX_LOOPS];
+} benchState;
+
+typedef struct loopArg {
+    benchState *state;
+    int shard;
+    struct event_base *base;
+} loopArg;
+
+typedef struct producerArg {
+    benchState *state;
+    int first;
+    int count;
+} producerArg;
+
+/* The privdata of a command is its key number, so the state is global */
+static benchState *running = NULL;
+
+/* Check the reply and count it for the shard of the context. */
+static void replyCallback(redisClusterAsyncContext *acc, void *r,
+                          void *privdata) {
+    redisReply *reply = r;
+    char expected[32];
+    int i;
+    ASSERT_MSG(reply != NULL, acc->errstr);
+
+    snprintf(expected, sizeof(expected), "key%d", (int)(intptr_t)privdata);
+    assert(reply->type == REDIS_REPLY_STRING);
+    assert(strcmp(reply->str, expected) == 0);
+
+    for (i = 0; running->shards->acc[i] != acc; i++)
+        ;
+    running->handled[i]++;
+    __atomic_add_fetch(&running->received, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Stop an event loop when all replies are received, by any of the loops. */
+static void checkDone(evutil_socket_t fd, short event, void *arg) {
+    loopArg *la = arg;
+    (void)fd;
+    (void)event;
+
+    if (__atomic_load_n(&la->state->received, __ATOMIC_SEQ_CST) ==
+        la->state->commands)
+        event_base_loopbreak(la->base);
+}
+
+static void *eventLoop(void *arg) {
+    loopArg *la = arg;
+    benchState *state = la->state;
+    redisClusterAsyncContext *acc = state->shards->acc[la->shard];
+    struct timeval interval = {0, 1000};
+
+    la->base = event_base_new();
+    redisClusterSetOptionAddNodes(acc->cc, state->addr);
+    redisClusterSetOptionRouteUseSlots(acc->cc);
+    int status = redisClusterLibeventAttach(acc, la->base);
+    assert(status == REDIS_OK);
+    status = redisClusterAsyncEnableSubmit(acc);
+    ASSERT_MSG(status == REDIS_OK, acc->errstr);
+    status = redisClusterConnect2(acc->cc);
+    ASSERT_MSG(status == REDIS_OK, acc->cc->errstr);
+
+    struct event *timer = event_new(la->base, -1, EV_PERSIST, checkDone, la);
+    event_add(timer, &interval);
+    pthread_barrier_wait(&state->connected);
+
+    event_base_dispatch(la->base);
+    event_free(timer);
+    return NULL;
+}
+
+static void *producer(void *arg) {
+    producerArg *pa = arg;
+
+    for (int i = pa->first; i < pa->first + pa->count; i++) {
+        int status = redisClusterAsyncShardsSubmit(
+            pa->state->shards, replyCallback, (void *)(intptr_t)i, "GET key%d",
+            i);
+        assert(status == REDIS_OK);
+    }
+    return NULL;
+}
+
+static void bench(const char *addr, int loops, int commands) {
+    benchState state = {.addr = addr,
+                        .commands = commands - commands % PRODUCERS};
+    pthread_t loop_threads[MAX_LOOPS], producer_threads[PRODUCERS];
+    loopArg loop_args[MAX_LOOPS];
+    producerArg producer_args[PRODUCERS];
+
+    state.shards = redisClusterAsyncShardsInit(loops);
+    assert(state.shards);
+    running = &state;
+    pthread_barrier_init(&state.connected, NULL, loops + 1);
+    for (int i = 0; i < loops; i++) {
+        loop_args[i].state = &state;
+        loop_args[i].shard = i;
+        pthread_create(&loop_threads[i], NULL, eventLoop, &loop_args[i]);
+    }
+    pthread_barrier_wait(&state.connected);
+
+    int64_t start = benchUsecNow();
+    for (int i = 0; i < PRODUCERS; i++) {
+        producer_args[i].state = &state;
+        producer_args[i].count = state.commands / PRODUCERS;
+        producer_args[i].first = i * producer_args[i].count;
+        pthread_create(&producer_threads[i], NULL, producer,
+                       &producer_args[i]);
+    }
+    for (int i = 0; i < PRODUCERS; i++)
+        pthread_join(producer_threads[i], NULL);
+    for (int i = 0; i < loops; i++)
+        pthread_join(loop_threads[i], NULL);
+    int64_t usec = benchUsecNow() - start;
+
+    printf("%5d %10d %12.0f  ", loops, state.commands,
+           state.commands * 1e6 / usec);
+    for (int i = 0; i < loops; i++)
+        printf(" %lld", state.handled[i]);
+    printf("\n");
+
+    redisClusterAsyncShardsFree(state.shards);
+    for (int i = 0; i < loops; i++)
+        event_base_free(loop_args[i].base);
+    pthread_barrier_destroy(&state.connected);
+}
+
+int main(int argc, char **argv) {
+    int commands = argc > 1 ? atoi(argv[1]) : 400000;
+    char addr[32];
+
+    benchServer *bs = benchServerStart(BENCH_PORT, BENCH_NODES);
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", BENCH_PORT);
+
+    printf("%5s %10s %12s   %s\n", "loops", "commands", "commands/s",
+           "commands per loop");
+    for (size_t i = 0; i < sizeof(loop_counts) / sizeof(loop_counts[0]); i++)
+        bench(addr, loop_counts[i], commands);
+
+    benchServerStop(bs);
+    return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * Benchmark of submitting commands from other threads than the event loop
+ * thread in the asynchronous API.
+ *
+ * A number of producer threads send GET commands to an in-process stand-in
+ * cluster, either using the submit queue of the library or using a queue
+ * protected by a mutex, with the same kind of pipe to wake up the event loop,
+ * as an application would need without the submit queue. The throughput and
+ * the average time spent by a producer to submit a command are reported.
+ *
+ * Usage: bench_submit [commands]
+ */
+#include "adapters/libevent.h"
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_PORT 7800
+#define BENCH_NODES 3
+#define MAX_PRODUCERS 8
+
+static const int producer_counts[] = {1, 2, 4, 8};
+
+/* A command queued by a producer when using the mutex */
+typedef struct lockedCommand {
+    struct lockedCommand *next;
+    char *cmd;
+    int len;
+} lockedCommand;
+
+typedef struct lockedQueue {
+    pthread_mutex_t lock;
+    lockedCommand *head;
+    lockedCommand *tail;
+    int signaled;
+    int fds[2];
+    struct event *ev;
+} lockedQueue;
+
+typedef struct benchState {
+    struct event_base *base;
+    redisClusterAsyncContext *acc;
+    lockedQueue *queue; /* NULL when using the submit queue */
+    int commands;
+    int per_producer;
+    int received;
+    int64_t submit_usec[MAX_PRODUCERS];
+} benchState;
+
+typedef struct producerArg {
+    benchState *state;
+    int id;
+} producerArg;
+
+static void replyCallback(redisClusterAsyncContext *acc, void *r,
+                          void *privdata) {
+    benchState *state = privdata;
+    redisReply *reply = r;
+    ASSERT_MSG(reply != NULL, acc->errstr);
+
+    if (++state->received == state->commands)
+        event_base_loopbreak(state->base);
+}
+
+/* Send the commands queued using the mutex, from the event loop thread. */
+static void lockedQueueHandle(evutil_socket_t fd, short event, void *arg) {
+    benchState *state = arg;
+    lockedQueue *q = state->queue;
+    lockedCommand *lc, *next;
+    char buf[64];
+    (void)event;
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    pthread_mutex_lock(&q->lock);
+    lc = q->head;
+    q->head = q->tail = NULL;
+    q->signaled = 0;
+    pthread_mutex_unlock(&q->lock);
+
+    for (; lc != NULL; lc = next) {
+        next = lc->next;
+        int status = redisClusterAsyncFormattedCommand(
+            state->acc, replyCallback, state, lc->cmd, lc->len);
+        ASSERT_MSG(status == REDIS_OK, state->acc->errstr);
+        hi_free(lc->cmd);
+        free(lc);
+    }
+}
+
+static void lockedQueuePush(lockedQueue *q, char *cmd, int len) {
+    lockedCommand *lc = malloc(sizeof(*lc));
+    assert(lc);
+    lc->next = NULL;
+    lc->cmd = cmd;
+    lc->len = len;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail != NULL)
+        q->tail->next = lc;
+    else
+        q->head = lc;
+    q->tail = lc;
+    if (!q->signaled) {
+        q->signaled = 1;
+        ssize_t n = write(q->fds[1], "", 1);
+        (void)n;
+    }
+    pthread_mutex_unlock(&q->lock);
+}
+
+static void *producer(void *arg) {
+    producerArg *pa = arg;
+    benchState *state = pa->state;
+    int first = pa->id * state->per_producer;
+
+    int64_t start = benchUsecNow();
+    for (int i = first; i < first + state->per_producer; i++) {
+        if (state->queue == NULL) {
+            int status = redisClusterAsyncSubmit(state->acc, replyCallback,
+                                                 state, "GET key%d", i);
+            assert(status == REDIS_OK);
+        } else {
+            char *cmd;
+            int len = redisFormatCommand(&cmd, "GET key%d", i);
+            assert(len > 0);
+            lockedQueuePush(state->queue, cmd, len);
+        }
+    }
+    state->submit_usec[pa->id] = benchUsecNow() - start;
+    return NULL;
+}
+
+static void bench(const char *addr, int producers, int locked, int commands) {
+    struct event_base *base = event_base_new();
+    benchState state = {.base = base,
+                        .commands = commands - commands % producers,
+                        .per_producer = commands / producers};
+    lockedQueue queue = {.lock = PTHREAD_MUTEX_INITIALIZER};
+    pthread_t threads[MAX_PRODUCERS];
+    producerArg args[MAX_PRODUCERS];
+
+    redisClusterAsyncContext *acc = redisClusterAsyncContextInit();
+    assert(acc);
+    redisClusterSetOptionAddNodes(acc->cc, addr);
+    redisClusterSetOptionRouteUseSlots(acc->cc);
+    int status = redisClusterConnect2(acc->cc);
+    ASSERT_MSG(status == REDIS_OK, acc->cc->errstr);
+    status = redisClusterLibeventAttach(acc, base);
+    assert(status == REDIS_OK);
+    state.acc = acc;
+
+    if (locked) {
+        status = pipe(queue.fds);
+        assert(status == 0);
+        fcntl(queue.fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(queue.fds[1], F_SETFL, O_NONBLOCK);
+        queue.ev = event_new(base, queue.fds[0], EV_READ | EV_PERSIST,
+                             lockedQueueHandle, &state);
+        event_add(queue.ev, NULL);
+        state.queue = &queue;
+    } else {
+        status = redisClusterAsyncEnableSubmit(acc);
+        ASSERT_MSG(status == REDIS_OK, acc->errstr);
+    }
+
+    int64_t start = benchUsecNow();
+    for (int i = 0; i < producers; i++) {
+        args[i].state = &state;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, producer, &args[i]);
+    }
+    event_base_dispatch(base);
+    int64_t usec = benchUsecNow() - start;
+
+    int64_t submit_usec = 0;
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+        submit_usec += state.submit_usec[i];
+    }
+
+    printf("%-7s %9d %10d %12.0f %14.3f\n", locked ? "mutex" : "submit",
+           producers, state.commands, state.commands * 1e6 / usec,
+           (double)submit_usec / state.commands);
+
+    if (locked) {
+        event_free(queue.ev);
+        close(queue.fds[0]);
+        close(queue.fds[1]);
+    }
+    redisClusterAsyncFree(acc);
+    event_base_free(base);
+}
+
+int main(int argc, char **argv) {
+    int commands = argc > 1 ? atoi(argv[1]) : 400000;
+    char addr[32];
+
+    benchServer *bs = benchServerStart(BENCH_PORT, BENCH_NODES);
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", BENCH_PORT);
+
+    printf("%-7s %9s %10s %12s %14s\n", "queue", "producers", "commands",
+           "commands/s", "usec/submit");
+    for (size_t i = 0; i < sizeof(producer_counts) / sizeof(producer_counts[0]);
+         i++) {
+        for (int locked = 0; locked <= 1; locked++)
+            bench(addr, producer_counts[i], locked, commands);
+    }
+
+    benchServerStop(bs);
+    return 0;
+}
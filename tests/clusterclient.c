@@ -7,6 +7,13 @@
  * !all    - Send each command to all nodes in the cluster.
  *           Will send following commands using the `..ToNode()` API and a
  *           cluster node iterator to send each command to all known nodes.
+ * !batch  - Collect the following commands, until `!exec`, and send them in
+ *           one batch using `redisClusterExecBatch()`. The arguments of the
+ *           commands are separated by spaces.
+ * !pipeline - Append the following commands using `redisClusterAppendCommand()`
+ *           until `!replies`, which reads their replies using
+ *           `redisClusterGetReply()`.
+ * !update - Update the slotmap using `redisClusterUpdateSlotmap()`.
  *
  * Exit statuses this program can return:
  *   0 - Successful execution of program.
@@ -20,6 +27,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define MAX_BATCH_COMMANDS 16
+#define MAX_BATCH_ARGS 16
+
 void printReply(const redisReply *reply) {
     switch (reply->type) {
     case REDIS_REPLY_ERROR:
@@ -57,10 +67,59 @@ void eventCallback(const redisClusterContext *cc, int event, void *privdata) {
     printf("Event: %s\n", e);
 }
 
+void execBatch(redisClusterContext *cc, char **commands, int n) {
+    const char *args[MAX_BATCH_COMMANDS][MAX_BATCH_ARGS];
+    const char **argvs[MAX_BATCH_COMMANDS];
+    int argcs[MAX_BATCH_COMMANDS];
+    redisReply *replies[MAX_BATCH_COMMANDS];
+
+    for (int i = 0; i < n; i++) {
+        argcs[i] = 0;
+        for (char *arg = strtok(commands[i], " ");
+             arg != NULL && argcs[i] < MAX_BATCH_ARGS; arg = strtok(NULL, " "))
+            args[i][argcs[i]++] = arg;
+        argvs[i] = args[i];
+    }
+
+    if (redisClusterExecBatch(cc, n, argcs, argvs, NULL, replies) !=
+        REDIS_OK) {
+        printf("error: %s\n", cc->errstr);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        printReply(replies[i]);
+        freeReplyObject(replies[i]);
+    }
+}
+
+void getReplies(redisClusterContext *cc, int n) {
+    redisReply *reply;
+
+    for (int i = 0; i < n; i++) {
+        if (redisClusterGetReply(cc, (void **)&reply) != REDIS_OK) {
+            printf("error: %s\n", cc->errstr);
+            continue;
+        }
+        printReply(reply);
+        freeReplyObject(reply);
+    }
+    redisClusterReset(cc);
+}
+
 int main(int argc, char **argv) {
     int show_events = 0;
     int use_cluster_slots = 1;
     int send_to_all = 0;
+    int read_from_replicas = 0;
+    int warm_up = 0;
+    int handshake = 0;
+    int single_connection = 0;
+    int retry_backoff = 0;
+    int reconnect_backoff = 0;
+    int batching = 0;
+    int pipelined = -1; /* Number of appended commands when pipelining */
+    char *batch[MAX_BATCH_COMMANDS];
+    int batch_len = 0;
 
     int argindex;
     for (argindex = 1; argindex < argc && argv[argindex][0] == '-';
@@ -69,6 +128,18 @@ int main(int argc, char **argv) {
             show_events = 1;
         } else if (strcmp(argv[argindex], "--use-cluster-nodes") == 0) {
             use_cluster_slots = 0;
+        } else if (strcmp(argv[argindex], "--read-from-replicas") == 0) {
+            read_from_replicas = 1;
+        } else if (strcmp(argv[argindex], "--warm-up") == 0) {
+            warm_up = 1;
+        } else if (strcmp(argv[argindex], "--handshake") == 0) {
+            handshake = 1;
+        } else if (strcmp(argv[argindex], "--single-connection") == 0) {
+            single_connection = 1;
+        } else if (strcmp(argv[argindex], "--retry-backoff") == 0) {
+            retry_backoff = 1;
+        } else if (strcmp(argv[argindex], "--reconnect-backoff") == 0) {
+            reconnect_backoff = 1;
         } else {
             fprintf(stderr, "Unknown argument: '%s'\n", argv[argindex]);
             exit(1);
@@ -77,7 +148,9 @@ int main(int argc, char **argv) {
 
     if (argindex >= argc) {
         fprintf(stderr, "Usage: clusterclient [--events] [--use-cluster-nodes] "
-                        "HOST:PORT\n");
+                        "[--read-from-replicas] [--warm-up] [--handshake] "
+                        "[--single-connection] [--retry-backoff] "
+                        "[--reconnect-backoff] HOST:PORT\n");
         exit(1);
     }
     const char *initnode = argv[argindex];
@@ -93,6 +166,29 @@ int main(int argc, char **argv) {
     if (show_events) {
         redisClusterSetEventCallback(cc, eventCallback, NULL);
     }
+    if (read_from_replicas) {
+        redisClusterSetOptionReadPolicy(cc, HIRCLUSTER_READ_PREFER_REPLICA);
+    }
+    if (warm_up) {
+        redisClusterSetOptionWarmUp(cc, 0);
+    }
+    if (handshake) {
+        redisClusterSetOptionPassword(cc, "secret");
+        redisClusterSetOptionProtocol(cc, 3);
+        redisClusterSetOptionClientName(cc, "clusterclient");
+        redisClusterSetOptionHandshakeCommand(cc, "CLIENT NO-EVICT %s", "on");
+    }
+    if (single_connection) {
+        redisClusterSetOptionMaxConnections(cc, 1);
+    }
+    if (retry_backoff) {
+        struct timeval min = {0, 10000}, max = {1, 0}, deadline = {0, 0};
+        redisClusterSetOptionRetryBackoff(cc, min, max, deadline);
+    }
+    if (reconnect_backoff) {
+        struct timeval min = {0, 100000}, max = {10, 0};
+        redisClusterSetOptionReconnectBackoff(cc, min, max);
+    }
 
     if (redisClusterConnect2(cc) != REDIS_OK) {
         printf("Connect error: %s\n", cc->errstr);
@@ -112,6 +208,39 @@ int main(int argc, char **argv) {
         if (command[0] == '!') {
             if (strcmp(command, "!all") == 0) /* Enable send to all nodes */
                 send_to_all = 1;
+            if (strcmp(command, "!batch") == 0)
+                batching = 1;
+            if (strcmp(command, "!exec") == 0) {
+                execBatch(cc, batch, batch_len);
+                for (int i = 0; i < batch_len; i++)
+                    free(batch[i]);
+                batch_len = 0;
+                batching = 0;
+            }
+            if (strcmp(command, "!pipeline") == 0)
+                pipelined = 0;
+            if (strcmp(command, "!replies") == 0) {
+                getReplies(cc, pipelined);
+                pipelined = -1;
+            }
+            if (strcmp(command, "!update") == 0) {
+                if (redisClusterUpdateSlotmap(cc) != REDIS_OK)
+                    printf("error: %s\n", cc->errstr);
+            }
+            continue;
+        }
+
+        if (pipelined >= 0) {
+            if (redisClusterAppendCommand(cc, command) != REDIS_OK)
+                printf("error: %s\n", cc->errstr);
+            else
+                pipelined++;
+            continue;
+        }
+
+        if (batching) {
+            if (batch_len < MAX_BATCH_COMMANDS)
+                batch[batch_len++] = strdup(command);
             continue;
         }
 
@@ -53,6 +53,7 @@ int resend_failed_cmd = 0;
 int send_to_all = 0;
 int show_events = 0;
 int async_initial_update = 0;
+int submit = 0;
 
 void sendNextCommand(evutil_socket_t, short, void *);
 
@@ -162,8 +163,14 @@ void sendNextCommand(evutil_socket_t fd, short kind, void *arg) {
                 num_running++;
             }
         } else {
-            int status = redisClusterAsyncCommand(
-                acc, replyCallback, (void *)((intptr_t)num_running), cmd);
+            int status;
+            if (submit) {
+                status = redisClusterAsyncSubmit(
+                    acc, replyCallback, (void *)((intptr_t)num_running), cmd);
+            } else {
+                status = redisClusterAsyncCommand(
+                    acc, replyCallback, (void *)((intptr_t)num_running), cmd);
+            }
             if (status == REDIS_OK) {
                 num_running++;
             } else {
@@ -232,9 +239,25 @@ void disconnectCallback(const redisAsyncContext *ac, int status) {
            ac->c.tcp.port);
 }
 
+void drainCallback(redisClusterAsyncContext *acc, void *privdata) {
+    UNUSED(acc);
+    UNUSED(privdata);
+    printf("Event: drain\n");
+}
+
 int main(int argc, char **argv) {
     int use_cluster_slots = 1; // Get topology via CLUSTER SLOTS
     int show_connection_events = 0;
+    int read_from_replicas = 0;
+    int connection_pool = 0;
+    int blocking_connections = 0;
+    int warm_up = 0;
+    int handshake = 0;
+    int client_cache = 0;
+    int command_deadline = 0;
+    int cork = 0;
+    int max_in_flight = 0;
+    int retry_backoff = 0;
 
     int optind;
     for (optind = 1; optind < argc && argv[optind][0] == '-'; optind++) {
@@ -246,6 +269,28 @@ int main(int argc, char **argv) {
             show_connection_events = 1;
         } else if (strcmp(argv[optind], "--async-initial-update") == 0) {
             async_initial_update = 1;
+        } else if (strcmp(argv[optind], "--read-from-replicas") == 0) {
+            read_from_replicas = 1;
+        } else if (strcmp(argv[optind], "--connection-pool") == 0) {
+            connection_pool = 1;
+        } else if (strcmp(argv[optind], "--blocking-connections") == 0) {
+            blocking_connections = 1;
+        } else if (strcmp(argv[optind], "--warm-up") == 0) {
+            warm_up = 1;
+        } else if (strcmp(argv[optind], "--handshake") == 0) {
+            handshake = 1;
+        } else if (strcmp(argv[optind], "--client-cache") == 0) {
+            client_cache = 1;
+        } else if (strcmp(argv[optind], "--command-deadline") == 0) {
+            command_deadline = 1;
+        } else if (strcmp(argv[optind], "--cork") == 0) {
+            cork = 1;
+        } else if (strcmp(argv[optind], "--max-in-flight") == 0) {
+            max_in_flight = 1;
+        } else if (strcmp(argv[optind], "--submit") == 0) {
+            submit = 1;
+        } else if (strcmp(argv[optind], "--retry-backoff") == 0) {
+            retry_backoff = 1;
         } else {
             fprintf(stderr, "Unknown argument: '%s'\n", argv[optind]);
         }
@@ -269,6 +314,45 @@ int main(int argc, char **argv) {
     if (use_cluster_slots) {
         redisClusterSetOptionRouteUseSlots(acc->cc);
     }
+    if (read_from_replicas) {
+        redisClusterSetOptionReadPolicy(acc->cc,
+                                        HIRCLUSTER_READ_PREFER_REPLICA);
+    }
+    if (connection_pool) {
+        redisClusterSetOptionConnectionPool(acc->cc, 2,
+                                            HIRCLUSTER_POOL_LEAST_PENDING);
+    }
+    if (blocking_connections) {
+        redisClusterSetOptionBlockingConnections(acc->cc);
+    }
+    if (warm_up) {
+        redisClusterSetOptionWarmUp(acc->cc, 0);
+    }
+    if (handshake) {
+        redisClusterSetOptionPassword(acc->cc, "secret");
+        redisClusterSetOptionProtocol(acc->cc, 3);
+        redisClusterSetOptionClientName(acc->cc, "clusterclient_async");
+        redisClusterSetOptionHandshakeCommand(acc->cc, "CLIENT NO-EVICT %s",
+                                              "on");
+    }
+    if (client_cache) {
+        redisClusterSetOptionClientCache(acc->cc, 1024 * 1024);
+    }
+    if (command_deadline) {
+        struct timeval deadline = {0, 100000};
+        redisClusterAsyncSetCommandDeadline(acc, deadline);
+    }
+    if (cork) {
+        redisClusterAsyncSetCork(acc, 1024);
+    }
+    if (retry_backoff) {
+        struct timeval min = {0, 10000}, max = {1, 0}, deadline = {0, 0};
+        redisClusterSetOptionRetryBackoff(acc->cc, min, max, deadline);
+    }
+    if (max_in_flight) {
+        redisClusterAsyncSetMaxInFlight(acc, 2, 0);
+        redisClusterAsyncSetDrainCallback(acc, drainCallback, NULL);
+    }
     if (show_connection_events) {
         redisClusterAsyncSetConnectCallback(acc, connectCallback);
         redisClusterAsyncSetDisconnectCallback(acc, disconnectCallback);
@@ -277,6 +361,10 @@ int main(int argc, char **argv) {
     struct event_base *base = event_base_new();
     int status = redisClusterLibeventAttach(acc, base);
     assert(status == REDIS_OK);
+    if (submit) {
+        status = redisClusterAsyncEnableSubmit(acc);
+        assert(status == REDIS_OK);
+    }
 
     if (async_initial_update) {
         if (redisClusterAsyncConnect2(acc) != REDIS_OK) {
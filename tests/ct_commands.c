@@ -100,6 +100,51 @@ void test_mget(redisClusterContext *cc) {
     freeReplyObject(reply);
 }
 
+typedef struct StreamResult {
+    int count;
+    redisReply *replies[4];
+} StreamResult;
+
+void streamCallback(redisClusterContext *cc, unsigned int index,
+                    redisReply *reply, void *privdata) {
+    UNUSED(cc);
+    StreamResult *result = (StreamResult *)privdata;
+    assert(index < 4);
+    assert(result->replies[index] == NULL); // Each key is given once
+    result->replies[index] = reply;
+    result->count++;
+}
+
+void test_mget_stream(redisClusterContext *cc) {
+    redisReply *reply;
+    reply = (redisReply *)redisClusterCommand(
+        cc, "MSET key1 stream1 key2 stream2 key3 stream3");
+    CHECK_REPLY_OK(cc, reply);
+    freeReplyObject(reply);
+
+    /* Keys on different nodes are given per key */
+    StreamResult r1 = {0};
+    int status = redisClusterCommandStream(cc, streamCallback, &r1,
+                                           "MGET key1 key2 nokey key3");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    assert(r1.count == 4);
+    CHECK_REPLY_STR(cc, r1.replies[0], "stream1");
+    CHECK_REPLY_STR(cc, r1.replies[1], "stream2");
+    CHECK_REPLY_NIL(cc, r1.replies[2]);
+    CHECK_REPLY_STR(cc, r1.replies[3], "stream3");
+    for (int i = 0; i < 4; i++)
+        freeReplyObject(r1.replies[i]);
+
+    /* Other commands are given as a single reply */
+    StreamResult r2 = {0};
+    status = redisClusterCommandStream(cc, streamCallback, &r2,
+                                       "DEL key1 key2 key3");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    assert(r2.count == 1);
+    CHECK_REPLY_INT(cc, r2.replies[0], 3);
+    freeReplyObject(r2.replies[0]);
+}
+
 void test_hset_hget_hdel_hexists(redisClusterContext *cc) {
     redisReply *reply;
 
@@ -475,6 +520,7 @@ int main(void) {
     test_exists(cc);
     test_hset_hget_hdel_hexists(cc);
     test_mget(cc);
+    test_mget_stream(cc);
     test_mset(cc);
     test_multi(cc);
     test_xack(cc);
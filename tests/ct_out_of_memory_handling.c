@@ -185,14 +185,14 @@ void test_alloc_failure_handling(void) {
         redisReply *reply;
         const char *cmd = "SET key value";
 
-        for (int i = 0; i < 36; ++i) {
+        for (int i = 0; i < 32; ++i) {
             prepare_allocation_test(cc, i);
             reply = (redisReply *)redisClusterCommand(cc, cmd);
             assert(reply == NULL);
             ASSERT_STR_EQ(cc->errstr, "Out of memory");
         }
 
-        prepare_allocation_test(cc, 36);
+        prepare_allocation_test(cc, 32);
         reply = (redisReply *)redisClusterCommand(cc, cmd);
         CHECK_REPLY_OK(cc, reply);
         freeReplyObject(reply);
@@ -203,7 +203,7 @@ void test_alloc_failure_handling(void) {
         redisReply *reply;
         const char *cmd = "MSET key1 v1 key2 v2 key3 v3";
 
-        for (int i = 0; i < 77; ++i) {
+        for (int i = 0; i < 57; ++i) {
             prepare_allocation_test(cc, i);
             reply = (redisReply *)redisClusterCommand(cc, cmd);
             assert(reply == NULL);
@@ -211,7 +211,7 @@ void test_alloc_failure_handling(void) {
         }
 
         // Multi-key commands
-        prepare_allocation_test(cc, 77);
+        prepare_allocation_test(cc, 57);
         reply = (redisReply *)redisClusterCommand(cc, cmd);
         CHECK_REPLY_OK(cc, reply);
         freeReplyObject(reply);
@@ -245,7 +245,7 @@ void test_alloc_failure_handling(void) {
         redisReply *reply;
         const char *cmd = "SET foo one";
 
-        for (int i = 0; i < 37; ++i) {
+        for (int i = 0; i < 32; ++i) {
             prepare_allocation_test(cc, i);
             result = redisClusterAppendCommand(cc, cmd);
             assert(result == REDIS_ERR);
@@ -257,7 +257,7 @@ void test_alloc_failure_handling(void) {
         for (int i = 0; i < 4; ++i) {
             // Appended command lost when receiving error from hiredis
             // during a GetReply, needs a new append for each test loop
-            prepare_allocation_test(cc, 37);
+            prepare_allocation_test(cc, 35);
             result = redisClusterAppendCommand(cc, cmd);
             assert(result == REDIS_OK);
 
@@ -269,7 +269,7 @@ void test_alloc_failure_handling(void) {
             redisClusterReset(cc);
         }
 
-        prepare_allocation_test(cc, 37);
+        prepare_allocation_test(cc, 35);
         result = redisClusterAppendCommand(cc, cmd);
         assert(result == REDIS_OK);
 
@@ -285,7 +285,7 @@ void test_alloc_failure_handling(void) {
         redisReply *reply;
         const char *cmd = "MSET key1 val1 key2 val2 key3 val3";
 
-        for (int i = 0; i < 90; ++i) {
+        for (int i = 0; i < 70; ++i) {
             prepare_allocation_test(cc, i);
             result = redisClusterAppendCommand(cc, cmd);
             assert(result == REDIS_ERR);
@@ -294,8 +294,8 @@ void test_alloc_failure_handling(void) {
             redisClusterReset(cc);
         }
 
-        for (int i = 0; i < 12; ++i) {
-            prepare_allocation_test(cc, 90);
+        for (int i = 0; i < 10; ++i) {
+            prepare_allocation_test(cc, 73);
             result = redisClusterAppendCommand(cc, cmd);
             assert(result == REDIS_OK);
 
@@ -307,11 +307,11 @@ void test_alloc_failure_handling(void) {
             redisClusterReset(cc);
         }
 
-        prepare_allocation_test(cc, 90);
+        prepare_allocation_test(cc, 73);
         result = redisClusterAppendCommand(cc, cmd);
         assert(result == REDIS_OK);
 
-        prepare_allocation_test(cc, 12);
+        prepare_allocation_test(cc, 10);
         result = redisClusterGetReply(cc, (void *)&reply);
         assert(result == REDIS_OK);
         CHECK_REPLY_OK(cc, reply);
@@ -327,7 +327,7 @@ void test_alloc_failure_handling(void) {
         assert(node);
 
         // OOM failing appends
-        for (int i = 0; i < 37; ++i) {
+        for (int i = 0; i < 19; ++i) {
             prepare_allocation_test(cc, i);
             result = redisClusterAppendCommandToNode(cc, node, cmd);
             assert(result == REDIS_ERR);
@@ -339,7 +339,7 @@ void test_alloc_failure_handling(void) {
         // OOM failing GetResults
         for (int i = 0; i < 4; ++i) {
             // First a successful append
-            prepare_allocation_test(cc, 37);
+            prepare_allocation_test(cc, 35);
             result = redisClusterAppendCommandToNode(cc, node, cmd);
             assert(result == REDIS_OK);
 
@@ -352,7 +352,7 @@ void test_alloc_failure_handling(void) {
         }
 
         // Successful append and GetReply
-        prepare_allocation_test(cc, 37);
+        prepare_allocation_test(cc, 35);
         result = redisClusterAppendCommandToNode(cc, node, cmd);
         assert(result == REDIS_OK);
 
@@ -363,6 +363,31 @@ void test_alloc_failure_handling(void) {
         freeReplyObject(reply);
     }
 
+    // Batch
+    {
+        const char *set[] = {"SET", "foo", "one"};
+        const char *mget[] = {"MGET", "key1", "key2", "key3"};
+        const char **argvs[] = {set, mget};
+        const int argcs[] = {3, 4};
+        redisReply *replies[2];
+
+        for (int i = 0; i < 56; ++i) {
+            prepare_allocation_test(cc, i);
+            result = redisClusterExecBatch(cc, 2, argcs, argvs, NULL, replies);
+            assert(result == REDIS_ERR);
+            ASSERT_STR_EQ(cc->errstr, "Out of memory");
+        }
+
+        /* Nodes dropped by the last failure may need to be reconnected. */
+        prepare_allocation_test(cc, 90);
+        result = redisClusterExecBatch(cc, 2, argcs, argvs, NULL, replies);
+        assert(result == REDIS_OK);
+        CHECK_REPLY_OK(cc, replies[0]);
+        CHECK_REPLY_ARRAY(cc, replies[1], 3);
+        freeReplyObject(replies[0]);
+        freeReplyObject(replies[1]);
+    }
+
     // Redirects
     {
         /* Skip OOM testing during the prepare steps by allowing a high number of
@@ -412,7 +437,7 @@ void test_alloc_failure_handling(void) {
         freeReplyObject(reply);
 
         /* Test ASK reply handling with OOM */
-        for (int i = 0; i < 50; ++i) {
+        for (int i = 0; i < 46; ++i) {
             prepare_allocation_test(cc, i);
             reply = redisClusterCommand(cc, "GET foo");
             assert(reply == NULL);
@@ -420,7 +445,7 @@ void test_alloc_failure_handling(void) {
         }
 
         /* Test ASK reply handling without OOM */
-        prepare_allocation_test(cc, 50);
+        prepare_allocation_test(cc, 46);
         reply = redisClusterCommand(cc, "GET foo");
         CHECK_REPLY_STR(cc, reply, "one");
         freeReplyObject(reply);
@@ -441,7 +466,7 @@ void test_alloc_failure_handling(void) {
         freeReplyObject(reply);
 
         /* Test MOVED reply handling with OOM */
-        for (int i = 0; i < 34; ++i) {
+        for (int i = 0; i < 30; ++i) {
             prepare_allocation_test(cc, i);
             reply = redisClusterCommand(cc, "GET foo");
             assert(reply == NULL);
@@ -449,7 +474,7 @@ void test_alloc_failure_handling(void) {
         }
 
         /* Test MOVED reply handling without OOM */
-        prepare_allocation_test(cc, 34);
+        prepare_allocation_test(cc, 30);
         reply = redisClusterCommand(cc, "GET foo");
         CHECK_REPLY_STR(cc, reply, "one");
         freeReplyObject(reply);
@@ -597,18 +622,18 @@ void test_alloc_failure_handling_async(void) {
     {
         const char *cmd1 = "SET foo one";
 
-        for (int i = 0; i < 38; ++i) {
+        for (int i = 0; i < 33; ++i) {
             prepare_allocation_test_async(acc, i);
             result = redisClusterAsyncCommand(acc, commandCallback, &r1, cmd1);
             assert(result == REDIS_ERR);
-            if (i != 36) {
+            if (i != 31) {
                 ASSERT_STR_EQ(acc->errstr, "Out of memory");
             } else {
                 ASSERT_STR_EQ(acc->errstr, "Failed to attach event adapter");
             }
         }
 
-        prepare_allocation_test_async(acc, 38);
+        prepare_allocation_test_async(acc, 33);
         result = redisClusterAsyncCommand(acc, commandCallback, &r1, cmd1);
         ASSERT_MSG(result == REDIS_OK, acc->errstr);
     }
@@ -619,18 +644,18 @@ void test_alloc_failure_handling_async(void) {
     {
         const char *cmd2 = "GET foo";
 
-        for (int i = 0; i < 15; ++i) {
+        for (int i = 0; i < 11; ++i) {
             prepare_allocation_test_async(acc, i);
             result = redisClusterAsyncCommand(acc, commandCallback, &r2, cmd2);
             assert(result == REDIS_ERR);
             ASSERT_STR_EQ(acc->errstr, "Out of memory");
         }
 
-        /* Due to an issue in hiredis 1.0.0 iteration 15 is avoided.
+        /* Due to an issue in hiredis 1.0.0 iteration 11 is avoided.
            The issue (that triggers an assert) is corrected on master:
            https://github.com/redis/hiredis/commit/4bba72103c93eaaa8a6e07176e60d46ab277cf8a
          */
-        prepare_allocation_test_async(acc, 16);
+        prepare_allocation_test_async(acc, 12);
         result = redisClusterAsyncCommand(acc, commandCallback, &r2, cmd2);
         ASSERT_MSG(result == REDIS_OK, acc->errstr);
     }
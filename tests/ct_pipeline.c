@@ -3,6 +3,7 @@
 #include "test_utils.h"
 
 #include <assert.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -90,6 +91,325 @@ void test_pipeline_with_multinode_commands(void) {
     redisClusterFree(cc);
 }
 
+// Test of a pipeline where the replies are taken as they arrive
+void test_pipeline_any_order(void) {
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+
+    int status;
+    status = redisClusterSetOptionAddNodes(cc, CLUSTER_NODE);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    status = redisClusterAppendCommand(cc, "SET foo one");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterAppendCommand(cc, "MSET key1 Hello key2 World");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterAppendCommand(cc, "SET bar two");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterAppendCommand(cc, "MGET key1 key2");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterAppendCommand(cc, "GET foo");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    redisReply *replies[5] = {NULL};
+    redisReply *reply;
+    long long index;
+    int n;
+    for (n = 0; n < 6; n++) {
+        status = redisClusterGetAnyReply(cc, (void *)&reply, &index);
+        ASSERT_MSG(status == REDIS_OK, cc->errstr);
+        if (reply == NULL)
+            break;
+        assert(index >= 0 && index < 5 && replies[index] == NULL);
+        replies[index] = reply;
+    }
+    assert(n == 5); // All replies were received once
+
+    CHECK_REPLY_OK(cc, replies[0]);
+    CHECK_REPLY_OK(cc, replies[1]);
+    CHECK_REPLY_OK(cc, replies[2]);
+    CHECK_REPLY_ARRAY(cc, replies[3], 2);
+    CHECK_REPLY_STR(cc, replies[3]->element[0], "Hello");
+    CHECK_REPLY_STR(cc, replies[3]->element[1], "World");
+    CHECK_REPLY_STR(cc, replies[4], "one");
+    for (n = 0; n < 5; n++)
+        freeReplyObject(replies[n]);
+
+    // The next pipeline is indexed from 0
+    redisClusterReset(cc);
+    status = redisClusterAppendCommand(cc, "GET bar");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterGetAnyReply(cc, (void *)&reply, &index);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    assert(index == 0);
+    CHECK_REPLY_STR(cc, reply, "two");
+    freeReplyObject(reply);
+
+    redisClusterFree(cc);
+}
+
+// Test of a pipeline filling the socket buffers in both directions
+void test_pipeline_large(void) {
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+
+    int status;
+    status = redisClusterSetOptionAddNodes(cc, CLUSTER_NODE);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    size_t size = 64 * 1024;
+    char *value = malloc(size + 1);
+    assert(value);
+    memset(value, 'x', size);
+    value[size] = '\0';
+
+    for (int i = 0; i < 200; i++) {
+        status = redisClusterAppendCommand(cc, "SET key%d %s", i, value);
+        ASSERT_MSG(status == REDIS_OK, cc->errstr);
+        status = redisClusterAppendCommand(cc, "GET key%d", i);
+        ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    }
+
+    redisReply *reply;
+    for (int i = 0; i < 200; i++) {
+        status = redisClusterGetReply(cc, (void *)&reply);
+        ASSERT_MSG(status == REDIS_OK, cc->errstr);
+        CHECK_REPLY_OK(cc, reply);
+        freeReplyObject(reply);
+
+        status = redisClusterGetReply(cc, (void *)&reply);
+        ASSERT_MSG(status == REDIS_OK, cc->errstr);
+        CHECK_REPLY_STR(cc, reply, value);
+        freeReplyObject(reply);
+    }
+    redisClusterReset(cc);
+
+    free(value);
+    redisClusterFree(cc);
+}
+
+static redisClusterNode *getNodeByPort(redisClusterContext *cc, int port) {
+    redisClusterNodeIterator ni;
+    redisClusterInitNodeIterator(&ni, cc);
+    redisClusterNode *node;
+    while ((node = redisClusterNodeNext(&ni)) != NULL) {
+        if (node->port == port)
+            return node;
+    }
+    assert(0);
+    return NULL;
+}
+
+// Send a command to a node, expecting an OK reply
+static void commandToNodeOk(redisClusterContext *cc, redisClusterNode *node,
+                            const char *format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    redisReply *reply = redisClustervCommandToNode(cc, node, format, ap);
+    va_end(ap);
+    CHECK_REPLY_OK(cc, reply);
+    freeReplyObject(reply);
+}
+
+// Test of pipelined commands redirected during a slot migration
+void test_pipeline_redirects(void) {
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+
+    int status;
+    status = redisClusterSetOptionAddNodes(cc, CLUSTER_NODE);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    redisReply *reply = redisClusterCommand(cc, "SET redirect one");
+    CHECK_REPLY_OK(cc, reply);
+    freeReplyObject(reply);
+
+    // Find a destination node and a key it serves
+    unsigned int slot = redisClusterGetSlotByKey("redirect");
+    redisClusterNode *srcNode = redisClusterGetNodeByKey(cc, "redirect");
+    redisClusterNode *dstNode;
+    redisClusterNodeIterator ni;
+    redisClusterInitNodeIterator(&ni, cc);
+    while ((dstNode = redisClusterNodeNext(&ni)) != NULL) {
+        if (dstNode != srcNode)
+            break;
+    }
+    assert(dstNode);
+    int srcPort = srcNode->port, dstPort = dstNode->port;
+    char dstKey[16];
+    int i = 0;
+    do {
+        snprintf(dstKey, sizeof(dstKey), "key%d", i++);
+    } while (redisClusterGetNodeByKey(cc, dstKey) != dstNode);
+
+    redisReply *srcId = redisClusterCommandToNode(cc, srcNode, "CLUSTER MYID");
+    CHECK_REPLY_TYPE(srcId, REDIS_REPLY_STRING);
+    redisReply *dstId = redisClusterCommandToNode(cc, dstNode, "CLUSTER MYID");
+    CHECK_REPLY_TYPE(dstId, REDIS_REPLY_STRING);
+
+    // Migrate the key, giving ASK redirects
+    commandToNodeOk(cc, srcNode, "CLUSTER SETSLOT %d MIGRATING %s", slot,
+                    dstId->str);
+    commandToNodeOk(cc, dstNode, "CLUSTER SETSLOT %d IMPORTING %s", slot,
+                    srcId->str);
+    commandToNodeOk(cc, srcNode, "MIGRATE 127.0.0.1 %d redirect 0 5000",
+                    dstPort);
+
+    // The redirected command is re-sent after the second command
+    status = redisClusterAppendCommand(cc, "GET redirect");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterAppendCommand(cc, "SET %s two", dstKey);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    redisClusterGetReply(cc, (void *)&reply); // reply for: GET redirect
+    CHECK_REPLY_STR(cc, reply, "one");
+    freeReplyObject(reply);
+    redisClusterGetReply(cc, (void *)&reply); // reply for: SET key two
+    CHECK_REPLY_OK(cc, reply);
+    freeReplyObject(reply);
+    redisClusterReset(cc);
+
+    // Finalize the migration, giving MOVED redirects
+    commandToNodeOk(cc, getNodeByPort(cc, srcPort),
+                    "CLUSTER SETSLOT %d NODE %s", slot, dstId->str);
+    commandToNodeOk(cc, getNodeByPort(cc, dstPort),
+                    "CLUSTER SETSLOT %d NODE %s", slot, dstId->str);
+
+    status = redisClusterAppendCommand(cc, "GET redirect");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    status = redisClusterAppendCommand(cc, "MGET redirect %s", dstKey);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    long long index;
+    redisClusterGetAnyReply(cc, (void *)&reply, &index);
+    assert(index == 0);
+    CHECK_REPLY_STR(cc, reply, "one");
+    freeReplyObject(reply);
+    redisClusterGetAnyReply(cc, (void *)&reply, &index);
+    assert(index == 1);
+    CHECK_REPLY_ARRAY(cc, reply, 2);
+    CHECK_REPLY_STR(cc, reply->element[0], "one");
+    CHECK_REPLY_STR(cc, reply->element[1], "two");
+    freeReplyObject(reply);
+    redisClusterGetAnyReply(cc, (void *)&reply, &index);
+    assert(reply == NULL);
+    redisClusterReset(cc);
+
+    freeReplyObject(srcId);
+    freeReplyObject(dstId);
+    redisClusterFree(cc);
+}
+
+// Test that a reset discards unread replies and keeps the connections
+void test_pipeline_reset(void) {
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+
+    int status;
+    status = redisClusterSetOptionAddNodes(cc, CLUSTER_NODE);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    redisClusterNode *node = redisClusterGetNodeByKey(cc, "foo");
+    assert(node);
+    redisReply *reply = redisClusterCommand(cc, "SET foo one");
+    CHECK_REPLY_OK(cc, reply);
+    freeReplyObject(reply);
+    redisContext *c = node->con;
+    assert(c);
+
+    for (int i = 0; i < 10; i++) {
+        status = redisClusterAppendCommand(cc, "GET foo");
+        ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    }
+    status = redisClusterAppendCommand(cc, "GET bar");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    redisClusterGetReply(cc, (void *)&reply); // reply for: GET foo
+    CHECK_REPLY_STR(cc, reply, "one");
+    freeReplyObject(reply);
+
+    // The remaining replies are discarded
+    redisClusterReset(cc);
+    assert(cc->err == 0);
+    assert(node->con == c);
+
+    reply = redisClusterCommand(cc, "SET foo two");
+    CHECK_REPLY_OK(cc, reply);
+    freeReplyObject(reply);
+    assert(node->con == c);
+
+    status = redisClusterAppendCommand(cc, "GET foo");
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    redisClusterGetReply(cc, (void *)&reply);
+    CHECK_REPLY_STR(cc, reply, "two");
+    freeReplyObject(reply);
+    redisClusterReset(cc);
+
+    redisClusterFree(cc);
+}
+
+// Test of a batch of commands executed at once
+void test_batch(void) {
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+
+    int status;
+    status = redisClusterSetOptionAddNodes(cc, CLUSTER_NODE);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    status = redisClusterConnect2(cc);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+
+    const char *set1[] = {"SET", "foo", "one"};
+    const char *set2[] = {"SET", "bar", "two"};
+    const char *mget[] = {"MGET", "foo", "bar"};
+    const char *get[] = {"GET", "foo"};
+    const char *sunion[] = {"SUNION", "a", "b"};
+    const char **argvs[] = {set1, set2, mget, get, sunion};
+    const int argcs[] = {3, 3, 3, 2, 3};
+    redisReply *replies[5];
+
+    status = redisClusterExecBatch(cc, 5, argcs, argvs, NULL, replies);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    CHECK_REPLY_OK(cc, replies[0]);
+    CHECK_REPLY_OK(cc, replies[1]);
+    CHECK_REPLY_ARRAY(cc, replies[2], 2);
+    CHECK_REPLY_STR(cc, replies[2]->element[0], "one");
+    CHECK_REPLY_STR(cc, replies[2]->element[1], "two");
+    CHECK_REPLY_STR(cc, replies[3], "one");
+    CHECK_REPLY_ERROR(cc, replies[4], "CROSSSLOT");
+    for (int i = 0; i < 5; i++)
+        freeReplyObject(replies[i]);
+
+    // A command which can't be planned fails the batch before sending
+    const char *empty[] = {"GET"};
+    const char **argvs2[] = {set1, empty};
+    const int argcs2[] = {3, 1};
+    status = redisClusterExecBatch(cc, 2, argcs2, argvs2, NULL, replies);
+    assert(status == REDIS_ERR);
+    assert(replies[0] == NULL && replies[1] == NULL);
+
+    // Usable after the failure
+    status = redisClusterExecBatch(cc, 1, &argcs[3], &argvs[3], NULL, replies);
+    ASSERT_MSG(status == REDIS_OK, cc->errstr);
+    CHECK_REPLY_STR(cc, replies[0], "one");
+    freeReplyObject(replies[0]);
+
+    redisClusterFree(cc);
+}
+
 //------------------------------------------------------------------------------
 // Async API
 //------------------------------------------------------------------------------
@@ -171,6 +491,11 @@ int main(void) {
 
     test_pipeline();
     test_pipeline_with_multinode_commands();
+    test_pipeline_any_order();
+    test_pipeline_large();
+    test_pipeline_redirects();
+    test_pipeline_reset();
+    test_batch();
 
     test_async_pipeline();
     // Asynchronous API does not support multi-key commands
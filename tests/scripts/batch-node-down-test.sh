@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# Verify that a batch with a multi-key command which can't be sent to all of
+# its nodes doesn't leave the parts already queued to other nodes, which
+# replies would be taken for the replies of the following commands.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient}
+testname=batch-node-down-test
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated redis node #1. Node #2 is down.
+timeout 5s ./simulated-redis.pl -p 7401 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 6000, ["127.0.0.1", 7401, "nodeid1"]],[6001, 16383, ["127.0.0.1", 7402, "nodeid2"]]]
+EXPECT CLOSE
+# The part of the MGET queued to this node is discarded
+EXPECT CONNECT
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["GET", "bar"]
+SEND "1"
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" 127.0.0.1:7401 > "$testname.out" <<'EOF'
+!batch
+MGET bar foo
+!exec
+GET bar
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+expected="error: Connection refused
+1"
+
+echo "$expected" | diff -u - "$testname.out" || exit 99
+
+# Clean up
+rm "$testname.out"
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Verify that a blocking command is sent on a dedicated connection when
+# blocking connections are enabled without a connection pool.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient_async}
+testname=blocking-connections-test-async
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server. Only the last accepted connection can be used, and
+# the previous connection when it is closed.
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+
+# Dedicated connection for the blocking command
+EXPECT CONNECT
+# Connection for other commands
+EXPECT CONNECT
+
+EXPECT ["GET", "foo"]
+SEND "1"
+CLOSE
+EXPECT ["BRPOPLPUSH", "src", "dst", "0"]
+SEND "item"
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --blocking-connections 127.0.0.1:7400 > "$testname.out" <<'EOF'
+!async
+BRPOPLPUSH src dst 0
+GET foo
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient. The replies are received on different
+# connections, so the order of the callbacks is not given.
+printf '1\nitem\n' | cmp <(sort "$testname.out") - || exit 99
+
+# Clean up
+rm "$testname.out"
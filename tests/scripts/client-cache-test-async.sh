@@ -0,0 +1,71 @@
+#!/bin/sh
+
+# Verify that a repeated read is served from the client-side cache, and that
+# the cached reply is dropped when the server sends an invalidation message.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient_async}
+testname=client-cache-test-async
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["HELLO", "3"]
+SEND ["server", "redis", "proto", 3]
+EXPECT ["CLIENT", "TRACKING", "on"]
+SEND +OK
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT ["GET", "foo"]
+SEND "1"
+# The second GET foo is served from the cache
+EXPECT ["GET", "bar"]
+SEND >2\r\n$10\r\ninvalidate\r\n*1\r\n$3\r\nfoo\r\n
+SEND "2"
+EXPECT ["GET", "foo"]
+SEND "3"
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --client-cache --async-initial-update 127.0.0.1:7400 \
+    > "$testname.out" <<'EOF'
+GET foo
+GET foo
+GET bar
+GET foo
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+expected="1
+1
+2
+3"
+
+echo "$expected" | diff -u - "$testname.out" || exit 99
+
+# Clean up
+rm "$testname.out"
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# Verify that commands sent in cork mode are written, both when the timer of
+# the event loop fires and when disconnecting.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient_async}
+testname=cork-test-async
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["SET", "foo", "initial"]
+SEND +OK
+EXPECT ["GET", "foo"]
+EXPECT ["GET", "bar"]
+SEND "initial"
+SEND "2"
+EXPECT ["GET", "baz"]
+SEND "3"
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --cork 127.0.0.1:7400 > "$testname.out" <<'EOF'
+SET foo initial
+!async
+GET foo
+GET bar
+!sync
+!async
+GET baz
+!disconnect
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+printf 'OK\ninitial\n2\n3\n' | cmp "$testname.out" - || exit 99
+
+# Clean up
+rm "$testname.out"
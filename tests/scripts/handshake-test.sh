@@ -0,0 +1,103 @@
+#!/bin/sh
+
+# Verify that the configured handshake is sent on each new connection and that
+# a connection is not used when a handshake command fails.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient}
+testname=handshake-test
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["AUTH", "secret"]
+SEND +OK
+EXPECT ["HELLO", "3"]
+SEND ["server", "redis", "proto", 3]
+EXPECT ["CLIENT", "SETNAME", "clusterclient"]
+SEND +OK
+EXPECT ["CLIENT", "NO-EVICT", "on"]
+SEND +OK
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+
+# A failing handshake command
+EXPECT CONNECT
+EXPECT ["AUTH", "secret"]
+SEND +OK
+EXPECT ["HELLO", "3"]
+SEND ["server", "redis", "proto", 3]
+EXPECT ["CLIENT", "SETNAME", "clusterclient"]
+SEND +OK
+EXPECT ["CLIENT", "NO-EVICT", "on"]
+SEND -ERR unknown subcommand 'NO-EVICT'
+EXPECT CLOSE
+
+# The failed connection triggers a slotmap update before the command is retried
+EXPECT CONNECT
+EXPECT ["AUTH", "secret"]
+SEND +OK
+EXPECT ["HELLO", "3"]
+SEND ["server", "redis", "proto", 3]
+EXPECT ["CLIENT", "SETNAME", "clusterclient"]
+SEND +OK
+EXPECT ["CLIENT", "NO-EVICT", "on"]
+SEND +OK
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+
+EXPECT CONNECT
+EXPECT ["AUTH", "secret"]
+SEND +OK
+EXPECT ["HELLO", "3"]
+SEND ["server", "redis", "proto", 3]
+EXPECT ["CLIENT", "SETNAME", "clusterclient"]
+SEND +OK
+EXPECT ["CLIENT", "NO-EVICT", "on"]
+SEND +OK
+EXPECT ["GET", "foo"]
+SEND "bar"
+EXPECT ["GET", "foo"]
+SEND "bar"
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --handshake 127.0.0.1:7400 > "$testname.out" <<'EOF'
+GET foo
+GET foo
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+expected="bar
+bar"
+
+echo "$expected" | diff -u - "$testname.out" || exit 99
+
+# Clean up
+rm "$testname.out"
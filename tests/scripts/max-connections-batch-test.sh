@@ -0,0 +1,99 @@
+#!/bin/sh
+
+# Verify that a node waiting for the replies of a batch is not closed to stay
+# within the connection budget, when a redirect needs a connection to another
+# node.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient}
+testname=max-connections-batch-test
+
+# Sync processes waiting for CONT signals.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid1=$!;
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid2=$!;
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid3=$!;
+
+# Start simulated redis node #1
+timeout 5s ./simulated-redis.pl -p 7401 -d --sigcont $syncpid1 <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 6000, ["127.0.0.1", 7401, "nodeid1"]],[6001, 16383, ["127.0.0.1", 7402, "nodeid2"]]]
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["GET", "bar"]
+# Reply after the redirect on node #2 is followed
+SLEEP 1
+SEND "1"
+EXPECT CLOSE
+EOF
+server1=$!
+
+# Start simulated redis node #2
+timeout 5s ./simulated-redis.pl -p 7402 -d --sigcont $syncpid2 <<'EOF' &
+EXPECT CONNECT
+EXPECT ["GET", "foo"]
+SEND -ASK 12182 127.0.0.1:7403
+# Closed when connecting to node #3, instead of node #1
+EXPECT CLOSE
+EOF
+server2=$!
+
+# Start simulated redis node #3
+timeout 5s ./simulated-redis.pl -p 7403 -d --sigcont $syncpid3 <<'EOF' &
+EXPECT CONNECT
+EXPECT ["ASKING"]
+SEND +OK
+EXPECT ["GET", "foo"]
+SEND "2"
+EXPECT CLOSE
+EOF
+server3=$!
+
+# Wait until the nodes are ready to accept client connections
+wait $syncpid1 $syncpid2 $syncpid3;
+
+# Run client
+timeout 4s "$clientprog" --single-connection 127.0.0.1:7401 \
+    > "$testname.out" <<'EOF'
+!batch
+GET bar
+GET foo
+!exec
+EOF
+clientexit=$?
+
+# Wait for servers to exit
+wait $server1; server1exit=$?
+wait $server2; server2exit=$?
+wait $server3; server3exit=$?
+
+# Check exit statuses
+if [ $server1exit -ne 0 ]; then
+    echo "Simulated server #1 exited with status $server1exit"
+    exit $server1exit
+fi
+if [ $server2exit -ne 0 ]; then
+    echo "Simulated server #2 exited with status $server2exit"
+    exit $server2exit
+fi
+if [ $server3exit -ne 0 ]; then
+    echo "Simulated server #3 exited with status $server3exit"
+    exit $server3exit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+expected="1
+2"
+
+echo "$expected" | diff -u - "$testname.out" || exit 99
+
+# Clean up
+rm "$testname.out"
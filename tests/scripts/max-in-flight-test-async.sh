@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# Verify that a command is refused when its node has the max number of commands
+# waiting for a reply, and that the drain callback is called when a reply is
+# received. The client is configured with max 2 commands in flight per node.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient_async}
+testname=max-in-flight-test-async
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["GET", "foo"]
+EXPECT ["GET", "bar"]
+SEND "1"
+SEND "2"
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --max-in-flight 127.0.0.1:7400 > "$testname.out" <<'EOF'
+!async
+GET foo
+GET bar
+GET baz
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+expected="error: node is busy
+Event: drain
+1
+2"
+echo "$expected" | cmp "$testname.out" - || exit 99
+
+# Clean up
+rm "$testname.out"
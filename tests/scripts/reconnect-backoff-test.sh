@@ -0,0 +1,79 @@
+#!/bin/sh
+
+# Verify that a node which refused a connection is not connected to again
+# until its reconnect backoff has passed, while other nodes are still usable.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient}
+testname=reconnect-backoff-test
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server. Nothing is listening on the port of the second node.
+timeout 5s ./simulated-redis.pl -p 7401 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 6000, ["127.0.0.1", 7401, "nodeid1"]],[6001, 16383, ["127.0.0.1", 7402, "nodeid2"]]]
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["SET", "bar", "initial"]
+SEND +OK
+
+# A failed connect to the second node triggers a slotmap update
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 6000, ["127.0.0.1", 7401, "nodeid1"]],[6001, 16383, ["127.0.0.1", 7402, "nodeid2"]]]
+EXPECT CLOSE
+
+# The second node is still in backoff, which also triggers a slotmap update
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 6000, ["127.0.0.1", 7401, "nodeid1"]],[6001, 16383, ["127.0.0.1", 7402, "nodeid2"]]]
+EXPECT CLOSE
+
+EXPECT ["SET", "bar", "second"]
+SEND +OK
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --reconnect-backoff 127.0.0.1:7401 > "$testname.out" <<'EOF'
+SET bar initial
+SET foo initial
+SET foo second
+SET bar second
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient. The connect failure of the first command
+# to the second node is followed by a retry after the slotmap update, which is
+# postponed without waiting for a new connect failure.
+expected="OK
+error: node unavailable, reconnect postponed
+error: node unavailable, reconnect postponed
+OK"
+
+echo "$expected" | cmp "$testname.out" - || exit 99
+
+# Clean up
+rm "$testname.out"
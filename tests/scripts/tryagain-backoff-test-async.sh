@@ -0,0 +1,62 @@
+#!/bin/sh
+
+# Verify that commands getting TRYAGAIN or CLUSTERDOWN replies are retried
+# when the retry timer fires in the event loop, until the max number of
+# retries is reached. The client is configured to retry once.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient_async}
+testname=tryagain-backoff-test-async
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["SET", "foo", "migrating"]
+SEND -TRYAGAIN Multiple keys request during rehashing of slot
+EXPECT ["SET", "foo", "migrating"]
+SEND +OK
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client
+timeout 3s "$clientprog" --retry-backoff 127.0.0.1:7400 > "$testname.out" <<'EOF'
+SET foo migrating
+SET foo down
+EOF
+clientexit=$?
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+printf 'OK\nerror: too many cluster retries\n' | cmp "$testname.out" - || exit 99
+
+# Clean up
+rm "$testname.out"
@@ -0,0 +1,82 @@
+#!/bin/sh
+
+# Verify that commands getting TRYAGAIN or CLUSTERDOWN replies are retried
+# after an increasing delay, until the max number of retries is reached.
+#
+# Usage: $0 /path/to/clusterclient-binary
+
+clientprog=${1:-./clusterclient}
+testname=tryagain-backoff-test
+
+# Sync process just waiting for server to be ready to accept connection.
+perl -we 'use sigtrap "handler", sub{exit}, "CONT"; sleep 1; die "timeout"' &
+syncpid=$!
+
+# Start simulated server
+timeout 5s ./simulated-redis.pl -p 7400 -d --sigcont $syncpid <<'EOF' &
+EXPECT CONNECT
+EXPECT ["CLUSTER", "SLOTS"]
+SEND [[0, 16383, ["127.0.0.1", 7400, "nodeid123"]]]
+EXPECT CLOSE
+EXPECT CONNECT
+EXPECT ["SET", "foo", "migrating"]
+SEND -TRYAGAIN Multiple keys request during rehashing of slot
+EXPECT ["SET", "foo", "migrating"]
+SEND -TRYAGAIN Multiple keys request during rehashing of slot
+EXPECT ["SET", "foo", "migrating"]
+SEND +OK
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT ["SET", "foo", "down"]
+SEND -CLUSTERDOWN The cluster is down
+EXPECT CLOSE
+EOF
+server=$!
+
+# Wait until server is ready to accept client connection
+wait $syncpid;
+
+# Run client and measure the time in milliseconds
+start=$(perl -MTime::HiRes=time -e 'printf "%d", time * 1000')
+timeout 3s "$clientprog" --retry-backoff 127.0.0.1:7400 > "$testname.out" <<'EOF'
+SET foo migrating
+SET foo down
+EOF
+clientexit=$?
+end=$(perl -MTime::HiRes=time -e 'printf "%d", time * 1000')
+
+# Wait for server to exit
+wait $server; serverexit=$?
+
+# Check exit statuses
+if [ $serverexit -ne 0 ]; then
+    echo "Simulated server exited with status $serverexit"
+    exit $serverexit
+fi
+if [ $clientexit -ne 0 ]; then
+    echo "$clientprog exited with status $clientexit"
+    exit $clientexit
+fi
+
+# Check the output from clusterclient
+printf 'OK\nerror: too many cluster retries\n' | cmp "$testname.out" - || exit 99
+
+# The retry delays start at 10 ms and are doubled for each retry of a command,
+# but randomly reduced by up to a half: at least 5 + 10 ms for the first
+# command and 5 + 10 + 20 + 40 + 80 ms for the second.
+elapsed=$((end - start))
+if [ $elapsed -lt 170 ]; then
+    echo "Retries were not delayed, elapsed time: $elapsed ms"
+    exit 99
+fi
+
+# Clean up
+rm "$testname.out"
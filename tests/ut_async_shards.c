@@ -0,0 +1,180 @@
+/*
+ * Unit test of the sharded asynchronous client, using the in-process stand-in
+ * cluster of the benchmarks.
+ *
+ * Commands are submitted from producer threads and each reply is checked to
+ * belong to its command and to be handled by the shard owning the node serving
+ * its slot, which only has connections to its own nodes. The slotmap is only
+ * fetched by the first shard. The shards are then stopped, which must give the
+ * replies of all commands submitted before.
+ */
+#include "adapters/libevent.h"
+#include "bench_server.h"
+#include "hircluster.h"
+#include "test_utils.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PORT 7900
+#define TEST_NODES 4
+#define PRODUCERS 2
+#define COMMANDS 2000
+#define MAX_LOOPS 3
+
+typedef struct testState {
+    redisClusterAsyncShards *shards;
+    int loops;
+    int received; /* Updated atomically by the event loop threads */
+    int failed;
+    pthread_barrier_t connected;
+} testState;
+
+typedef struct loopArg {
+    testState *state;
+    int shard;
+    struct event_base *base;
+} loopArg;
+
+typedef struct producerArg {
+    testState *state;
+    int first;
+} producerArg;
+
+/* The privdata of a command is its key number, so the state is global */
+static testState *running = NULL;
+
+/* The stand-in cluster splits the slots evenly over its nodes, in the order of
+ * their ports, so that is the order the nodes are spread over the shards. */
+static int nodeShard(int port) { return (port - TEST_PORT) % running->loops; }
+
+static int keyShard(const char *key) {
+    unsigned int slot = redisClusterGetSlotByKey((char *)key);
+    int node = slot / (REDIS_CLUSTER_SLOTS / TEST_NODES);
+
+    if (node >= TEST_NODES)
+        node = TEST_NODES - 1;
+    return nodeShard(TEST_PORT + node);
+}
+
+/* Check that a shard is only connected to its own nodes. */
+static void checkConnections(redisClusterAsyncContext *acc, int shard) {
+    redisClusterNodeIterator ni;
+    redisClusterNode *node;
+
+    redisClusterInitNodeIterator(&ni, acc->cc);
+    while ((node = redisClusterNodeNext(&ni)) != NULL) {
+        if (node->acon != NULL)
+            assert(nodeShard(node->port) == shard);
+    }
+}
+
+static void replyCallback(redisClusterAsyncContext *acc, void *r,
+                          void *privdata) {
+    redisReply *reply = r;
+    char key[32];
+
+    if (reply == NULL) {
+        __atomic_add_fetch(&running->failed, 1, __ATOMIC_SEQ_CST);
+        return;
+    }
+    snprintf(key, sizeof(key), "key%d", (int)(intptr_t)privdata);
+    assert(reply->type == REDIS_REPLY_STRING);
+    assert(strcmp(reply->str, key) == 0);
+    assert(acc == running->shards->acc[keyShard(key)]);
+    checkConnections(acc, keyShard(key));
+    __atomic_add_fetch(&running->received, 1, __ATOMIC_SEQ_CST);
+}
+
+static void *eventLoop(void *arg) {
+    loopArg *la = arg;
+    redisClusterAsyncContext *acc = la->state->shards->acc[la->shard];
+    char addr[32];
+
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", TEST_PORT);
+    la->base = event_base_new();
+    redisClusterSetOptionAddNodes(acc->cc, addr);
+    redisClusterSetOptionRouteUseSlots(acc->cc);
+    int status = redisClusterLibeventAttach(acc, la->base);
+    assert(status == REDIS_OK);
+    status = redisClusterAsyncEnableSubmit(acc);
+    ASSERT_MSG(status == REDIS_OK, acc->errstr);
+    status = redisClusterConnect2(acc->cc);
+    ASSERT_MSG(status == REDIS_OK, acc->cc->errstr);
+    pthread_barrier_wait(&la->state->connected);
+
+    event_base_dispatch(la->base);
+    return NULL;
+}
+
+static void *producer(void *arg) {
+    producerArg *pa = arg;
+
+    for (int i = pa->first; i < pa->first + COMMANDS / PRODUCERS; i++) {
+        int status = redisClusterAsyncShardsSubmit(
+            pa->state->shards, replyCallback, (void *)(intptr_t)i, "GET key%d",
+            i);
+        assert(status == REDIS_OK);
+    }
+    return NULL;
+}
+
+/* Commands are routed to the owning shards, and all of them get a reply when
+ * the shards are stopped right after submitting. */
+void test_routing_and_shutdown(benchServer *bs, int loops) {
+    testState state = {.loops = loops};
+    pthread_t loop_threads[MAX_LOOPS], producer_threads[PRODUCERS];
+    loopArg loop_args[MAX_LOOPS];
+    producerArg producer_args[PRODUCERS];
+    int slotmap_requests = benchServerSlotmapRequests(bs);
+
+    state.shards = redisClusterAsyncShardsInit(loops);
+    assert(state.shards);
+    running = &state;
+    pthread_barrier_init(&state.connected, NULL, loops + 1);
+    for (int i = 0; i < loops; i++) {
+        loop_args[i].state = &state;
+        loop_args[i].shard = i;
+        pthread_create(&loop_threads[i], NULL, eventLoop, &loop_args[i]);
+    }
+    pthread_barrier_wait(&state.connected);
+
+    for (int i = 0; i < PRODUCERS; i++) {
+        producer_args[i].state = &state;
+        producer_args[i].first = i * (COMMANDS / PRODUCERS);
+        pthread_create(&producer_threads[i], NULL, producer,
+                       &producer_args[i]);
+    }
+    for (int i = 0; i < PRODUCERS; i++)
+        pthread_join(producer_threads[i], NULL);
+    redisClusterAsyncShardsStop(state.shards);
+    for (int i = 0; i < loops; i++)
+        pthread_join(loop_threads[i], NULL);
+
+    assert(state.received == COMMANDS);
+    assert(state.failed == 0);
+    /* Fetched by the first shard only */
+    assert(benchServerSlotmapRequests(bs) == slotmap_requests + 1);
+
+    /* A command submitted after the shutdown is failed when freeing */
+    int status = redisClusterAsyncShardsSubmit(state.shards, replyCallback,
+                                               (void *)(intptr_t)0, "GET key0");
+    assert(status == REDIS_OK);
+    redisClusterAsyncShardsFree(state.shards);
+    assert(state.failed == 1);
+
+    for (int i = 0; i < loops; i++)
+        event_base_free(loop_args[i].base);
+    pthread_barrier_destroy(&state.connected);
+}
+
+int main(void) {
+    benchServer *bs = benchServerStart(TEST_PORT, TEST_NODES);
+
+    for (int loops = 1; loops <= MAX_LOOPS; loops++)
+        test_routing_and_shutdown(bs, loops);
+
+    benchServerStop(bs);
+    return 0;
+}
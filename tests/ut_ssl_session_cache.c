@@ -0,0 +1,152 @@
+/* Unit test of the TLS session cache, using an in-process TLS server. */
+
+#include "hircluster.h"
+#include "hircluster_ssl.h"
+#include "test_utils.h"
+#include <arpa/inet.h>
+#include <assert.h>
+#include <netinet/in.h>
+#include <openssl/ssl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define CONNECTIONS 3
+
+typedef struct tlsServer {
+    SSL_CTX *ssl_ctx;
+    int fd;
+    int port;
+    pthread_t thread;
+} tlsServer;
+
+/* Counters of the callbacks set on the client context by the application */
+static int app_new_sessions = 0;
+static int app_handshakes_done = 0;
+
+static int appNewSessionCallback(SSL *ssl, SSL_SESSION *session) {
+    (void)ssl;
+    (void)session;
+    app_new_sessions++;
+    return 0; /* The reference of the session is not kept */
+}
+
+static void appInfoCallback(const SSL *ssl, int where, int ret) {
+    (void)ssl;
+    (void)ret;
+    if (where & SSL_CB_HANDSHAKE_DONE)
+        app_handshakes_done++;
+}
+
+/* Accept the connections and do the TLS handshake, then wait for the client
+ * to close the connection. */
+static void *serverThread(void *arg) {
+    tlsServer *server = arg;
+    char buf[64];
+
+    for (int i = 0; i < CONNECTIONS; i++) {
+        int fd = accept(server->fd, NULL, NULL);
+        assert(fd >= 0);
+        SSL *ssl = SSL_new(server->ssl_ctx);
+        assert(ssl);
+        SSL_set_fd(ssl, fd);
+        if (SSL_accept(ssl) == 1) {
+            while (SSL_read(ssl, buf, sizeof(buf)) > 0)
+                ;
+        }
+        SSL_free(ssl);
+        close(fd);
+    }
+    return NULL;
+}
+
+static void serverStart(tlsServer *server) {
+    struct sockaddr_in sa = {0};
+    socklen_t len = sizeof(sa);
+
+    /* Sessions are received during the handshake up to TLSv1.2, while a
+     * TLSv1.3 ticket is only received when reading from the connection. */
+    server->ssl_ctx = SSL_CTX_new(TLS_server_method());
+    assert(server->ssl_ctx);
+    SSL_CTX_set_max_proto_version(server->ssl_ctx, TLS1_2_VERSION);
+    int status = SSL_CTX_use_certificate_chain_file(server->ssl_ctx,
+                                                    "redis.crt");
+    assert(status == 1);
+    status = SSL_CTX_use_PrivateKey_file(server->ssl_ctx, "redis.key",
+                                         SSL_FILETYPE_PEM);
+    assert(status == 1);
+
+    server->fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(server->fd >= 0);
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    status = bind(server->fd, (struct sockaddr *)&sa, sizeof(sa));
+    assert(status == 0);
+    status = listen(server->fd, CONNECTIONS);
+    assert(status == 0);
+    status = getsockname(server->fd, (struct sockaddr *)&sa, &len);
+    assert(status == 0);
+    server->port = ntohs(sa.sin_port);
+
+    pthread_create(&server->thread, NULL, serverThread, server);
+}
+
+static void serverStop(tlsServer *server) {
+    pthread_join(server->thread, NULL);
+    close(server->fd);
+    SSL_CTX_free(server->ssl_ctx);
+}
+
+/* Reconnecting to a node resumes the session of the previous connection, and
+ * the callbacks set by the application are still called. */
+void test_session_reuse(void) {
+    redisClusterSSLSessionStats stats;
+    tlsServer server;
+
+    serverStart(&server);
+
+    SSL_CTX *ssl_ctx = SSL_CTX_new(TLS_client_method());
+    assert(ssl_ctx);
+    SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_CLIENT);
+    SSL_CTX_sess_set_new_cb(ssl_ctx, appNewSessionCallback);
+    SSL_CTX_set_info_callback(ssl_ctx, appInfoCallback);
+
+    redisClusterSSLSessionCache *cache =
+        redisClusterCreateSSLSessionCache(ssl_ctx, NULL);
+    assert(cache);
+    SSL_CTX_free(ssl_ctx); /* Referenced by the cache */
+
+    redisClusterContext *cc = redisClusterContextInit();
+    assert(cc);
+    int status = redisClusterSetOptionEnableSSLSessionCache(cc, cache);
+    assert(status == REDIS_OK);
+
+    for (int i = 0; i < CONNECTIONS; i++) {
+        redisContext *c = redisConnect("127.0.0.1", server.port);
+        assert(c);
+        ASSERT_MSG(c->err == 0, c->errstr);
+        status = cc->ssl_init_fn(c, cc->ssl);
+        ASSERT_MSG(status == REDIS_OK, c->errstr);
+        redisFree(c);
+    }
+
+    redisClusterGetSSLSessionStats(cache, &stats);
+    assert(stats.full_handshakes == 1);
+    assert(stats.resumed_handshakes == CONNECTIONS - 1);
+    assert(stats.sessions == 1);
+    assert(app_new_sessions == 1);
+    assert(app_handshakes_done == CONNECTIONS);
+
+    redisClusterFree(cc);
+    redisClusterFreeSSLSessionCache(cache);
+    serverStop(&server);
+}
+
+int main(void) {
+
+    test_session_reuse();
+
+    return 0;
+}
@@ -51,6 +51,12 @@
 #ifdef _WIN32
 
 #include <profileapi.h> /* for QueryPerformance APIs */
+#include <synchapi.h>   /* for Sleep */
+#include <winsock2.h>   /* for WSAPoll */
+
+#ifndef poll
+#define poll WSAPoll
+#endif
 
 #define strerror_r(errno, buf, len) strerror_s(buf, len, errno)
 